@@ -0,0 +1,47 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+namespace syssnap::bench
+{
+	// Snapshot over the synthetic sources, with any load model and instrumentation
+	template<load_model Load = sigmoid_load, snapshot_instrumentation Stats = snapshot_stats>
+	using basic_synthetic_snapshot = basic_snapshot<synthetic_processes, synthetic_topology, Stats, Load>;
+
+	using synthetic_snapshot = basic_synthetic_snapshot<>;
+
+	constexpr std::size_t CPUS_PER_NODE = 64;
+
+	// Snapshot of the tasks of the configuration spread over the topology
+	template<typename Snapshot = synthetic_snapshot>
+	auto make_snapshot(const synthetic_config & config, const synthetic_topology & topo, const std::size_t workers = 1)
+	    -> std::unique_ptr<Snapshot>
+	{
+		return std::make_unique<Snapshot>(synthetic_processes(topo, config), topo, workers);
+	}
+
+	// Synthetic system with state.range(0) tasks and state.range(1) CPUs (64 CPUs per node), the rest as in the
+	// configuration. Its size goes to the counters of the benchmark.
+	template<typename Snapshot = synthetic_snapshot>
+	auto make_snapshot(benchmark::State & state, synthetic_config config = {}, const std::size_t workers = 1)
+	    -> std::unique_ptr<Snapshot>
+	{
+		config.tasks    = static_cast<std::size_t>(state.range(0));
+		const auto cpus = static_cast<std::size_t>(state.range(1));
+
+		const synthetic_topology topo(cpus, std::max<std::size_t>(1, cpus / CPUS_PER_NODE));
+
+		state.counters["tasks"] = static_cast<double>(config.tasks);
+		state.counters["cpus"]  = static_cast<double>(cpus);
+		state.counters["nodes"] = static_cast<double>(topo.num_of_nodes());
+
+		return make_snapshot<Snapshot>(config, topo, workers);
+	}
+} // namespace syssnap::bench
@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <syssnap/bitset.hpp>
+
+namespace
+{
+	// state.range(0) CPUs, split in 2 halves that overlap in a quarter of the CPUs
+	auto make_halves(const benchmark::State & state)
+	{
+		const auto cpus = static_cast<syssnap::cpu_t>(state.range(0));
+
+		std::vector<syssnap::cpu_t> first;
+		std::vector<syssnap::cpu_t> second;
+		for (syssnap::cpu_t cpu = 0; cpu < cpus; ++cpu)
+		{
+			if (cpu < cpus / 2 + cpus / 8) { first.emplace_back(cpu); }
+			if (cpu >= cpus / 2 - cpus / 8) { second.emplace_back(cpu); }
+		}
+
+		return std::pair{ first, second };
+	}
+
+	// Intersection of two CPU lists, checking each CPU of one with a search in the other
+	void BM_cpu_list_intersection(benchmark::State & state)
+	{
+		const auto [first, second] = make_halves(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			std::vector<syssnap::cpu_t> both;
+			for (const auto cpu : first)
+			{
+				if (std::ranges::find(second, cpu) != second.end()) { both.emplace_back(cpu); }
+			}
+			benchmark::DoNotOptimize(both);
+		}
+	}
+
+	// Same, with sets
+	void BM_cpu_bitset_intersection(benchmark::State & state)
+	{
+		const auto [first, second] = make_halves(state);
+
+		const syssnap::cpu_bitset first_set(first);
+		const syssnap::cpu_bitset second_set(second);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			benchmark::DoNotOptimize((first_set & second_set).count());
+		}
+	}
+
+	// Iterating the CPUs of a set
+	void BM_cpu_bitset_iterate(benchmark::State & state)
+	{
+		const auto [first, second] = make_halves(state);
+
+		const syssnap::cpu_bitset set(first);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			for (const auto cpu : set)
+			{
+				benchmark::DoNotOptimize(cpu);
+			}
+		}
+	}
+
+	void apply_cpus(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "cpus" })->Arg(64)->Arg(1'024)->Arg(4'096);
+	}
+} // namespace
+
+BENCHMARK(BM_cpu_list_intersection)->Apply(apply_cpus);
+BENCHMARK(BM_cpu_bitset_intersection)->Apply(apply_cpus);
+BENCHMARK(BM_cpu_bitset_iterate)->Apply(apply_cpus);
@@ -0,0 +1,52 @@
+#include <benchmark/benchmark.h>
+
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_system.hpp"
+
+namespace
+{
+	using syssnap::bench::make_snapshot;
+
+	// Migrations of every TID of node 0 to the last node (each one looks up and updates the least loaded CPU)
+	void BM_migrate_to_node(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+		const auto node     = snapshot->system_topology().max_node();
+		const auto pids     = snapshot->original_pids_in_node(0);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			for (const auto pid : pids)
+			{
+				snapshot->migrate_to_node(pid, node);
+			}
+
+			state.PauseTiming();
+			snapshot->rollback();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(pids.size()));
+	}
+
+	// The 8 least loaded CPUs of a node
+	void BM_least_loaded_cpus(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			benchmark::DoNotOptimize(snapshot->least_loaded_cpus(0, 8));
+		}
+	}
+
+	void tasks_cpus(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "tasks", "cpus" })->ArgsProduct({ { 10'000, 100'000 }, { 64, 1'024 } });
+	}
+} // namespace
+
+BENCHMARK(BM_migrate_to_node)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_least_loaded_cpus)->Apply(tasks_cpus);
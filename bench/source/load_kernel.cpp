@@ -0,0 +1,138 @@
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <syssnap/load.hpp>
+#include <syssnap/load_models.hpp>
+
+namespace
+{
+	auto random_cpu_use(const std::size_t tasks)
+	{
+		std::mt19937                          gen{ 42 }; // NOLINT
+		std::uniform_real_distribution<float> dist{ 0.0F, 5.0F };
+
+		std::vector<float> cpu_use(tasks);
+		for (auto & use : cpu_use)
+		{
+			use = dist(gen);
+		}
+		return cpu_use;
+	}
+
+	// Per-TID formulation: three passes over (TID, use) pairs and a hash insert per TID
+	void BM_load_sigmoid_per_pid(benchmark::State & state)
+	{
+		const auto tasks   = static_cast<std::size_t>(state.range(0));
+		const auto cpu_use = random_cpu_use(tasks);
+
+		std::vector<std::pair<pid_t, float>> pid_usage(tasks);
+		for (std::size_t i = 0; i < tasks; ++i)
+		{
+			pid_usage[i] = { static_cast<pid_t>(i), cpu_use[i] };
+		}
+
+		std::unordered_map<pid_t, float> pid_load_map;
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			auto total = 0.0F;
+			for (const auto & [pid, use] : pid_usage)
+			{
+				total += use;
+			}
+			auto max = 0.0F;
+			for (const auto & [pid, use] : pid_usage)
+			{
+				max = std::max(max, use);
+			}
+
+			const auto free  = std::clamp(100.0F - total, 0.0F, 100.0F);
+			const auto alpha = syssnap::detail::sigmoid_weight_table().at(syssnap::idx(static_cast<int>(free)));
+			const auto beta  = 1 - alpha;
+
+			for (const auto & [pid, use] : pid_usage)
+			{
+				pid_load_map[pid] = alpha * std::min(1.0F, use / free) + beta * std::min(1.0F, use / max);
+			}
+
+			benchmark::DoNotOptimize(pid_load_map);
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	void BM_load_sigmoid_batch(benchmark::State & state)
+	{
+		const auto tasks   = static_cast<std::size_t>(state.range(0));
+		const auto cpu_use = random_cpu_use(tasks);
+
+		std::vector<float> load(tasks);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			benchmark::DoNotOptimize(syssnap::compute_load_sigmoid(cpu_use, load));
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	// One CPU with each load model, as the snapshot computes it on every update (prepare() included)
+	template<typename Load>
+	void BM_load_model(benchmark::State & state)
+	{
+		const auto tasks   = static_cast<std::size_t>(state.range(0));
+		const auto cpu_use = random_cpu_use(tasks);
+
+		std::vector<pid_t> pids(tasks);
+		std::iota(pids.begin(), pids.end(), 1);
+
+		std::vector<float> weight(tasks);
+		for (std::size_t i = 0; i < tasks; ++i)
+		{
+			weight[i] = syssnap::nice_to_weight(static_cast<int>(i % 40) - 20); // NOLINT
+		}
+
+		std::vector<float> load(tasks);
+
+		Load                     model;
+		const syssnap::cpu_tasks cpu{ pids, cpu_use, weight };
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			if constexpr (requires { model.prepare(pids, true); }) { model.prepare(pids, true); }
+			benchmark::DoNotOptimize(model.compute(cpu, load));
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	// What the weighted models add per TID on the live system: reading its nice
+	void BM_read_nice(benchmark::State & state)
+	{
+		const auto pid = getpid();
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			benchmark::DoNotOptimize(syssnap::read_nice(pid));
+		}
+
+		state.SetItemsProcessed(state.iterations());
+	}
+} // namespace
+
+BENCHMARK(BM_load_sigmoid_per_pid)->RangeMultiplier(8)->Range(8, 32'768);
+BENCHMARK(BM_load_sigmoid_batch)->RangeMultiplier(8)->Range(8, 32'768);
+BENCHMARK_TEMPLATE(BM_load_model, syssnap::sigmoid_load)->RangeMultiplier(8)->Range(8, 32'768);
+BENCHMARK_TEMPLATE(BM_load_model, syssnap::linear_load)->RangeMultiplier(8)->Range(8, 32'768);
+BENCHMARK_TEMPLATE(BM_load_model, syssnap::nice_weighted_load)->RangeMultiplier(8)->Range(8, 32'768);
+BENCHMARK_TEMPLATE(BM_load_model, syssnap::decayed_load)->RangeMultiplier(8)->Range(8, 32'768);
+BENCHMARK(BM_read_nice);
@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <syssnap/membership.hpp>
+
+namespace
+{
+	constexpr std::size_t CPUS = 64;
+
+	// Random CPU for each of the TIDs 0..tasks-1
+	auto random_cpus(const std::size_t tasks)
+	{
+		std::mt19937                          gen{ 42 }; // NOLINT
+		std::uniform_int_distribution<size_t> dist{ 0, CPUS - 1 };
+
+		std::vector<std::size_t> cpus(tasks);
+		for (auto & cpu : cpus)
+		{
+			cpu = dist(gen);
+		}
+		return cpus;
+	}
+
+	void BM_iterate_unordered_set(benchmark::State & state)
+	{
+		const auto tasks = static_cast<std::size_t>(state.range(0));
+
+		const auto cpus = random_cpus(tasks);
+
+		std::vector<std::unordered_set<pid_t>> cpu_pids(CPUS);
+		for (std::size_t pid = 0; pid < tasks; ++pid)
+		{
+			cpu_pids[cpus[pid]].insert(static_cast<pid_t>(pid));
+		}
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			long sum = 0;
+			for (const auto & pids : cpu_pids)
+			{
+				for (const auto pid : pids)
+				{
+					sum += pid;
+				}
+			}
+			benchmark::DoNotOptimize(sum);
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	void BM_iterate_membership(benchmark::State & state)
+	{
+		const auto tasks = static_cast<std::size_t>(state.range(0));
+
+		const auto cpus = random_cpus(tasks);
+
+		syssnap::membership cpu_pids{ CPUS };
+		for (std::size_t pid = 0; pid < tasks; ++pid)
+		{
+			cpu_pids.insert(cpus[pid], static_cast<pid_t>(pid));
+		}
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			long sum = 0;
+			for (std::size_t cpu = 0; cpu < CPUS; ++cpu)
+			{
+				for (const auto pid : cpu_pids[cpu])
+				{
+					sum += pid;
+				}
+			}
+			benchmark::DoNotOptimize(sum);
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	// Move every TID to another CPU and back
+	void BM_move_unordered_set(benchmark::State & state)
+	{
+		const auto tasks = static_cast<std::size_t>(state.range(0));
+		const auto cpus  = random_cpus(tasks);
+
+		std::vector<std::unordered_set<pid_t>> cpu_pids(CPUS);
+		for (std::size_t pid = 0; pid < tasks; ++pid)
+		{
+			cpu_pids[cpus[pid]].insert(static_cast<pid_t>(pid));
+		}
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			for (std::size_t pid = 0; pid < tasks; ++pid)
+			{
+				const auto from = cpus[pid];
+				const auto to   = (from + 1) % CPUS;
+
+				cpu_pids[from].erase(static_cast<pid_t>(pid));
+				cpu_pids[to].insert(static_cast<pid_t>(pid));
+				cpu_pids[to].erase(static_cast<pid_t>(pid));
+				cpu_pids[from].insert(static_cast<pid_t>(pid));
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	void BM_move_membership(benchmark::State & state)
+	{
+		const auto tasks = static_cast<std::size_t>(state.range(0));
+		const auto cpus  = random_cpus(tasks);
+
+		syssnap::membership          cpu_pids{ CPUS };
+		std::vector<syssnap::slot_t> slots(tasks);
+		for (std::size_t pid = 0; pid < tasks; ++pid)
+		{
+			slots[pid] = cpu_pids.insert(cpus[pid], static_cast<pid_t>(pid));
+		}
+
+		const auto move = [&](const std::size_t pid, const std::size_t from, const std::size_t to) {
+			if (const auto moved = cpu_pids.erase(from, slots[pid])) { slots[static_cast<size_t>(*moved)] = slots[pid]; }
+			slots[pid] = cpu_pids.insert(to, static_cast<pid_t>(pid));
+		};
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			for (std::size_t pid = 0; pid < tasks; ++pid)
+			{
+				const auto from = cpus[pid];
+				const auto to   = (from + 1) % CPUS;
+
+				move(pid, from, to);
+				move(pid, to, from);
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+} // namespace
+
+BENCHMARK(BM_iterate_unordered_set)->RangeMultiplier(10)->Range(1'000, 100'000);
+BENCHMARK(BM_iterate_membership)->RangeMultiplier(10)->Range(1'000, 100'000);
+BENCHMARK(BM_move_unordered_set)->RangeMultiplier(10)->Range(1'000, 100'000);
+BENCHMARK(BM_move_membership)->RangeMultiplier(10)->Range(1'000, 100'000);
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include <syssnap/planner.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_system.hpp"
+
+namespace
+{
+	using syssnap::bench::make_snapshot;
+
+	// Plan of up to state.range(2) migrations (the snapshot is not changed)
+	void BM_planner_plan(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		syssnap::planner_config config;
+		config.max_migrations = static_cast<std::size_t>(state.range(2));
+
+		const syssnap::planner planner(config);
+
+		std::size_t migrations = 0;
+		for ([[maybe_unused]] auto _ : state)
+		{
+			const auto plan = planner.plan(*snapshot);
+			migrations      = plan.size();
+			benchmark::DoNotOptimize(plan);
+		}
+
+		state.counters["migrations"] = static_cast<double>(migrations);
+	}
+
+	// Tasks x CPUs x budget
+	void tasks_cpus_budget(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "tasks", "cpus", "budget" })->ArgsProduct({ { 10'000, 100'000 }, { 256, 1'024 }, { 64, 1'024 } });
+	}
+} // namespace
+
+BENCHMARK(BM_planner_plan)->Apply(tasks_cpus_budget)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include <syssnap/published.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_system.hpp"
+
+namespace
+{
+	// 10k tasks on 256 CPUs, publishing to a channel
+	auto make_snapshot(const std::shared_ptr<syssnap::version_channel> & channel)
+	{
+		const syssnap::synthetic_topology topo(256, 4);
+
+		syssnap::synthetic_config config;
+		config.tasks = 10'000;
+
+		auto snapshot = syssnap::bench::make_snapshot(config, topo);
+		snapshot->publish_to(channel);
+		return snapshot;
+	}
+
+	// Cost of publishing a version (copy of the committed state)
+	void BM_published_publish(benchmark::State & state)
+	{
+		auto       channel  = std::make_shared<syssnap::version_channel>();
+		const auto snapshot = make_snapshot(channel);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			benchmark::DoNotOptimize(channel->publish(*snapshot));
+		}
+	}
+
+	// Readers pinning the latest version and reading the load of a CPU, while nobody writes
+	void BM_published_acquire(benchmark::State & state)
+	{
+		static auto channel  = std::make_shared<syssnap::version_channel>();
+		static auto snapshot = make_snapshot(channel);
+
+		const auto cpu = static_cast<syssnap::cpu_t>(state.thread_index());
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			const auto version = channel->acquire();
+			benchmark::DoNotOptimize(version->load_of_cpu(cpu));
+		}
+	}
+} // namespace
+
+BENCHMARK(BM_published_publish)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_published_acquire)->ThreadRange(1, 8);
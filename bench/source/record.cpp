@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <syssnap/record.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_system.hpp"
+
+namespace
+{
+	using syssnap::bench::make_snapshot;
+
+	auto temp_record()
+	{
+		auto path = std::filesystem::temp_directory_path() / fmt::format("syssnap_bench_{}.bin", getpid());
+		std::filesystem::remove(path);
+		return path;
+	}
+
+	// Encoding one frame into a reused buffer
+	void BM_record_encode(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		std::vector<std::byte> buffer;
+		for ([[maybe_unused]] auto _ : state)
+		{
+			buffer.clear();
+			syssnap::record::encode_frame(buffer, *snapshot, std::chrono::nanoseconds{ 0 });
+			benchmark::DoNotOptimize(buffer.data());
+		}
+
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(buffer.size()));
+		state.counters["frame_bytes"] = static_cast<double>(buffer.size());
+	}
+
+	// Appending one frame per tick to a record file
+	void BM_record_append(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+		const auto path     = temp_record();
+
+		std::size_t frame_bytes = 0;
+		{
+			syssnap::record::writer writer(path, snapshot->system_topology());
+
+			const auto start = std::filesystem::file_size(path);
+			for ([[maybe_unused]] auto _ : state)
+			{
+				writer.append(*snapshot);
+			}
+			writer.flush();
+
+			frame_bytes = (std::filesystem::file_size(path) - start) / std::max<std::size_t>(1, writer.frames());
+		}
+
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(frame_bytes));
+		state.counters["frame_bytes"] = static_cast<double>(frame_bytes);
+
+		std::filesystem::remove(path);
+	}
+
+	// Mapping a record and summing the load of every CPU of every frame (the frames are not copied)
+	void BM_record_read(benchmark::State & state)
+	{
+		constexpr std::size_t FRAMES = 16;
+
+		const auto snapshot = make_snapshot(state);
+		const auto path     = temp_record();
+
+		{
+			syssnap::record::writer writer(path, snapshot->system_topology());
+			for (std::size_t i = 0; i < FRAMES; ++i)
+			{
+				writer.append(*snapshot);
+			}
+		}
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			const syssnap::record::reader reader(path);
+
+			auto total = 0.0F;
+			for (std::size_t i = 0; i < reader.size(); ++i)
+			{
+				const auto frame = reader[i];
+				for (const auto cpu : reader.system_topology().cpus())
+				{
+					total += frame.load_of_cpu(cpu);
+				}
+			}
+			benchmark::DoNotOptimize(total);
+		}
+
+		state.SetBytesProcessed(state.iterations() *
+		                        static_cast<std::int64_t>(std::filesystem::file_size(path)));
+
+		std::filesystem::remove(path);
+	}
+} // namespace
+
+namespace
+{
+	// Tasks x CPUs
+	void tasks_cpus(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "tasks", "cpus" })->ArgsProduct({ { 1'000, 10'000, 100'000 }, { 64, 1'024 } });
+	}
+} // namespace
+
+BENCHMARK(BM_record_encode)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_record_append)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_record_read)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,326 @@
+#include <benchmark/benchmark.h>
+
+#include <pthread.h>
+
+#include <atomic>
+#include <latch>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <syssnap/syssnap.hpp>
+
+namespace
+{
+	// Idle threads, so the live system has (at least) a given number of tasks
+	class idle_threads
+	{
+	private:
+		static constexpr std::size_t STACK_SIZE = 64 * 1024;
+
+		struct idle_thread
+		{
+			pthread_t          thread{};
+			std::atomic<pid_t> tid{ 0 };
+			std::latch *       stop{ nullptr };
+		};
+
+		std::unique_ptr<std::latch>               stop_ = std::make_unique<std::latch>(1);
+		std::vector<std::unique_ptr<idle_thread>> threads_;
+
+		static auto idle(void * arg) -> void *
+		{
+			auto * self = static_cast<idle_thread *>(arg);
+			self->tid   = gettid();
+			self->stop->wait();
+			return nullptr;
+		}
+
+		void join()
+		{
+			stop_->count_down();
+			for (const auto & thread : threads_)
+			{
+				pthread_join(thread->thread, nullptr);
+			}
+			threads_.clear();
+			stop_ = std::make_unique<std::latch>(1);
+		}
+
+	public:
+		idle_threads() = default;
+
+		idle_threads(const idle_threads &)                     = delete;
+		idle_threads(idle_threads &&)                          = delete;
+		auto operator=(const idle_threads &) -> idle_threads & = delete;
+		auto operator=(idle_threads &&) -> idle_threads &      = delete;
+
+		~idle_threads() { join(); }
+
+		void resize(const std::size_t count)
+		{
+			if (count < threads_.size()) { join(); }
+
+			pthread_attr_t attr;
+			pthread_attr_init(&attr);
+			pthread_attr_setstacksize(&attr, STACK_SIZE);
+
+			while (threads_.size() < count)
+			{
+				auto thread  = std::make_unique<idle_thread>();
+				thread->stop = stop_.get();
+
+				if (pthread_create(&thread->thread, &attr, idle, thread.get()) != 0)
+				{
+					pthread_attr_destroy(&attr);
+					throw std::runtime_error("Could not create enough idle threads");
+				}
+				threads_.emplace_back(std::move(thread));
+			}
+
+			pthread_attr_destroy(&attr);
+
+			// Wait until all of them are running
+			for (const auto & thread : threads_)
+			{
+				while (thread->tid.load() == 0) { sched_yield(); }
+			}
+		}
+
+		[[nodiscard]] auto tids() const
+		{
+			std::vector<pid_t> tids;
+			tids.reserve(threads_.size());
+			for (const auto & thread : threads_)
+			{
+				tids.emplace_back(thread->tid.load());
+			}
+			return tids;
+		}
+	};
+
+	idle_threads background;
+
+	// Snapshot of the live system with at least state.range(0) tasks
+	auto make_snapshot(benchmark::State & state)
+	{
+		const auto tasks = static_cast<std::size_t>(state.range(0));
+
+		auto snapshot = std::make_unique<syssnap::snapshot>();
+
+		const auto existing = snapshot->processes().size() - background.tids().size();
+		background.resize(tasks > existing ? tasks - existing : 0);
+
+		snapshot->update();
+
+		state.counters["tasks"] = static_cast<double>(snapshot->processes().size());
+		state.counters["cpus"]  = static_cast<double>(snapshot->system_topology().num_of_cpus());
+
+		return snapshot;
+	}
+
+	// TIDs of the snapshot to migrate
+	auto some_pids(const syssnap::snapshot & snapshot, const std::size_t count)
+	{
+		std::vector<pid_t> pids;
+		for (const auto & proc : snapshot.processes())
+		{
+			if (pids.size() == count) { break; }
+			pids.emplace_back(proc.pid());
+		}
+		return pids;
+	}
+
+	void BM_snapshot_construction(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			syssnap::snapshot constructed;
+			benchmark::DoNotOptimize(constructed);
+		}
+	}
+
+	void BM_snapshot_update(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->update();
+		}
+	}
+
+	// Update of a live snapshot that samples the use of its tasks, over state.range(1) updates (1 = reads every task)
+	void BM_snapshot_update_sampled(benchmark::State & state)
+	{
+		const auto live = make_snapshot(state);
+
+		syssnap::sampled_snapshot snapshot;
+		snapshot.enable_sampling({ .period = static_cast<std::size_t>(state.range(1)) });
+
+		const auto before = snapshot.processes().reads();
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot.update();
+		}
+
+		state.counters["reads"] = benchmark::Counter(static_cast<double>(snapshot.processes().reads() - before),
+		                                             benchmark::Counter::kAvgIterations);
+	}
+
+	void BM_snapshot_rebuild(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+		const auto policy   = state.range(1) == 0 ? syssnap::rebuild_policy::incremental : syssnap::rebuild_policy::full;
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->rebuild(policy);
+		}
+	}
+
+	void BM_snapshot_compute_loads(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->recompute_loads();
+		}
+	}
+
+	void BM_snapshot_load_of_cpu(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			for (const auto cpu : snapshot->system_topology().cpus())
+			{
+				benchmark::DoNotOptimize(snapshot->load_of_cpu(cpu));
+			}
+		}
+	}
+
+	void BM_snapshot_load_of_node(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			for (const auto node : snapshot->system_topology().nodes())
+			{
+				benchmark::DoNotOptimize(snapshot->load_of_node(node));
+			}
+		}
+	}
+
+	// Burst of state.range(1) migrations (the rollback is not measured)
+	void BM_snapshot_migrate_burst(benchmark::State & state)
+	{
+		const auto   snapshot = make_snapshot(state);
+		const auto   pids     = some_pids(*snapshot, static_cast<std::size_t>(state.range(1)));
+		const auto & cpus     = snapshot->system_topology().cpus();
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			for (std::size_t i = 0; i < pids.size(); ++i)
+			{
+				snapshot->migrate_to_cpu(pids[i], cpus[i % cpus.size()]);
+			}
+
+			state.PauseTiming();
+			snapshot->rollback();
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range(1));
+	}
+
+	// Rollback after a burst of state.range(1) migrations (the migrations are not measured)
+	void BM_snapshot_rollback(benchmark::State & state)
+	{
+		const auto   snapshot = make_snapshot(state);
+		const auto   pids     = some_pids(*snapshot, static_cast<std::size_t>(state.range(1)));
+		const auto & cpus     = snapshot->system_topology().cpus();
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			state.PauseTiming();
+			for (std::size_t i = 0; i < pids.size(); ++i)
+			{
+				snapshot->migrate_to_cpu(pids[i], cpus[i % cpus.size()]);
+			}
+			state.ResumeTiming();
+
+			snapshot->rollback();
+		}
+	}
+
+	// Commit (promoting the dirty state) of state.range(1) migrations of the idle threads
+	void BM_snapshot_commit(benchmark::State & state)
+	{
+		const auto   snapshot = make_snapshot(state);
+		const auto & cpus     = snapshot->system_topology().cpus();
+
+		auto pids = background.tids();
+		pids.resize(std::min(pids.size(), static_cast<std::size_t>(state.range(1))));
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			state.PauseTiming();
+			for (std::size_t i = 0; i < pids.size(); ++i)
+			{
+				snapshot->migrate_to_cpu(pids[i], cpus[i % cpus.size()]);
+			}
+			state.ResumeTiming();
+
+			benchmark::DoNotOptimize(snapshot->commit(syssnap::commit_policy::promote));
+		}
+
+		for (const auto pid : pids)
+		{
+			snapshot->unpin(pid);
+		}
+	}
+} // namespace
+
+namespace
+{
+	// Tasks (live system + idle threads)
+	void tasks(benchmark::internal::Benchmark * b)
+	{
+		b->ArgName("tasks")->Arg(1'000)->Arg(10'000);
+	}
+
+	// Tasks x rebuild policy (0 = incremental, 1 = full)
+	void tasks_policy(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "tasks", "full" })->ArgsProduct({ { 1'000, 10'000 }, { 0, 1 } });
+	}
+
+	// Tasks x sampling period
+	void tasks_period(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "tasks", "period" })->ArgsProduct({ { 1'000, 10'000 }, { 1, 32 } });
+	}
+
+	// Tasks x migrations
+	void tasks_migrations(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "tasks", "migrations" })->ArgsProduct({ { 1'000, 10'000 }, { 16, 256 } });
+	}
+} // namespace
+
+BENCHMARK(BM_snapshot_construction)->Apply(tasks)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_snapshot_update)->Apply(tasks)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_snapshot_update_sampled)->Apply(tasks_period)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_snapshot_rebuild)->Apply(tasks_policy)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_snapshot_compute_loads)->Apply(tasks)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_snapshot_load_of_cpu)->Apply(tasks);
+BENCHMARK(BM_snapshot_load_of_node)->Apply(tasks);
+BENCHMARK(BM_snapshot_migrate_burst)->Apply(tasks_migrations);
+BENCHMARK(BM_snapshot_rollback)->Apply(tasks_migrations);
+BENCHMARK(BM_snapshot_commit)->Apply(tasks_migrations)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,21 @@
+#include <benchmark/benchmark.h>
+
+#include <syssnap/syssnap.hpp>
+
+namespace
+{
+	// Rebuild + compute loads of the live system, with an increasing number of workers
+	void BM_snapshot_rebuild_workers(benchmark::State & state)
+	{
+		syssnap::snapshot snapshot{ static_cast<std::size_t>(state.range(0)) };
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot.rebuild();
+		}
+
+		state.counters["tasks"] = static_cast<double>(snapshot.processes().size());
+	}
+} // namespace
+
+BENCHMARK(BM_snapshot_rebuild_workers)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
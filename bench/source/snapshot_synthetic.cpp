@@ -0,0 +1,191 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include <syssnap/stats.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_system.hpp"
+
+namespace
+{
+	using syssnap::bench::synthetic_snapshot;
+
+	using uninstrumented_snapshot = syssnap::bench::basic_synthetic_snapshot<syssnap::sigmoid_load, syssnap::no_stats>;
+
+	// Synthetic system with state.range(0) tasks and state.range(1) CPUs, where some tasks move and exit on each update
+	template<typename Snapshot = synthetic_snapshot>
+	auto make_snapshot(benchmark::State & state, const std::size_t workers = 1)
+	{
+		syssnap::synthetic_config config;
+		config.moves_per_update = 0.01F;
+		config.churn_per_update = 0.001F;
+
+		return syssnap::bench::make_snapshot<Snapshot>(state, config, workers);
+	}
+
+	void BM_synthetic_update(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->update();
+		}
+	}
+
+	// Same, without the per-phase instrumentation, to measure its overhead
+	void BM_synthetic_update_uninstrumented(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot<uninstrumented_snapshot>(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->update();
+		}
+	}
+
+	// Update that also adds every TID and CPU to a 16-deep history
+	void BM_synthetic_update_history(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		syssnap::history_config config;
+		config.max_tasks    = static_cast<std::size_t>(state.range(0)) * 2;
+		config.smooth_loads = true;
+		snapshot->enable_history(config);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->update();
+		}
+	}
+
+	// Update with adaptive sampling: only the busy TIDs and a 1/16 share of the rest draw a new use.
+	// Reports the usages read per update (what a procfs source would read).
+	void BM_synthetic_update_sampled(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+		snapshot->enable_sampling({ .hot_threshold = 5.0F, .period = 16 });
+
+		const auto reads = snapshot->processes().reads();
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->update();
+		}
+
+		state.counters["reads"] = benchmark::Counter(static_cast<double>(snapshot->processes().reads() - reads),
+		                                             benchmark::Counter::kAvgIterations);
+	}
+
+	void BM_synthetic_rebuild(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+		const auto policy   = state.range(2) == 0 ? syssnap::rebuild_policy::incremental : syssnap::rebuild_policy::full;
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->rebuild(policy);
+		}
+	}
+
+	void BM_synthetic_rebuild_workers(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state, static_cast<std::size_t>(state.range(2)));
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->rebuild();
+		}
+	}
+
+	// Rebuild of 100k tasks on 1024 CPUs when only state.range(0)% of them are in the scope
+	void BM_synthetic_scoped_rebuild(benchmark::State & state)
+	{
+		const auto percent = state.range(0);
+		const auto topo    = syssnap::synthetic_topology(1'024, 1'024 / syssnap::bench::CPUS_PER_NODE);
+
+		syssnap::synthetic_config config;
+		config.tasks = 100'000;
+
+		const auto managed = syssnap::scope::predicate([percent](const pid_t pid) { return pid % 100 < percent; });
+
+		synthetic_snapshot snapshot(syssnap::synthetic_processes(topo, config), topo, 1, managed);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot.rebuild(syssnap::rebuild_policy::full);
+		}
+	}
+
+	void BM_synthetic_compute_loads(benchmark::State & state)
+	{
+		const auto snapshot = make_snapshot(state);
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			snapshot->recompute_loads();
+		}
+	}
+
+	// Commit (promoting the dirty state) of 1% of the tasks spread over every CPU (the migrations are not measured)
+	void BM_synthetic_commit(benchmark::State & state)
+	{
+		const auto   snapshot = make_snapshot(state);
+		const auto & cpus     = snapshot->system_topology().cpus();
+
+		std::vector<pid_t> pids;
+		for (const auto & task : snapshot->processes())
+		{
+			if (pids.size() == snapshot->processes().size() / 100) { break; }
+			pids.emplace_back(task.pid());
+		}
+
+		for ([[maybe_unused]] auto _ : state)
+		{
+			state.PauseTiming();
+			for (std::size_t i = 0; i < pids.size(); ++i)
+			{
+				snapshot->migrate_to_cpu(pids[i], cpus[i % cpus.size()]);
+			}
+			state.ResumeTiming();
+
+			benchmark::DoNotOptimize(snapshot->commit(syssnap::commit_policy::promote));
+		}
+
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(pids.size()));
+	}
+} // namespace
+
+namespace
+{
+	// Tasks x CPUs
+	void tasks_cpus(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "tasks", "cpus" })->ArgsProduct({ { 1'000, 10'000, 100'000 }, { 64, 256, 1'024 } });
+	}
+
+	// Tasks x CPUs x rebuild policy (0 = incremental, 1 = full)
+	void tasks_cpus_policy(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "tasks", "cpus", "full" })->ArgsProduct({ { 10'000, 100'000 }, { 64, 1'024 }, { 0, 1 } });
+	}
+
+	// 100k tasks on 1024 CPUs, with an increasing number of workers
+	void workers(benchmark::internal::Benchmark * b)
+	{
+		b->ArgNames({ "tasks", "cpus", "workers" })->ArgsProduct({ { 100'000 }, { 1'024 }, { 1, 2, 4, 8, 16 } });
+	}
+} // namespace
+
+BENCHMARK(BM_synthetic_update)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_synthetic_update_uninstrumented)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_synthetic_update_sampled)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_synthetic_update_history)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_synthetic_rebuild)->Apply(tasks_cpus_policy)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_synthetic_rebuild_workers)->Apply(workers)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_synthetic_scoped_rebuild)->ArgName("percent")->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_synthetic_compute_loads)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_synthetic_commit)->Apply(tasks_cpus)->Unit(benchmark::kMicrosecond);
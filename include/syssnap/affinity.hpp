@@ -0,0 +1,56 @@
+#pragma once
+
+#include <sched.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <new>
+
+#include "bitset.hpp"
+#include "types.hpp"
+
+namespace syssnap
+{
+	// CPU mask for sched_setaffinity(), sized for any CPU up to max_cpu
+	class cpu_mask
+	{
+	private:
+		struct cpu_set_deleter
+		{
+			void operator()(cpu_set_t * set) const { CPU_FREE(set); }
+		};
+
+		std::size_t                                 size_{};
+		std::unique_ptr<cpu_set_t, cpu_set_deleter> set_;
+
+	public:
+		template<typename Range>
+		cpu_mask(const Range & cpus, const cpu_t max_cpu) :
+		    size_(CPU_ALLOC_SIZE(idx(max_cpu) + 1)), set_(CPU_ALLOC(idx(max_cpu) + 1))
+		{
+			if (not set_) { throw std::bad_alloc(); }
+
+			CPU_ZERO_S(size_, set_.get());
+			for (const auto cpu : cpus)
+			{
+				CPU_SET_S(idx(cpu), size_, set_.get());
+			}
+		}
+
+		// Sized for the highest CPU of the set
+		explicit cpu_mask(const cpu_bitset & cpus) : cpu_mask(cpus, std::max(cpus.last(), cpu_t{ 0 })) {}
+
+		[[nodiscard]] auto contains(const cpu_t cpu) const -> bool
+		{
+			return CPU_ISSET_S(idx(cpu), size_, set_.get()) != 0;
+		}
+
+		// Pins the TID to the CPUs of the mask. Returns 0 on success, errno otherwise.
+		[[nodiscard]] auto apply(const pid_t pid) const -> int
+		{
+			if (sched_setaffinity(pid, size_, set_.get()) == 0) { return 0; }
+			return errno;
+		}
+	};
+} // namespace syssnap
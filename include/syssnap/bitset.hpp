@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Largest CPU and node ids that fit in the sets below
+	inline constexpr std::size_t MAX_CPUS  = 4096;
+	inline constexpr std::size_t MAX_NODES = 1024;
+
+	// Fixed-width set of CPU or node ids (0..Bits-1), one bit per id.
+	// Set algebra is done a word at a time and iteration skips empty words, so the cost depends on the width and the
+	// number of ids in the set, never on a search over a list.
+	template<typename Id, std::size_t Bits>
+	class id_bitset
+	{
+	private:
+		using word_t = std::uint64_t;
+
+		static constexpr std::size_t WORD_BITS = 64;
+		static constexpr std::size_t WORDS     = (Bits + WORD_BITS - 1) / WORD_BITS;
+
+		std::array<word_t, WORDS> words_{};
+
+		[[nodiscard]] static constexpr auto bit(const std::size_t i) -> word_t
+		{
+			return word_t{ 1 } << (i % WORD_BITS);
+		}
+
+		// First id in the set at or after position i (NONE if there is none)
+		[[nodiscard]] constexpr auto first_from(const std::size_t i) const -> Id
+		{
+			if (i >= Bits) { return NONE; }
+
+			auto w    = i / WORD_BITS;
+			auto word = words_[w] & (~word_t{ 0 } << (i % WORD_BITS));
+
+			while (word == 0)
+			{
+				if (++w == WORDS) { return NONE; }
+				word = words_[w];
+			}
+
+			return static_cast<Id>(w * WORD_BITS + static_cast<std::size_t>(std::countr_zero(word)));
+		}
+
+	public:
+		static constexpr Id NONE = -1;
+
+		class iterator
+		{
+		private:
+			const id_bitset * set_{ nullptr };
+			Id                id_{ NONE };
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type        = Id;
+			using difference_type   = std::ptrdiff_t;
+			using pointer           = const Id *;
+			using reference         = Id;
+
+			iterator() = default;
+
+			constexpr iterator(const id_bitset * set, const Id id) : set_(set), id_(id) {}
+
+			constexpr auto operator*() const -> Id { return id_; }
+
+			constexpr auto operator++() -> iterator &
+			{
+				id_ = set_->next(id_);
+				return *this;
+			}
+
+			constexpr auto operator++(int) -> iterator
+			{
+				auto copy = *this;
+				++*this;
+				return copy;
+			}
+
+			constexpr auto operator==(const iterator & other) const -> bool { return id_ == other.id_; }
+		};
+
+		constexpr id_bitset() = default;
+
+		template<typename Range>
+		explicit constexpr id_bitset(const Range & ids)
+		{
+			for (const auto id : ids)
+			{
+				insert(static_cast<Id>(id));
+			}
+		}
+
+		[[nodiscard]] static constexpr auto width() -> std::size_t { return Bits; }
+
+		constexpr void insert(const Id id)
+		{
+			const auto i = idx(id);
+			if (i >= Bits) { throw std::out_of_range("Id out of the range of the set."); }
+			words_[i / WORD_BITS] |= bit(i);
+		}
+
+		constexpr void erase(const Id id)
+		{
+			const auto i = idx(id);
+			if (i < Bits) { words_[i / WORD_BITS] &= ~bit(i); }
+		}
+
+		constexpr void clear() { words_.fill(0); }
+
+		[[nodiscard]] constexpr auto contains(const Id id) const -> bool
+		{
+			const auto i = static_cast<std::size_t>(id);
+			return id >= 0 and i < Bits and (words_[i / WORD_BITS] & bit(i)) != 0;
+		}
+
+		// Number of ids in the set (popcount)
+		[[nodiscard]] constexpr auto count() const -> std::size_t
+		{
+			std::size_t count = 0;
+			for (const auto word : words_)
+			{
+				count += static_cast<std::size_t>(std::popcount(word));
+			}
+			return count;
+		}
+
+		[[nodiscard]] constexpr auto empty() const -> bool
+		{
+			for (const auto word : words_)
+			{
+				if (word != 0) { return false; }
+			}
+			return true;
+		}
+
+		// Lowest id in the set (NONE if empty)
+		[[nodiscard]] constexpr auto first() const -> Id { return first_from(0); }
+
+		// Lowest id in the set after the given one (NONE if there is none)
+		[[nodiscard]] constexpr auto next(const Id id) const -> Id { return first_from(idx(id) + 1); }
+
+		// Highest id in the set (NONE if empty)
+		[[nodiscard]] constexpr auto last() const -> Id
+		{
+			for (auto w = WORDS; w-- > 0;)
+			{
+				if (words_[w] != 0)
+				{
+					return static_cast<Id>(w * WORD_BITS + WORD_BITS - 1 -
+					                       static_cast<std::size_t>(std::countl_zero(words_[w])));
+				}
+			}
+			return NONE;
+		}
+
+		// Whether both sets have any id in common
+		[[nodiscard]] constexpr auto intersects(const id_bitset & other) const -> bool
+		{
+			for (std::size_t w = 0; w < WORDS; ++w)
+			{
+				if ((words_[w] & other.words_[w]) != 0) { return true; }
+			}
+			return false;
+		}
+
+		[[nodiscard]] constexpr auto begin() const -> iterator { return { this, first() }; }
+
+		[[nodiscard]] constexpr auto end() const -> iterator { return { this, NONE }; }
+
+		[[nodiscard]] auto to_vector() const -> std::vector<Id>
+		{
+			std::vector<Id> ids;
+			ids.reserve(count());
+			for (const auto id : *this)
+			{
+				ids.emplace_back(id);
+			}
+			return ids;
+		}
+
+		constexpr auto operator&=(const id_bitset & other) -> id_bitset &
+		{
+			for (std::size_t w = 0; w < WORDS; ++w)
+			{
+				words_[w] &= other.words_[w];
+			}
+			return *this;
+		}
+
+		constexpr auto operator|=(const id_bitset & other) -> id_bitset &
+		{
+			for (std::size_t w = 0; w < WORDS; ++w)
+			{
+				words_[w] |= other.words_[w];
+			}
+			return *this;
+		}
+
+		// Removes the ids of the other set
+		constexpr auto operator-=(const id_bitset & other) -> id_bitset &
+		{
+			for (std::size_t w = 0; w < WORDS; ++w)
+			{
+				words_[w] &= ~other.words_[w];
+			}
+			return *this;
+		}
+
+		[[nodiscard]] friend constexpr auto operator&(id_bitset lhs, const id_bitset & rhs) -> id_bitset
+		{
+			return lhs &= rhs;
+		}
+
+		[[nodiscard]] friend constexpr auto operator|(id_bitset lhs, const id_bitset & rhs) -> id_bitset
+		{
+			return lhs |= rhs;
+		}
+
+		[[nodiscard]] friend constexpr auto operator-(id_bitset lhs, const id_bitset & rhs) -> id_bitset
+		{
+			return lhs -= rhs;
+		}
+
+		[[nodiscard]] constexpr auto operator==(const id_bitset & other) const -> bool = default;
+	};
+
+	using cpu_bitset  = id_bitset<cpu_t, MAX_CPUS>;
+	using node_bitset = id_bitset<node_t, MAX_NODES>;
+} // namespace syssnap
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <range/v3/all.hpp>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	enum class migration_status
+	{
+		applied,  // The affinity of the TID was changed
+		vanished, // The TID exited between the snapshot and the commit
+		denied    // The kernel refused the change (permissions, CPUs not allowed...)
+	};
+
+	[[nodiscard]] inline auto migration_status_from_errno(const int error) -> migration_status
+	{
+		if (error == 0) { return migration_status::applied; }
+		if (error == ESRCH) { return migration_status::vanished; }
+		return migration_status::denied;
+	}
+
+	struct migration_result
+	{
+		pid_t            pid{};
+		migration_status status{ migration_status::applied };
+		int              error{ 0 }; // errno of the affinity call (0 if applied)
+	};
+
+	// Pages of a process moved to the node of its migrated threads
+	struct memory_migration_result
+	{
+		pid_t         pid{};
+		node_t        node{};
+		std::uint64_t bytes{ 0 }; // Bytes moved to the node by this commit
+		int           error{ 0 }; // errno of the page migration (0 on success)
+	};
+
+	// Outcome of snapshot::commit()
+	struct commit_report
+	{
+		std::vector<migration_result> results;
+
+		// Page migrations done by this commit (only with memory migration enabled, see enable_memory_migration)
+		std::vector<memory_migration_result> memory;
+
+		std::chrono::nanoseconds elapsed{ 0 };
+
+		[[nodiscard]] auto count(const migration_status status) const -> std::size_t
+		{
+			return static_cast<std::size_t>(
+			    ranges::count_if(results, [&](const auto & result) { return result.status == status; }));
+		}
+
+		[[nodiscard]] auto applied() const -> std::size_t { return count(migration_status::applied); }
+
+		[[nodiscard]] auto vanished() const -> std::size_t { return count(migration_status::vanished); }
+
+		[[nodiscard]] auto denied() const -> std::size_t { return count(migration_status::denied); }
+
+		[[nodiscard]] auto all_applied() const -> bool { return applied() == results.size(); }
+
+		// Bytes moved by the page migrations that succeeded
+		[[nodiscard]] auto memory_moved() const -> std::uint64_t
+		{
+			return ranges::accumulate(memory | ranges::views::filter([](const auto & m) { return m.error == 0; }) |
+			                              ranges::views::transform(&memory_migration_result::bytes),
+			                          std::uint64_t{ 0 });
+		}
+	};
+} // namespace syssnap
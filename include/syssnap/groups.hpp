@@ -0,0 +1,67 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Which aggregates the snapshot keeps besides the per-TID maps
+	struct grouping_config
+	{
+		bool processes{ true }; // Per thread group (TGID), i.e. per process
+		bool cgroups{ true };   // Per cgroup (the unified hierarchy, or the first one listed with cgroups v1)
+	};
+
+	// Aggregates of the managed TIDs of a process or a cgroup
+	struct task_group
+	{
+		std::vector<pid_t> threads; // Managed TIDs of the group
+
+		float use{ 0.0F };  // Use of its TIDs (%)
+		float load{ 0.0F }; // Load of its TIDs
+
+		std::vector<std::uint32_t> threads_on; // input: node, output: TIDs of the group there (after the migrations)
+
+		[[nodiscard]] auto size() const -> std::size_t { return threads.size(); }
+
+		[[nodiscard]] auto empty() const -> bool { return threads.empty(); }
+
+		[[nodiscard]] auto threads_on_node(const node_t node) const -> std::uint32_t
+		{
+			return idx(node) < threads_on.size() ? threads_on[idx(node)] : 0;
+		}
+
+		void add(const pid_t pid, const node_t node, const float task_use, const float task_load)
+		{
+			threads.push_back(pid);
+			use += task_use;
+			load += task_load;
+
+			if (idx(node) >= threads_on.size()) { threads_on.resize(idx(node) + 1, 0); }
+			++threads_on[idx(node)];
+		}
+
+		// A TID of the group moved to another node
+		void move(const node_t from, const node_t to)
+		{
+			if (from == to) { return; }
+
+			if (idx(to) >= threads_on.size()) { threads_on.resize(idx(to) + 1, 0); }
+			--threads_on.at(idx(from));
+			++threads_on[idx(to)];
+		}
+
+		// Keeps the capacity, so the groups that survive an update do not allocate again
+		void clear()
+		{
+			threads.clear();
+			use  = 0.0F;
+			load = 0.0F;
+			threads_on.assign(threads_on.size(), 0);
+		}
+	};
+} // namespace syssnap
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	using domain_t = int;
+
+	// Levels of CPUs that share a resource, from the innermost to the outermost
+	enum class domain_level
+	{
+		core,   // SMT siblings (hardware threads of the same core)
+		l2,     // CPUs sharing an L2 cache
+		l3,     // CPUs sharing an L3 (last-level) cache
+		package // CPUs in the same physical package (socket)
+	};
+
+	inline constexpr std::size_t DOMAIN_LEVELS = 4;
+
+	[[nodiscard]] constexpr auto level_index(const domain_level level) -> std::size_t
+	{
+		return static_cast<std::size_t>(level);
+	}
+
+	// Parses a CPU list as printed by the kernel (e.g. "0-3,8,10-11")
+	[[nodiscard]] inline auto parse_cpu_list(const std::string_view list) -> std::vector<cpu_t>
+	{
+		std::vector<cpu_t> cpus;
+
+		std::size_t pos = 0;
+		while (pos < list.size())
+		{
+			auto end = list.find(',', pos);
+			if (end == std::string_view::npos) { end = list.size(); }
+
+			const auto range = list.substr(pos, end - pos);
+			const auto dash  = range.find('-');
+
+			cpu_t first = 0;
+			cpu_t last  = 0;
+			if (std::from_chars(range.data(), range.data() + std::min(dash, range.size()), first).ec == std::errc{})
+			{
+				last = first;
+				if (dash != std::string_view::npos)
+				{
+					std::from_chars(range.data() + dash + 1, range.data() + range.size(), last);
+				}
+
+				for (auto cpu = first; cpu <= last; ++cpu)
+				{
+					cpus.emplace_back(cpu);
+				}
+			}
+
+			pos = end + 1;
+		}
+
+		return cpus;
+	}
+
+	// Cores, caches and packages of the CPUs, as domains of CPUs at each level.
+	// Domains are numbered from 0 at each level, in the order of their first CPU.
+	class cpu_hierarchy
+	{
+	private:
+		static constexpr domain_t NO_DOMAIN = -1;
+
+		std::array<std::vector<domain_t>, DOMAIN_LEVELS>           cpu_domain_;  // input: CPU, output: domain
+		std::array<std::vector<std::vector<cpu_t>>, DOMAIN_LEVELS> domain_cpus_; // input: domain, output: CPUs
+
+		// group_of(cpu) returns the CPUs that share the level with the CPU. Each group is identified by its first CPU.
+		template<typename GroupOf>
+		void assign(const domain_level level, const std::vector<cpu_t> & cpus, GroupOf && group_of)
+		{
+			auto & cpu_domain  = cpu_domain_.at(level_index(level));
+			auto & domain_cpus = domain_cpus_.at(level_index(level));
+
+			const auto size_cpus = cpus.empty() ? 0 : idx(*std::ranges::max_element(cpus)) + 1;
+			cpu_domain.assign(size_cpus, NO_DOMAIN);
+			domain_cpus.clear();
+
+			std::unordered_map<cpu_t, domain_t> domain_of_first; // input: first CPU of the group, output: domain
+
+			for (const auto cpu : cpus)
+			{
+				const auto group = group_of(cpu);
+				const auto first = group.empty() ? cpu : std::ranges::min(group);
+
+				const auto [it, inserted] = domain_of_first.try_emplace(first, static_cast<domain_t>(domain_cpus.size()));
+				if (inserted) { domain_cpus.emplace_back(); }
+
+				cpu_domain[idx(cpu)] = it->second;
+				domain_cpus[idx(it->second)].emplace_back(cpu);
+			}
+		}
+
+		[[nodiscard]] static auto read_cpu_list(const std::filesystem::path & path) -> std::vector<cpu_t>
+		{
+			std::ifstream file(path);
+			std::string   list;
+			std::getline(file, list);
+			return parse_cpu_list(list);
+		}
+
+		[[nodiscard]] static auto read_first_line(const std::filesystem::path & path) -> std::string
+		{
+			std::ifstream file(path);
+			std::string   line;
+			std::getline(file, line);
+			return line;
+		}
+
+		// CPUs that share the data/unified cache of the given level with the CPU (empty if there is none)
+		[[nodiscard]] static auto cache_cpus(const std::filesystem::path & cpu_dir, const int level) -> std::vector<cpu_t>
+		{
+			std::error_code ec;
+			for (const auto & index : std::filesystem::directory_iterator(cpu_dir / "cache", ec))
+			{
+				if (not index.path().filename().string().starts_with("index")) { continue; }
+
+				if (read_first_line(index.path() / "level") != std::to_string(level)) { continue; }
+				if (read_first_line(index.path() / "type") == "Instruction") { continue; }
+
+				return read_cpu_list(index.path() / "shared_cpu_list");
+			}
+
+			return {};
+		}
+
+		// First of the files that exists, for the attributes renamed across kernel versions
+		[[nodiscard]] static auto read_cpu_list(const std::filesystem::path & dir, const char * name,
+		                                        const char * old_name) -> std::vector<cpu_t>
+		{
+			auto cpus = read_cpu_list(dir / name);
+			if (cpus.empty()) { cpus = read_cpu_list(dir / old_name); }
+			return cpus;
+		}
+
+	public:
+		cpu_hierarchy() = default;
+
+		// Reads the hierarchy of the CPUs from sysfs (/sys/devices/system/cpu by default).
+		// A level the kernel does not report falls back to the level below (e.g. no L3 -> the L2, no L2 -> the core).
+		[[nodiscard]] static auto detect(const std::vector<cpu_t> &     cpus,
+		                                 const std::filesystem::path & sysfs = "/sys/devices/system/cpu") -> cpu_hierarchy
+		{
+			struct groups
+			{
+				std::vector<cpu_t> core;
+				std::vector<cpu_t> l2;
+				std::vector<cpu_t> l3;
+				std::vector<cpu_t> package;
+			};
+
+			std::unordered_map<cpu_t, groups> groups_of; // input: CPU, output: CPUs sharing each level with it
+
+			for (const auto cpu : cpus)
+			{
+				const auto dir      = sysfs / ("cpu" + std::to_string(cpu));
+				const auto topo_dir = dir / "topology";
+
+				auto & g  = groups_of[cpu];
+				g.core    = read_cpu_list(topo_dir, "core_cpus_list", "thread_siblings_list");
+				g.package = read_cpu_list(topo_dir, "package_cpus_list", "core_siblings_list");
+				g.l2      = cache_cpus(dir, 2);
+				g.l3      = cache_cpus(dir, 3);
+
+				if (g.core.empty()) { g.core = { cpu }; }
+				if (g.l2.empty()) { g.l2 = g.core; }
+				if (g.l3.empty()) { g.l3 = g.l2; }
+				if (g.package.empty()) { g.package = g.l3; }
+			}
+
+			cpu_hierarchy hierarchy;
+			hierarchy.assign(domain_level::core, cpus, [&](const cpu_t cpu) { return groups_of[cpu].core; });
+			hierarchy.assign(domain_level::l2, cpus, [&](const cpu_t cpu) { return groups_of[cpu].l2; });
+			hierarchy.assign(domain_level::l3, cpus, [&](const cpu_t cpu) { return groups_of[cpu].l3; });
+			hierarchy.assign(domain_level::package, cpus, [&](const cpu_t cpu) { return groups_of[cpu].package; });
+			return hierarchy;
+		}
+
+		// Regular machine where CPUs are numbered consecutively: threads_per_core CPUs per core (sharing the L2),
+		// cores_per_llc cores per L3, and one package per node. An L3 never spans two nodes.
+		[[nodiscard]] static auto regular(const std::vector<node_t> & cpu_node_map, const std::size_t threads_per_core = 1,
+		                                  const std::size_t cores_per_llc = std::numeric_limits<std::size_t>::max())
+		    -> cpu_hierarchy
+		{
+			std::vector<cpu_t> cpus(cpu_node_map.size());
+			for (std::size_t cpu = 0; cpu < cpus.size(); ++cpu)
+			{
+				cpus[cpu] = static_cast<cpu_t>(cpu);
+			}
+
+			const auto threads = std::max<std::size_t>(1, threads_per_core);
+			const auto cores   = std::max<std::size_t>(1, cores_per_llc);
+
+			// Groups are identified by their first CPU, so that is all the group_of functions below return
+			const auto first_of_block = [](const cpu_t cpu, const std::size_t block) {
+				return std::vector<cpu_t>{ static_cast<cpu_t>(idx(cpu) / block * block) };
+			};
+
+			std::unordered_map<node_t, cpu_t> node_first_cpu; // input: node, output: its first CPU
+			for (const auto cpu : cpus)
+			{
+				node_first_cpu.try_emplace(cpu_node_map[idx(cpu)], cpu);
+			}
+
+			const auto first_of_node = [&](const cpu_t cpu) { return node_first_cpu.at(cpu_node_map[idx(cpu)]); };
+
+			cpu_hierarchy hierarchy;
+			hierarchy.assign(domain_level::core, cpus, [&](const cpu_t cpu) { return first_of_block(cpu, threads); });
+			hierarchy.assign(domain_level::l2, cpus, [&](const cpu_t cpu) { return first_of_block(cpu, threads); });
+			hierarchy.assign(domain_level::l3, cpus, [&](const cpu_t cpu) {
+				// Blocks of cores counted from the first CPU of the node
+				const auto first = first_of_node(cpu);
+				const auto block = cores > cpus.size() / threads ? cpus.size() : cores * threads;
+				return std::vector<cpu_t>{ static_cast<cpu_t>(
+				    idx(first) + (idx(cpu) - idx(first)) / block * block) };
+			});
+			hierarchy.assign(domain_level::package, cpus,
+			                 [&](const cpu_t cpu) { return std::vector<cpu_t>{ first_of_node(cpu) }; });
+			return hierarchy;
+		}
+
+		[[nodiscard]] auto num_of_domains(const domain_level level) const -> std::size_t
+		{
+			return domain_cpus_.at(level_index(level)).size();
+		}
+
+		[[nodiscard]] auto domain_of(const domain_level level, const cpu_t cpu) const -> domain_t
+		{
+			return cpu_domain_.at(level_index(level)).at(idx(cpu));
+		}
+
+		[[nodiscard]] auto cpus_in_domain(const domain_level level, const domain_t domain) const
+		    -> const std::vector<cpu_t> &
+		{
+			return domain_cpus_.at(level_index(level)).at(idx(domain));
+		}
+
+		// Hardware threads of the core of the CPU (the CPU included)
+		[[nodiscard]] auto smt_siblings(const cpu_t cpu) const -> const std::vector<cpu_t> &
+		{
+			return cpus_in_domain(domain_level::core, domain_of(domain_level::core, cpu));
+		}
+
+		// Whether both CPUs are in the same domain of the level (e.g. migrating between them keeps the L3 warm)
+		[[nodiscard]] auto shares(const domain_level level, const cpu_t cpu_1, const cpu_t cpu_2) const -> bool
+		{
+			return domain_of(level, cpu_1) == domain_of(level, cpu_2);
+		}
+
+		// Innermost level shared by both CPUs (none if they are in different packages)
+		[[nodiscard]] auto closest_shared_level(const cpu_t cpu_1, const cpu_t cpu_2) const
+		    -> std::optional<domain_level>
+		{
+			for (const auto level : { domain_level::core, domain_level::l2, domain_level::l3, domain_level::package })
+			{
+				if (shares(level, cpu_1, cpu_2)) { return level; }
+			}
+			return std::nullopt;
+		}
+	};
+} // namespace syssnap
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "membership.hpp"
+#include "types.hpp"
+
+namespace syssnap
+{
+	struct history_config
+	{
+		std::size_t depth{ 16 };          // Updates kept per TID and CPU
+		std::size_t max_tasks{ 32'768 };  // TIDs tracked at once. TIDs beyond this are not tracked
+		float       alpha{ 0.25F };       // Weight of the newest sample in the EWMA
+		bool        smooth_loads{ false }; // Compute the loads from the EWMA of the use instead of the last use
+	};
+
+	// Samples of the use of one TID or CPU, from the oldest to the newest. Points into the history, which must
+	// outlive it (and not be updated meanwhile).
+	class usage_series
+	{
+	public:
+		static constexpr std::size_t MAX_DEPTH = 256;
+
+	private:
+		std::span<const float> ring_;
+		std::size_t            newest_{ 0 }; // Position of the newest sample in the ring
+		std::size_t            count_{ 0 };
+		float                  ewma_{ 0.0F };
+
+	public:
+		usage_series() = default;
+
+		usage_series(const std::span<const float> ring, const std::size_t newest, const std::size_t count,
+		             const float ewma) :
+		    ring_(ring), newest_(newest), count_(count), ewma_(ewma)
+		{}
+
+		[[nodiscard]] auto size() const -> std::size_t { return count_; }
+
+		[[nodiscard]] auto empty() const -> bool { return count_ == 0; }
+
+		// i-th sample, 0 being the oldest one kept
+		[[nodiscard]] auto operator[](const std::size_t i) const -> float
+		{
+			return ring_[(newest_ + ring_.size() - count_ + 1 + i) % ring_.size()];
+		}
+
+		[[nodiscard]] auto latest() const -> float { return empty() ? 0.0F : ring_[newest_]; }
+
+		// Exponentially weighted moving average of every sample since the TID appeared (not only the ones kept)
+		[[nodiscard]] auto ewma() const -> float { return ewma_; }
+
+		[[nodiscard]] auto mean() const -> float
+		{
+			if (empty()) { return 0.0F; }
+
+			auto total = 0.0F;
+			for (std::size_t i = 0; i < count_; ++i)
+			{
+				total += (*this)[i];
+			}
+			return total / static_cast<float>(count_);
+		}
+
+		[[nodiscard]] auto max() const -> float
+		{
+			auto max = 0.0F;
+			for (std::size_t i = 0; i < count_; ++i)
+			{
+				max = std::max(max, (*this)[i]);
+			}
+			return max;
+		}
+
+		// Nearest-rank percentile (p in [0, 100]) of the samples kept. Sorts a copy on the stack, so it does not
+		// allocate.
+		[[nodiscard]] auto percentile(const float p) const -> float
+		{
+			if (empty()) { return 0.0F; }
+
+			std::array<float, MAX_DEPTH> sorted{};
+			for (std::size_t i = 0; i < count_; ++i)
+			{
+				sorted[i] = (*this)[i];
+			}
+
+			const auto rank = std::clamp(p, 0.0F, 100.0F) / 100.0F * static_cast<float>(count_);
+			const auto nth  = std::min(count_ - 1, static_cast<std::size_t>(std::max(std::ceil(rank), 1.0F)) - 1);
+
+			std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(nth),
+			                 sorted.begin() + static_cast<std::ptrdiff_t>(count_));
+			return sorted[nth];
+		}
+	};
+
+	// Use of each TID and CPU over the last updates, in fixed memory.
+	// Every tracked TID owns a slot, a row of `depth` samples in a single preallocated array that is used as a ring.
+	// TIDs that were not recorded in an update (they exited or left the scope) free their slot, and new TIDs are not
+	// tracked while every slot is taken, so the memory is bounded by max_tasks whatever the churn.
+	class usage_history
+	{
+		template<typename... args>
+		using fast_umap = std::unordered_map<args...>;
+
+	private:
+		static constexpr pid_t NO_PID = -1;
+
+		history_config config_;
+
+		std::uint64_t tick_{ 0 }; // Updates recorded so far
+
+		// Per-TID rings, one row per slot
+		std::vector<float>         task_samples_; // input: slot * depth + tick % depth, output: use
+		std::vector<pid_t>         slot_pid_;     // input: slot, output: TID (NO_PID if free)
+		std::vector<std::uint64_t> slot_first_;   // input: slot, output: tick of the first sample
+		std::vector<std::uint64_t> slot_last_;    // input: slot, output: tick of the last sample
+		std::vector<float>         slot_ewma_;    // input: slot, output: EWMA of the use
+		std::vector<slot_t>        free_slots_;
+
+		fast_umap<pid_t, slot_t> pid_slot_map_; // input: TID, output: slot
+
+		std::size_t untracked_{ 0 };         // TIDs not tracked in the last update for lack of slots
+		std::size_t untracked_this_tick_{ 0 }; // Same, for the update being recorded
+
+		// Per-CPU rings
+		std::vector<float> cpu_samples_; // input: CPU * depth + tick % depth, output: use
+		std::vector<float> cpu_ewma_;    // input: CPU, output: EWMA of the use
+
+		[[nodiscard]] auto position() const -> std::size_t { return tick_ % config_.depth; }
+
+		[[nodiscard]] auto update_ewma(const float ewma, const float use, const bool first) const -> float
+		{
+			return first ? use : ewma + config_.alpha * (use - ewma);
+		}
+
+		[[nodiscard]] auto task_series(const slot_t slot) const -> usage_series
+		{
+			const auto count = static_cast<std::size_t>(
+			    std::min<std::uint64_t>(config_.depth, slot_last_[slot] - slot_first_[slot] + 1));
+
+			return { std::span{ task_samples_ }.subspan(slot * config_.depth, config_.depth),
+				     slot_last_[slot] % config_.depth, count, slot_ewma_[slot] };
+		}
+
+	public:
+		usage_history(const history_config config, const std::size_t cpus) : config_(config)
+		{
+			if (config_.depth == 0 or config_.depth > usage_series::MAX_DEPTH)
+			{
+				throw std::invalid_argument("The depth of the history must be between 1 and 256");
+			}
+			if (config_.alpha <= 0.0F or config_.alpha > 1.0F)
+			{
+				throw std::invalid_argument("The EWMA weight must be in (0, 1]");
+			}
+
+			task_samples_.resize(config_.max_tasks * config_.depth, 0.0F);
+			slot_pid_.resize(config_.max_tasks, NO_PID);
+			slot_first_.resize(config_.max_tasks, 0);
+			slot_last_.resize(config_.max_tasks, 0);
+			slot_ewma_.resize(config_.max_tasks, 0.0F);
+
+			// Slots are taken from the back, so lower slots are used first
+			free_slots_.reserve(config_.max_tasks);
+			for (auto slot = config_.max_tasks; slot > 0; --slot)
+			{
+				free_slots_.emplace_back(static_cast<slot_t>(slot - 1));
+			}
+
+			pid_slot_map_.reserve(config_.max_tasks);
+
+			cpu_samples_.resize(cpus * config_.depth, 0.0F);
+			cpu_ewma_.resize(cpus, 0.0F);
+		}
+
+		[[nodiscard]] auto config() const -> const history_config & { return config_; }
+
+		// Updates recorded so far
+		[[nodiscard]] auto ticks() const -> std::uint64_t { return tick_; }
+
+		[[nodiscard]] auto tracked() const -> std::size_t { return pid_slot_map_.size(); }
+
+		[[nodiscard]] auto untracked() const -> std::size_t { return untracked_; }
+
+		// Adds the use of the TID in the current update. Returns false if the TID is not tracked (no free slot).
+		auto record(const pid_t pid, const float use) -> bool
+		{
+			auto it = pid_slot_map_.find(pid);
+			if (it == pid_slot_map_.end())
+			{
+				if (free_slots_.empty())
+				{
+					++untracked_this_tick_;
+					return false;
+				}
+
+				it = pid_slot_map_.emplace(pid, free_slots_.back()).first;
+				free_slots_.pop_back();
+
+				slot_pid_[it->second]   = pid;
+				slot_first_[it->second] = tick_;
+			}
+
+			const auto slot  = it->second;
+			const auto first = slot_first_[slot] == tick_;
+
+			task_samples_[slot * config_.depth + position()] = use;
+			slot_last_[slot]                                 = tick_;
+			slot_ewma_[slot]                                 = update_ewma(slot_ewma_[slot], use, first);
+
+			return true;
+		}
+
+		// Adds the use of the CPU in the current update
+		void record_cpu(const cpu_t cpu, const float use)
+		{
+			cpu_samples_.at(idx(cpu) * config_.depth + position()) = use;
+			cpu_ewma_.at(idx(cpu))                                 = update_ewma(cpu_ewma_[idx(cpu)], use, tick_ == 0);
+		}
+
+		// Closes the current update: the TIDs that were not recorded in it free their slot
+		void end_tick()
+		{
+			for (slot_t slot = 0; slot < slot_pid_.size(); ++slot)
+			{
+				if (slot_pid_[slot] == NO_PID or slot_last_[slot] == tick_) { continue; }
+
+				pid_slot_map_.erase(slot_pid_[slot]);
+				slot_pid_[slot] = NO_PID;
+				free_slots_.emplace_back(slot);
+			}
+
+			untracked_           = untracked_this_tick_;
+			untracked_this_tick_ = 0;
+
+			++tick_;
+		}
+
+		// Forgets every sample (e.g. after the scope or the topology of the snapshot changed)
+		void clear()
+		{
+			for (slot_t slot = 0; slot < slot_pid_.size(); ++slot)
+			{
+				if (slot_pid_[slot] != NO_PID) { free_slots_.emplace_back(slot); }
+				slot_pid_[slot] = NO_PID;
+			}
+
+			pid_slot_map_.clear();
+			std::ranges::fill(cpu_ewma_, 0.0F);
+
+			tick_                = 0;
+			untracked_           = 0;
+			untracked_this_tick_ = 0;
+		}
+
+		[[nodiscard]] auto tracks(const pid_t pid) const -> bool { return pid_slot_map_.contains(pid); }
+
+		// Samples of the TID (empty if it is not tracked)
+		[[nodiscard]] auto of_task(const pid_t pid) const -> usage_series
+		{
+			const auto it = pid_slot_map_.find(pid);
+			return it == pid_slot_map_.end() ? usage_series{} : task_series(it->second);
+		}
+
+		// Samples of the CPU
+		[[nodiscard]] auto of_cpu(const cpu_t cpu) const -> usage_series
+		{
+			if (tick_ == 0) { return {}; }
+
+			const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(config_.depth, tick_));
+
+			return { std::span{ cpu_samples_ }.subspan(idx(cpu) * config_.depth, config_.depth),
+				     (tick_ - 1) % config_.depth, count, cpu_ewma_.at(idx(cpu)) };
+		}
+	};
+} // namespace syssnap
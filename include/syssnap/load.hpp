@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <span>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	namespace detail
+	{
+		// S-shape function between 0 and 1
+		inline auto sigmoid_weight(const float x) -> float
+		{
+			// If x ~ 0, return 0
+			if (x < std::numeric_limits<decltype(x)>::epsilon()) { return 0.0F; }
+			// If x ~ 1, return 1
+			if (x > 1.0F - std::numeric_limits<decltype(x)>::epsilon()) { return 1.0F; }
+			// Else, compute the function
+			constexpr auto beta = 3.0F;
+			return 1.0F / (1.0F + std::pow((x / (1.0F - x)), -beta));
+		}
+
+		// Vector of 101 values such that v[i] = s_shape(i / 100)
+		inline auto sigmoid_weight_table() -> const std::array<float, 101> &
+		{
+			static const auto weight_table = []() {
+				std::array<float, 101> table{};
+
+				for (size_t i = 0; i < table.size(); i++)
+				{
+					table.at(i) = sigmoid_weight(static_cast<float>(i) / 100.0F);
+				}
+
+				return table;
+			}();
+
+			return weight_table;
+		}
+	} // namespace detail
+
+	// Computes the load of the TIDs of one CPU from their CPU use (in %). Returns the total load of the CPU.
+	// The load of each TID blends its use relative to the free CPU time and relative to the busiest TID, and the
+	// blend factor (alpha) only depends on the CPU, so the per-TID loop is branch-free and can be vectorized.
+	inline auto compute_load_sigmoid(const std::span<const float> cpu_use, const std::span<float> load) -> float
+	{
+		assert(load.size() == cpu_use.size());
+
+		if (cpu_use.empty()) { return 0.0F; }
+
+		auto total_cpu_use = 0.0F;
+		auto max_cpu_use   = cpu_use.front();
+		for (const auto use : cpu_use)
+		{
+			total_cpu_use += use;
+			max_cpu_use = std::max(max_cpu_use, use);
+		}
+
+		const auto free_cpu_use = std::clamp(100.0F - total_cpu_use, 0.0F, 100.0F);
+
+		const auto cpu_index = static_cast<int>(std::round(free_cpu_use));
+
+		const auto alpha = detail::sigmoid_weight_table().at(idx(cpu_index));
+		const auto beta  = 1 - alpha;
+
+		const auto size = cpu_use.size();
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			const auto load_vs_free = std::min(1.0F, cpu_use[i] / free_cpu_use);
+			const auto load_vs_max  = std::min(1.0F, cpu_use[i] / max_cpu_use);
+
+			load[i] = alpha * load_vs_free + beta * load_vs_max;
+		}
+
+		auto total_load = 0.0F;
+		for (const auto pid_load : load)
+		{
+			total_load += pid_load;
+		}
+
+		return total_load;
+	}
+} // namespace syssnap
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	// CPUs of each node ordered by load, to find the least loaded ones without scanning the node.
+	// Cost: O(log CPUs) per change of a load, O(log CPUs + k) for the k least loaded CPUs of a node.
+	class cpu_load_index
+	{
+	private:
+		using entry = std::pair<float, cpu_t>; // Ties go to the lowest CPU
+
+		std::vector<std::set<entry>> nodes_; // input: node, output: its CPUs by load
+		std::vector<float>           load_;  // input: CPU,  output: load in the index
+		std::vector<node_t>          node_;  // input: CPU,  output: node (-1 = not in the index)
+
+	public:
+		// Indexes every CPU of the topology, with the load given by load_of(cpu). Cost: O(CPUs log CPUs)
+		template<typename Topology, typename LoadOf>
+		void reset(const Topology & topo, LoadOf && load_of)
+		{
+			nodes_.assign(idx(topo.max_node()) + 1, {});
+			load_.assign(idx(topo.max_cpu()) + 1, 0.0F);
+			node_.assign(idx(topo.max_cpu()) + 1, -1);
+
+			for (const auto cpu : topo.cpus())
+			{
+				const auto node = topo.node_from_cpu(cpu);
+				const auto load = static_cast<float>(load_of(cpu));
+
+				load_[idx(cpu)] = load;
+				node_[idx(cpu)] = node;
+				nodes_[idx(node)].emplace(load, cpu);
+			}
+		}
+
+		// Moves the CPU to its new place in its node. The set node is reused, so nothing is allocated.
+		void update(const cpu_t cpu, const float load)
+		{
+			if (idx(cpu) >= node_.size() or node_[idx(cpu)] < 0) { return; }
+
+			auto & cpus = nodes_[idx(node_[idx(cpu)])];
+
+			auto handle = cpus.extract({ load_[idx(cpu)], cpu });
+			if (handle.empty()) { return; }
+
+			handle.value().first = load;
+			cpus.insert(std::move(handle));
+
+			load_[idx(cpu)] = load;
+		}
+
+		// Least loaded CPU of the node (-1 if the node has no CPUs)
+		[[nodiscard]] auto least_loaded(const node_t node) const -> cpu_t
+		{
+			if (idx(node) >= nodes_.size() or nodes_[idx(node)].empty()) { return -1; }
+			return nodes_[idx(node)].begin()->second;
+		}
+
+		// The k least loaded CPUs of the node, the least loaded first (fewer if the node has fewer CPUs)
+		[[nodiscard]] auto least_loaded(const node_t node, const std::size_t k) const -> std::vector<cpu_t>
+		{
+			std::vector<cpu_t> cpus;
+			if (idx(node) >= nodes_.size()) { return cpus; }
+
+			for (const auto & [load, cpu] : nodes_[idx(node)])
+			{
+				if (cpus.size() == k) { break; }
+				cpus.push_back(cpu);
+			}
+			return cpus;
+		}
+
+		// Load of the CPU as last indexed
+		[[nodiscard]] auto load_of(const cpu_t cpu) const -> float { return load_.at(idx(cpu)); }
+	};
+} // namespace syssnap
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <sys/resource.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+
+#include "load.hpp"
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Weight of a task of the scheduler for each priority (nice + 20), as in the kernel (sched_prio_to_weight).
+	// Each nice level is ~10% of CPU time, i.e. a factor of ~1.25 between consecutive levels.
+	[[nodiscard]] inline auto priority_to_weight(const std::size_t priority = 20) -> int
+	{
+		static constexpr std::array<int, 40> sched_prio_to_weight = {
+			/* -20 */ 88761, 71755, 56483, 46273, 36291,
+			/* -15 */ 29154, 23254, 18705, 14949, 11916,
+			/* -10 */ 9548,  7620,  6100,  4904,  3906,
+			/*  -5 */ 3121,  2501,  1991,  1586,  1277,
+			/*   0 */ 1024,  820,   655,   526,   423,
+			/*   5 */ 335,   272,   215,   172,   137,
+			/*  10 */ 110,   87,    70,    56,    45,
+			/*  15 */ 36,    29,    23,    18,    15,
+		};
+
+		return sched_prio_to_weight.at(priority);
+	}
+
+	inline constexpr float NICE_0_WEIGHT = 1024.0F;
+
+	[[nodiscard]] inline auto nice_to_weight(const int nice) -> float
+	{
+		return static_cast<float>(priority_to_weight(idx(std::clamp(nice, -20, 19) + 20))); // NOLINT
+	}
+
+	// Nice of the TID (getpriority(2) on a TID reads the nice of the thread), 0 if it cannot be read
+	[[nodiscard]] inline auto read_nice(const pid_t pid) -> int
+	{
+		errno           = 0;
+		const auto nice = getpriority(PRIO_PROCESS, static_cast<id_t>(pid));
+		return errno == 0 ? nice : 0;
+	}
+
+	// What a load model gets for the TIDs of one CPU, all in the same order
+	struct cpu_tasks
+	{
+		std::span<const pid_t> pids;
+		std::span<const float> use;    // CPU use (%)
+		std::span<const float> weight; // Weight of the nice of each TID (NICE_0_WEIGHT = nice 0), weighted models only
+	};
+
+	// How the snapshot turns the use of the TIDs of a CPU into their loads (a template policy of the snapshot, so the
+	// per-TID loop is inlined). compute() writes the load of each TID and returns their sum. It is called for several
+	// CPUs at once from the pool, each call only writing its own loads.
+	// Models with weighted = true also get the weight of each TID, which costs reading its nice on every update.
+	template<typename T>
+	concept load_model =
+	    std::default_initializable<T> and requires(T & model, const cpu_tasks & tasks, const std::span<float> load) {
+		    { model.compute(tasks, load) } -> std::convertible_to<float>;
+	    };
+
+	template<typename T>
+	concept weighted_load_model = load_model<T> and requires { requires T::weighted; };
+
+	// The TIDs compete for the free CPU time and with the busiest TID of the CPU (see compute_load_sigmoid)
+	struct sigmoid_load
+	{
+		static constexpr bool weighted = false;
+
+		[[nodiscard]] static auto compute(const cpu_tasks & tasks, const std::span<float> load) -> float
+		{
+			return compute_load_sigmoid(tasks.use, load);
+		}
+	};
+
+	// The load of a TID is the share of a CPU that it uses (1 = a whole CPU)
+	struct linear_load
+	{
+		static constexpr bool weighted = false;
+
+		[[nodiscard]] static auto compute(const cpu_tasks & tasks, const std::span<float> load) -> float
+		{
+			assert(load.size() == tasks.use.size());
+
+			auto total = 0.0F;
+			for (std::size_t i = 0; i < load.size(); ++i)
+			{
+				load[i] = tasks.use[i] / 100.0F; // NOLINT
+				total += load[i];
+			}
+			return total;
+		}
+	};
+
+	// Same, scaled by the weight of the nice of the TID, as the scheduler does: a nice -10 TID weighs ~9x a nice 0 one,
+	// and a nice 19 one 1/70th of it
+	struct nice_weighted_load
+	{
+		static constexpr bool weighted = true;
+
+		[[nodiscard]] static auto compute(const cpu_tasks & tasks, const std::span<float> load) -> float
+		{
+			assert(load.size() == tasks.use.size() and tasks.weight.size() == tasks.use.size());
+
+			auto total = 0.0F;
+			for (std::size_t i = 0; i < load.size(); ++i)
+			{
+				load[i] = tasks.use[i] / 100.0F * (tasks.weight[i] / NICE_0_WEIGHT); // NOLINT
+				total += load[i];
+			}
+			return total;
+		}
+	};
+
+	// PELT-like: the use of each TID decays geometrically over the updates (half of it after half_life updates), and
+	// the decayed use is weighted by the nice, like the load_avg of the scheduler. A burst does not swing the load,
+	// and an idle TID keeps some load for a while. New TIDs start from their first use.
+	// Keeps the decayed use of every TID: the snapshot calls prepare() on every computation of the loads, before the
+	// CPUs, so that the parallel compute() calls only look up TIDs that are already in the table.
+	class decayed_load
+	{
+	private:
+		struct decayed_use
+		{
+			float         use{ -1.0F }; // Negative until the first use is known
+			std::uint64_t seen{ 0 };    // Last update the TID was in the snapshot
+		};
+
+		float decay_{ 0.0F };
+
+		std::unordered_map<pid_t, decayed_use> uses_;
+
+		std::uint64_t tick_{ 0 };
+		bool          advance_{ false }; // Whether compute() adds the current use (a new update) or only reads
+
+	public:
+		static constexpr bool weighted = true;
+
+		static constexpr float DEFAULT_HALF_LIFE = 8.0F; // Updates
+
+		explicit decayed_load(const float half_life = DEFAULT_HALF_LIFE) { set_half_life(half_life); }
+
+		void set_half_life(const float half_life) { decay_ = std::pow(0.5F, 1.0F / std::max(half_life, 1e-3F)); }
+
+		[[nodiscard]] auto decay() const -> float { return decay_; }
+
+		// Adds the TIDs of the snapshot to the table, and drops the ones that left once it has doubled.
+		// advance: the loads come from a new update, so compute() decays the use of the TIDs with the current one
+		template<typename Pids>
+		void prepare(const Pids & pids, const bool advance)
+		{
+			advance_ = advance;
+			if (not advance) { return; }
+
+			++tick_;
+
+			std::size_t alive = 0;
+			for (const auto pid : pids)
+			{
+				uses_[pid].seen = tick_;
+				++alive;
+			}
+
+			if (uses_.size() > 2 * alive)
+			{
+				std::erase_if(uses_, [&](const auto & pid_use) { return pid_use.second.seen != tick_; });
+			}
+		}
+
+		// Decayed use of the TID (-1 if unknown)
+		[[nodiscard]] auto decayed_use_of(const pid_t pid) const -> float
+		{
+			const auto it = uses_.find(pid);
+			return it == uses_.end() ? -1.0F : it->second.use;
+		}
+
+		[[nodiscard]] auto compute(const cpu_tasks & tasks, const std::span<float> load) -> float
+		{
+			assert(load.size() == tasks.use.size() and tasks.weight.size() == tasks.use.size());
+
+			auto total = 0.0F;
+			for (std::size_t i = 0; i < load.size(); ++i)
+			{
+				auto use = tasks.use[i];
+
+				if (const auto it = uses_.find(tasks.pids[i]); it != uses_.end())
+				{
+					auto & decayed = it->second.use;
+					if (advance_) { decayed = decayed < 0.0F ? use : decay_ * decayed + (1.0F - decay_) * use; }
+					if (decayed >= 0.0F) { use = decayed; }
+				}
+
+				load[i] = use / 100.0F * (tasks.weight[i] / NICE_0_WEIGHT); // NOLINT
+				total += load[i];
+			}
+			return total;
+		}
+	};
+} // namespace syssnap
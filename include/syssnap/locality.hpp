@@ -0,0 +1,216 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "memory.hpp"
+#include "types.hpp"
+
+namespace syssnap
+{
+	namespace detail
+	{
+		// Value of the "key=value" field of a line (false if missing or not a number)
+		template<typename T>
+		auto field_value(const std::string_view line, const std::string_view key, T & value) -> bool
+		{
+			auto pos = line.find(key);
+			while (pos != std::string_view::npos and
+			       (pos + key.size() >= line.size() or line[pos + key.size()] != '='))
+			{
+				pos = line.find(key, pos + 1);
+			}
+			if (pos == std::string_view::npos) { return false; }
+
+			const auto begin = line.data() + pos + key.size() + 1; // Skip the '='
+			return std::from_chars(begin, line.data() + line.size(), value).ec == std::errc{};
+		}
+
+		// Value of a "key : value" line of /proc/<pid>/sched (false if the line is another one)
+		template<typename T>
+		auto sched_value(const std::string_view line, const std::string_view key, T & value) -> bool
+		{
+			if (not line.starts_with(key)) { return false; }
+
+			const auto colon = line.find(':', key.size());
+			if (colon == std::string_view::npos) { return false; }
+
+			const auto first = line.find_first_not_of(' ', colon + 1);
+			if (first == std::string_view::npos) { return false; }
+
+			return std::from_chars(line.data() + first, line.data() + line.size(), value).ec == std::errc{};
+		}
+	} // namespace detail
+
+	// NUMA hinting faults of a TID, i.e. where its memory accesses go (/proc/<pid>/sched, with NUMA balancing)
+	struct numa_faults
+	{
+		std::vector<std::uint64_t> per_node; // input: node, output: faults on memory of the node (private + shared)
+
+		node_t        preferred_node{ -1 }; // Node the balancer wants the TID on (-1 = none yet)
+		std::uint64_t pages_migrated{ 0 };  // Pages the balancer moved for the TID
+
+		[[nodiscard]] static auto parse(std::istream & sched) -> numa_faults
+		{
+			numa_faults faults;
+
+			for (std::string line; std::getline(sched, line);)
+			{
+				if (detail::sched_value(line, "numa_preferred_nid", faults.preferred_node)) { continue; }
+				if (detail::sched_value(line, "numa_pages_migrated", faults.pages_migrated)) { continue; }
+				if (not line.starts_with("numa_faults ")) { continue; }
+
+				node_t        node         = 0;
+				std::uint64_t task_private = 0;
+				std::uint64_t task_shared  = 0;
+				if (not detail::field_value(line, "node", node) or node < 0 or
+				    not detail::field_value(line, "task_private", task_private) or
+				    not detail::field_value(line, "task_shared", task_shared))
+				{
+					continue;
+				}
+
+				if (idx(node) >= faults.per_node.size()) { faults.per_node.resize(idx(node) + 1, 0); }
+				faults.per_node[idx(node)] += task_private + task_shared;
+			}
+
+			return faults;
+		}
+
+		// Faults of the TID (empty if it exited, or the kernel does not balance NUMA)
+		[[nodiscard]] static auto read(const pid_t pid) -> numa_faults
+		{
+			std::ifstream sched(fmt::format("/proc/{}/sched", pid));
+			return parse(sched);
+		}
+
+		[[nodiscard]] auto on(const node_t node) const -> std::uint64_t
+		{
+			return idx(node) < per_node.size() ? per_node[idx(node)] : 0;
+		}
+
+		[[nodiscard]] auto total() const -> std::uint64_t
+		{
+			std::uint64_t total = 0;
+			for (const auto faults : per_node)
+			{
+				total += faults;
+			}
+			return total;
+		}
+
+		[[nodiscard]] auto empty() const -> bool { return total() == 0; }
+	};
+
+	// Where the memory accesses of a TID go: its NUMA faults, and the memory of its process on each node
+	struct task_locality
+	{
+		numa_faults    faults;
+		numa_footprint memory;
+
+		// Fraction of the accesses that would be local on the node: from the faults if the kernel counts them,
+		// from the resident memory otherwise (1 if neither is known, i.e. nothing says the node is worse)
+		[[nodiscard]] auto on(const node_t node) const -> float
+		{
+			if (const auto total = faults.total(); total > 0)
+			{
+				return static_cast<float>(faults.on(node)) / static_cast<float>(total);
+			}
+			if (const auto total = memory.total(); total > 0)
+			{
+				return static_cast<float>(memory.bytes_on(node)) / static_cast<float>(total);
+			}
+			return 1.0F;
+		}
+	};
+
+	// NUMA allocation and balancing counters of the system (/proc/vmstat) or of a node (its numastat in sysfs).
+	// The counters only grow: the difference between two reads gives the activity in between.
+	struct numa_counters
+	{
+		std::uint64_t hit{ 0 };        // Pages allocated on the node they were meant for
+		std::uint64_t miss{ 0 };       // Pages allocated here although meant for another node
+		std::uint64_t foreign{ 0 };    // Pages meant for here but allocated on another node
+		std::uint64_t interleave{ 0 }; // Interleaved pages allocated on the intended node
+		std::uint64_t local{ 0 };      // Pages allocated on the node of the allocating CPU
+		std::uint64_t other{ 0 };      // Pages allocated here by a CPU of another node
+
+		// NUMA balancing (system only)
+		std::uint64_t hint_faults{ 0 };       // Hinting faults taken
+		std::uint64_t hint_faults_local{ 0 }; // Of which on memory local to the faulting CPU
+		std::uint64_t pages_migrated{ 0 };    // Pages moved by the balancer
+
+		// Reads "<key> <value>" lines, with the names of both /proc/vmstat and numastat
+		[[nodiscard]] static auto parse(std::istream & stats) -> numa_counters
+		{
+			numa_counters counters;
+
+			for (std::string key; stats >> key;)
+			{
+				std::uint64_t value = 0;
+				if (not(stats >> value)) { break; }
+
+				if (key == "numa_hit") { counters.hit = value; }
+				else if (key == "numa_miss") { counters.miss = value; }
+				else if (key == "numa_foreign") { counters.foreign = value; }
+				else if (key == "numa_interleave" or key == "interleave_hit") { counters.interleave = value; }
+				else if (key == "numa_local" or key == "local_node") { counters.local = value; }
+				else if (key == "numa_other" or key == "other_node") { counters.other = value; }
+				else if (key == "numa_hint_faults") { counters.hint_faults = value; }
+				else if (key == "numa_hint_faults_local") { counters.hint_faults_local = value; }
+				else if (key == "numa_pages_migrated") { counters.pages_migrated = value; }
+			}
+
+			return counters;
+		}
+
+		[[nodiscard]] static auto read_system() -> numa_counters
+		{
+			std::ifstream vmstat("/proc/vmstat");
+			return parse(vmstat);
+		}
+
+		[[nodiscard]] static auto read_node(const node_t node) -> numa_counters
+		{
+			std::ifstream numastat(fmt::format("/sys/devices/system/node/node{}/numastat", node));
+			return parse(numastat);
+		}
+
+		// Fraction of the hinting faults on local memory (1 if there were none)
+		[[nodiscard]] auto fault_locality() const -> float
+		{
+			return hint_faults == 0 ? 1.0F : static_cast<float>(hint_faults_local) / static_cast<float>(hint_faults);
+		}
+
+		// Activity between two reads
+		[[nodiscard]] auto operator-(const numa_counters & before) const -> numa_counters
+		{
+			numa_counters delta;
+			delta.hit               = hit - before.hit;
+			delta.miss              = miss - before.miss;
+			delta.foreign           = foreign - before.foreign;
+			delta.interleave        = interleave - before.interleave;
+			delta.local             = local - before.local;
+			delta.other             = other - before.other;
+			delta.hint_faults       = hint_faults - before.hint_faults;
+			delta.hint_faults_local = hint_faults_local - before.hint_faults_local;
+			delta.pages_migrated    = pages_migrated - before.pages_migrated;
+			return delta;
+		}
+	};
+
+	struct locality_config
+	{
+		float min_use{ 10.0F }; // Use (%) from which the locality of a TID is collected
+		bool  memory{ true };   // Also read where the memory of their processes lives (numa_maps, the costliest read)
+	};
+} // namespace syssnap
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	using slot_t = std::uint32_t;
+
+	// Dense lists of TIDs, one per bucket (CPU or node).
+	// Iterating a bucket is a linear scan over contiguous memory. The caller keeps the slot returned by insert() next
+	// to each TID, so erasing is an O(1) swap-remove: the last TID of the bucket is moved into the freed slot.
+	class membership
+	{
+	private:
+		std::vector<std::vector<pid_t>> members_; // input: bucket, output: list of TIDs
+
+	public:
+		membership() = default;
+
+		explicit membership(const std::size_t buckets) : members_(buckets) {}
+
+		void resize(const std::size_t buckets) { members_.resize(buckets); }
+
+		void clear()
+		{
+			for (auto & bucket : members_)
+			{
+				bucket.clear();
+			}
+		}
+
+		[[nodiscard]] auto buckets() const -> std::size_t { return members_.size(); }
+
+		[[nodiscard]] auto size(const std::size_t bucket) const -> std::size_t { return members_.at(bucket).size(); }
+
+		// Returns the slot where the TID was stored
+		auto insert(const std::size_t bucket, const pid_t pid) -> slot_t
+		{
+			auto & pids = members_.at(bucket);
+			pids.emplace_back(pid);
+			return static_cast<slot_t>(pids.size() - 1);
+		}
+
+		// Returns the TID that was moved into the freed slot (if any), so the caller can update its slot
+		auto erase(const std::size_t bucket, const slot_t slot) -> std::optional<pid_t>
+		{
+			auto & pids = members_.at(bucket);
+
+			const auto last = pids.back();
+			pids.at(slot)   = last;
+			pids.pop_back();
+
+			if (std::cmp_equal(slot, pids.size())) { return std::nullopt; }
+			return last;
+		}
+
+		[[nodiscard]] auto operator[](const std::size_t bucket) const -> std::span<const pid_t>
+		{
+			return members_.at(bucket);
+		}
+	};
+} // namespace syssnap
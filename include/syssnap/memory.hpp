@@ -0,0 +1,304 @@
+#pragma once
+
+#include <numa.h>
+#include <numaif.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Resident memory of a process on each node
+	class numa_footprint
+	{
+	private:
+		std::vector<std::uint64_t> bytes_; // input: node, output: bytes
+
+		template<typename T>
+		static auto parse_number(const std::string_view text, T & value) -> bool
+		{
+			return std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc{};
+		}
+
+	public:
+		numa_footprint() = default;
+
+		explicit numa_footprint(std::vector<std::uint64_t> bytes) : bytes_(std::move(bytes)) {}
+
+		// Parses the contents of /proc/<pid>/numa_maps: each mapping lists its pages on each node ("N<node>=<pages>")
+		// and the size of its pages ("kernelpagesize_kB=<size>")
+		[[nodiscard]] static auto parse(std::istream & numa_maps) -> numa_footprint
+		{
+			numa_footprint footprint;
+
+			std::vector<std::pair<node_t, std::uint64_t>> pages; // Pages of the mapping on each node
+
+			for (std::string line; std::getline(numa_maps, line);)
+			{
+				pages.clear();
+				std::uint64_t page_kb = 4; // NOLINT: the base page size, if the kernel does not say
+
+				std::string_view rest(line);
+				while (not rest.empty())
+				{
+					const auto end   = rest.find(' ');
+					const auto field = rest.substr(0, end);
+					rest             = end == std::string_view::npos ? std::string_view{} : rest.substr(end + 1);
+
+					const auto eq = field.find('=');
+					if (eq == std::string_view::npos) { continue; }
+
+					const auto key   = field.substr(0, eq);
+					const auto value = field.substr(eq + 1);
+
+					if (key == "kernelpagesize_kB") { parse_number(value, page_kb); }
+					else if (key.size() > 1 and key.front() == 'N')
+					{
+						node_t        node  = 0;
+						std::uint64_t count = 0;
+						if (parse_number(key.substr(1), node) and parse_number(value, count) and node >= 0)
+						{
+							pages.emplace_back(node, count);
+						}
+					}
+				}
+
+				for (const auto & [node, count] : pages)
+				{
+					footprint.add(node, count * page_kb * 1024);
+				}
+			}
+
+			return footprint;
+		}
+
+		// Footprint of the process of the TID (empty if it exited or cannot be read)
+		[[nodiscard]] static auto read(const pid_t pid) -> numa_footprint
+		{
+			std::ifstream numa_maps(fmt::format("/proc/{}/numa_maps", pid));
+			return parse(numa_maps);
+		}
+
+		void add(const node_t node, const std::uint64_t bytes)
+		{
+			if (idx(node) >= bytes_.size()) { bytes_.resize(idx(node) + 1, 0); }
+			bytes_[idx(node)] += bytes;
+		}
+
+		[[nodiscard]] auto bytes_on(const node_t node) const -> std::uint64_t
+		{
+			return idx(node) < bytes_.size() ? bytes_[idx(node)] : 0;
+		}
+
+		// Bytes that are not on the node (i.e. that a migration to it would move)
+		[[nodiscard]] auto bytes_off(const node_t node) const -> std::uint64_t { return total() - bytes_on(node); }
+
+		[[nodiscard]] auto total() const -> std::uint64_t
+		{
+			std::uint64_t total = 0;
+			for (const auto bytes : bytes_)
+			{
+				total += bytes;
+			}
+			return total;
+		}
+
+		[[nodiscard]] auto empty() const -> bool { return total() == 0; }
+
+		// Highest node with memory + 1
+		[[nodiscard]] auto size() const -> std::size_t { return bytes_.size(); }
+	};
+
+	// How much memory commit() moves along with the threads migrated to another node. The pages move in batches
+	// (move_pages(2)) until the byte budget of the commit is spent: a larger process carries on in the next commits,
+	// so the page migrations do not saturate the interconnect. The pages visited are bounded as well, so a process
+	// with few pages to move in large mappings does not stall the commit either.
+	struct memory_migration_config
+	{
+		std::uint64_t max_bytes_per_commit{ 256ULL << 20U }; // NOLINT: 256 MiB
+		std::size_t   max_processes_per_commit{ 16 };         // NOLINT
+		std::size_t   pages_per_call{ 1024 };                 // NOLINT: pages queried and moved per move_pages(2) call
+		std::uint64_t max_pages_per_commit{ 1ULL << 18U };    // NOLINT: pages visited, moved or not (1 GiB of 4 KiB)
+	};
+
+	// Outcome of a step of the migration of the memory of a process
+	struct memory_step
+	{
+		std::uint64_t bytes{ 0 };   // Bytes moved by the step
+		int           error{ 0 };   // errno (0 if the pages could be moved, even if some of them stayed)
+		bool          done{ true }; // Nothing is left for the next steps
+		std::uint64_t pages{ 0 };   // Pages visited by the step (moved or not)
+	};
+
+	namespace detail
+	{
+		using address_range = std::pair<std::uintptr_t, std::uintptr_t>; // [start, end)
+
+		// Start addresses of the mappings of /proc/<pid>/numa_maps with resident pages off the node (none if the
+		// process exited). Mappings that were reserved but never touched have no resident pages, so they never show.
+		[[nodiscard]] inline auto mappings_off_node(const pid_t pid, const node_t node)
+		    -> std::optional<std::unordered_set<std::uintptr_t>>
+		{
+			std::ifstream numa_maps(fmt::format("/proc/{}/numa_maps", pid));
+			if (not numa_maps) { return std::nullopt; }
+
+			std::unordered_set<std::uintptr_t> starts;
+			for (std::string line; std::getline(numa_maps, line);)
+			{
+				std::uintptr_t start  = 0;
+				const auto     result = std::from_chars(line.data(), line.data() + line.size(), start, 16); // NOLINT
+				if (result.ec != std::errc{}) { continue; }
+
+				std::istringstream mapping(line);
+				if (numa_footprint::parse(mapping).bytes_off(node) > 0) { starts.insert(start); }
+			}
+			return starts;
+		}
+
+		// Mappings of the process of the TID that end after the address and have resident pages off the node, from
+		// /proc/<pid>/maps and /proc/<pid>/numa_maps (none if it exited)
+		[[nodiscard]] inline auto mappings_to_move(const pid_t pid, const node_t node, const std::uintptr_t address)
+		    -> std::optional<std::vector<address_range>>
+		{
+			const auto off_node = mappings_off_node(pid, node);
+			if (not off_node) { return std::nullopt; }
+
+			std::ifstream maps(fmt::format("/proc/{}/maps", pid));
+			if (not maps) { return std::nullopt; }
+
+			std::vector<address_range> mappings;
+			for (std::string line; std::getline(maps, line);)
+			{
+				const auto * last = line.data() + line.size(); // NOLINT
+
+				std::uintptr_t start = 0;
+				std::uintptr_t end   = 0;
+
+				const auto dash = std::from_chars(line.data(), last, start, 16); // NOLINT
+				if (dash.ec != std::errc{} or dash.ptr == last or *dash.ptr != '-') { continue; }
+
+				const auto range = std::from_chars(dash.ptr + 1, last, end, 16); // NOLINT
+				if (range.ec != std::errc{}) { continue; }
+
+				if (end > address and off_node->contains(start)) { mappings.emplace_back(start, end); }
+			}
+			return mappings;
+		}
+	} // namespace detail
+
+	// Moves the pages of the process of the TID that are not on the node (move_pages(2), via libnuma), pages_per_call
+	// at a time, from the address resume on, until max_bytes have moved (at least one page per call) or max_pages
+	// were visited. Only the mappings with resident pages off the node are visited (see detail::mappings_to_move).
+	// resume is left on the first page not visited, so the next call carries on from there, and back at 0 once every
+	// mapping was visited. Pages that are not resident, or shared with other processes, stay where they are.
+	[[nodiscard]] inline auto move_pages_to_node(const pid_t pid, const node_t node, std::uintptr_t & resume,
+	                                             const std::uint64_t max_bytes, const std::uint64_t max_pages,
+	                                             const std::size_t pages_per_call) -> memory_step
+	{
+		if (numa_available() < 0) { return { 0, ENOSYS, true }; }
+
+		const auto mappings = detail::mappings_to_move(pid, node, resume);
+		if (not mappings) { return { 0, ESRCH, true }; }
+
+		const auto page  = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+		const auto batch = std::max<std::size_t>(1, pages_per_call);
+		const auto from  = resume;
+
+		std::vector<void *> pages;  // Pages of the batch
+		std::vector<void *> moving; // Those that are off the node, and fit in the budget
+		std::vector<int>    status(batch);
+		const std::vector   nodes(batch, static_cast<int>(node));
+
+		pages.reserve(batch);
+
+		memory_step step{ 0, 0, false, 0 };
+		bool        cut = false; // The budget ran out in the middle of a batch
+
+		// Moves the pages of the batch that are off the node. False once the budget is spent (or on error).
+		const auto flush = [&]() -> bool {
+			if (pages.empty()) { return true; }
+
+			// Without nodes, move_pages(2) only reports where each page is
+			if (numa_move_pages(pid, pages.size(), pages.data(), nullptr, status.data(), 0) != 0)
+			{
+				step.error = errno;
+				return false;
+			}
+
+			moving.clear();
+			for (std::size_t i = 0; i < pages.size(); ++i)
+			{
+				if (status[i] >= 0 and status[i] != node) { moving.push_back(pages[i]); }
+			}
+
+			const auto room = step.bytes < max_bytes ? (max_bytes - step.bytes) / page : 0;
+			const auto fits = static_cast<std::size_t>(std::max<std::uint64_t>(room, step.bytes == 0 ? 1 : 0));
+
+			resume = reinterpret_cast<std::uintptr_t>(pages.back()) + page; // NOLINT
+			if (moving.size() > fits)
+			{
+				resume = reinterpret_cast<std::uintptr_t>(moving[fits]); // NOLINT
+				moving.resize(fits);
+				cut = true;
+			}
+			pages.clear();
+
+			if (not moving.empty())
+			{
+				if (numa_move_pages(pid, moving.size(), moving.data(), nodes.data(), status.data(), MPOL_MF_MOVE) != 0)
+				{
+					step.error = errno;
+					return false;
+				}
+
+				for (std::size_t i = 0; i < moving.size(); ++i)
+				{
+					if (status[i] == node) { step.bytes += page; }
+				}
+			}
+
+			return not cut and step.bytes < max_bytes;
+		};
+
+		for (const auto & [start, end] : *mappings)
+		{
+			for (auto address = std::max(start, from); address < end; address += page)
+			{
+				// Visited pages are bounded too, as a sparse mapping may take many pages to fill the budget
+				if (step.pages == max_pages)
+				{
+					if (flush()) { resume = address; }
+					return step;
+				}
+
+				pages.push_back(reinterpret_cast<void *>(address)); // NOLINT
+				++step.pages;
+
+				if (pages.size() == batch and not flush()) { return step; }
+			}
+		}
+
+		if (not flush() and (cut or step.error != 0)) { return step; }
+
+		step.done = true;
+		resume    = 0;
+		return step;
+	}
+} // namespace syssnap
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	struct planner_config
+	{
+		std::size_t max_migrations{ 64 };      // Migrations per plan (the budget)
+		float       distance_penalty{ 0.25F }; // Load added to a destination per local distance to it (see planner)
+		float       min_gain{ 0.01F };         // Smallest reduction of the load of the busiest CPU worth a migration
+	};
+
+	struct planned_migration
+	{
+		pid_t pid{};
+		cpu_t from{};
+		cpu_t to{};
+		float load{}; // Load of the TID, moved along with it
+	};
+
+	struct migration_plan
+	{
+		std::vector<planned_migration> migrations;
+
+		// Load of the busiest CPU minus the mean load of the CPUs, before and after the plan
+		float imbalance_before{ 0.0F };
+		float imbalance_after{ 0.0F };
+
+		[[nodiscard]] auto size() const -> std::size_t { return migrations.size(); }
+
+		[[nodiscard]] auto empty() const -> bool { return migrations.empty(); }
+	};
+
+	// Plans the migrations that flatten the load of the CPUs, the busiest CPU first.
+	// Each step takes the busiest CPU (max-heap of CPU loads) and the least loaded CPU of each node (one min-heap per
+	// node), the latter penalized by its NUMA distance: a node at twice the local distance costs distance_penalty more
+	// load. Then it moves the TID whose load is the closest to half the difference, so the busiest CPU gets lighter
+	// without the destination becoming the new busiest one. Each TID moves at most once per plan.
+	// Cost: O(tasks log tasks) to sort the TIDs of each CPU, plus O(nodes + log CPUs + TIDs of the source CPU) per
+	// migration (the moved TID is erased from the sorted TIDs of its CPU, a memmove of the ones after it).
+	class planner
+	{
+	private:
+		struct cpu_entry
+		{
+			float         load{};
+			cpu_t         cpu{};
+			std::uint32_t version{}; // Entries older than the last change of the CPU are skipped
+		};
+
+		struct lighter
+		{
+			auto operator()(const cpu_entry & a, const cpu_entry & b) const -> bool { return a.load < b.load; }
+		};
+
+		struct heavier
+		{
+			auto operator()(const cpu_entry & a, const cpu_entry & b) const -> bool { return a.load > b.load; }
+		};
+
+		using max_heap = std::priority_queue<cpu_entry, std::vector<cpu_entry>, lighter>;
+		using min_heap = std::priority_queue<cpu_entry, std::vector<cpu_entry>, heavier>;
+
+		planner_config config_;
+
+		template<typename Range>
+		[[nodiscard]] static auto imbalance(const std::vector<float> & load, const Range & cpus) -> float
+		{
+			auto total = 0.0F;
+			auto max   = 0.0F;
+			for (const auto cpu : cpus)
+			{
+				total += load[idx(cpu)];
+				max = std::max(max, load[idx(cpu)]);
+			}
+			return std::ranges::empty(cpus) ? 0.0F : max - total / static_cast<float>(std::ranges::size(cpus));
+		}
+
+		// TID of the CPU (sorted by load) whose load is the closest to half the gap, and below the gap
+		[[nodiscard]] static auto pick(const std::vector<std::pair<float, pid_t>> & tasks, const float gap)
+		    -> std::ptrdiff_t
+		{
+			const auto target = gap / 2.0F;
+			const auto it     = std::ranges::lower_bound(tasks, target, {}, &std::pair<float, pid_t>::first);
+
+			std::ptrdiff_t best = -1;
+			auto           dist = std::numeric_limits<float>::infinity();
+
+			for (const auto candidate : { it, it == tasks.begin() ? it : std::prev(it) })
+			{
+				if (candidate == tasks.end()) { continue; }
+
+				const auto load = candidate->first;
+				if (load <= 0.0F or load >= gap) { continue; }
+
+				if (std::abs(load - target) < dist)
+				{
+					dist = std::abs(load - target);
+					best = std::distance(tasks.begin(), candidate);
+				}
+			}
+
+			return best;
+		}
+
+	public:
+		explicit planner(const planner_config config = {}) : config_(config) {}
+
+		[[nodiscard]] auto config() const -> const planner_config & { return config_; }
+
+		// Plans the migrations from the current (dirty) state of the snapshot, without changing it
+		template<typename Snapshot>
+		[[nodiscard]] auto plan(const Snapshot & snapshot) const -> migration_plan
+		{
+			const auto & topo = snapshot.system_topology();
+
+			const auto size_cpus  = idx(topo.max_cpu()) + 1;
+			const auto size_nodes = idx(topo.max_node()) + 1;
+
+			std::vector<float>                                load(size_cpus, 0.0F); // input: CPU, output: load
+			std::vector<std::uint32_t>                        version(size_cpus, 0); // input: CPU, output: changes
+			std::vector<std::vector<std::pair<float, pid_t>>> tasks(size_cpus);      // input: CPU, output: TIDs by load
+
+			max_heap              busiest;              // CPUs by load
+			std::vector<min_heap> lightest(size_nodes); // input: node, output: its CPUs by load
+
+			for (const auto cpu : topo.cpus())
+			{
+				load[idx(cpu)] = snapshot.load_of_cpu(cpu);
+
+				auto & cpu_tasks = tasks[idx(cpu)];
+				for (const auto pid : snapshot.pids_in_cpu(cpu))
+				{
+					cpu_tasks.emplace_back(snapshot.load_of(pid), pid);
+				}
+				std::ranges::sort(cpu_tasks);
+
+				busiest.push({ load[idx(cpu)], cpu, 0 });
+				lightest[idx(topo.node_from_cpu(cpu))].push({ load[idx(cpu)], cpu, 0 });
+			}
+
+			const auto current = [&](const cpu_entry & entry) { return entry.version == version[idx(entry.cpu)]; };
+
+			migration_plan plan;
+			plan.imbalance_before = imbalance(load, topo.cpus());
+
+			while (plan.size() < config_.max_migrations and not busiest.empty())
+			{
+				const auto from = busiest.top();
+				busiest.pop();
+				if (not current(from)) { continue; }
+
+				const auto from_node = topo.node_from_cpu(from.cpu);
+				const auto local     = static_cast<float>(topo.node_distance(from_node, from_node));
+
+				// Least loaded CPU of each node, penalized by its distance
+				auto to   = cpu_t{ -1 };
+				auto cost = std::numeric_limits<float>::infinity();
+				for (const auto node : topo.nodes())
+				{
+					auto & heap = lightest[idx(node)];
+					while (not heap.empty() and not current(heap.top()))
+					{
+						heap.pop();
+					}
+					if (heap.empty() or heap.top().cpu == from.cpu) { continue; }
+
+					const auto distance = static_cast<float>(topo.node_distance(from_node, node));
+					const auto penalty  = config_.distance_penalty * (distance - local) / local;
+
+					if (heap.top().load + penalty < cost)
+					{
+						cost = heap.top().load + penalty;
+						to   = heap.top().cpu;
+					}
+				}
+
+				// Nothing to gain from this CPU: it drops out of the heap until the end of the plan
+				const auto gap = from.load - cost;
+				if (to < 0 or gap <= config_.min_gain) { continue; }
+
+				auto &     from_tasks = tasks[idx(from.cpu)];
+				const auto chosen     = pick(from_tasks, gap);
+				if (chosen < 0) { continue; }
+
+				// Linear in the TIDs of the CPU, but a plain memmove of a few hundred pairs at most
+				const auto [pid_load, pid] = from_tasks[static_cast<std::size_t>(chosen)];
+				from_tasks.erase(from_tasks.begin() + chosen);
+
+				plan.migrations.push_back({ pid, from.cpu, to, pid_load });
+
+				load[idx(from.cpu)] -= pid_load;
+				load[idx(to)] += pid_load;
+
+				for (const auto cpu : { from.cpu, to })
+				{
+					const auto v = ++version[idx(cpu)];
+					busiest.push({ load[idx(cpu)], cpu, v });
+					lightest[idx(topo.node_from_cpu(cpu))].push({ load[idx(cpu)], cpu, v });
+				}
+			}
+
+			plan.imbalance_after = imbalance(load, topo.cpus());
+
+			return plan;
+		}
+
+		// Adds the migrations of the plan to the dirty state of the snapshot (commit() applies them)
+		template<typename Snapshot>
+		static void apply(Snapshot & snapshot, const migration_plan & plan)
+		{
+			for (const auto & migration : plan.migrations)
+			{
+				snapshot.migrate_to_cpu(migration.pid, migration.to);
+			}
+		}
+
+		// Plans and applies the migrations
+		template<typename Snapshot>
+		auto rebalance(Snapshot & snapshot) const -> migration_plan
+		{
+			auto migrations = plan(snapshot);
+			apply(snapshot, migrations);
+			return migrations;
+		}
+	};
+} // namespace syssnap
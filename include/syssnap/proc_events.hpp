@@ -0,0 +1,221 @@
+#pragma once
+
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace syssnap
+{
+	struct task_event
+	{
+		enum class kind
+		{
+			fork, // A new TID (process or thread)
+			exec, // The TID replaced its program, so its command, user or cgroup may have changed
+			exit  // The TID exited
+		};
+
+		kind  what{ kind::fork };
+		pid_t pid{};
+		pid_t parent{ 0 };  // Parent process of the new TID (forks only): for a thread, the parent of its process
+		pid_t process{ 0 }; // Thread group of the new TID (forks only): the TID itself for a process
+	};
+
+	// Forks, execs and exits since the last update, in the order the kernel reported them
+	struct task_events
+	{
+		std::vector<task_event> events;
+
+		// Some events were dropped (e.g. the socket buffer overflowed): only a full rescan is exact
+		bool lost{ false };
+
+		void clear()
+		{
+			events.clear();
+			lost = false;
+		}
+
+		[[nodiscard]] auto empty() const -> bool { return events.empty() and not lost; }
+
+		[[nodiscard]] auto size() const -> std::size_t { return events.size(); }
+	};
+
+	namespace detail
+	{
+		// NLMSG_DATA and NLMSG_NEXT with explicit casts: the macros cast C-style and mix signed and unsigned lengths
+
+		[[nodiscard]] inline auto netlink_data(nlmsghdr * header) -> void *
+		{
+			return reinterpret_cast<std::byte *>(header) + NLMSG_HDRLEN; // NOLINT
+		}
+
+		[[nodiscard]] inline auto netlink_data(const nlmsghdr * header) -> const void *
+		{
+			return reinterpret_cast<const std::byte *>(header) + NLMSG_HDRLEN; // NOLINT
+		}
+
+		// Message after the header, taking its (aligned) length off the bytes remaining in the buffer
+		[[nodiscard]] inline auto netlink_next(const nlmsghdr * header, int & remaining) -> const nlmsghdr *
+		{
+			const auto length = NLMSG_ALIGN(header->nlmsg_len);
+			remaining -= static_cast<int>(length);
+			return reinterpret_cast<const nlmsghdr *>(reinterpret_cast<const std::byte *>(header) + length); // NOLINT
+		}
+	} // namespace detail
+
+	// Subscription to the fork, exec and exit notifications of the kernel (netlink proc connector).
+	// Needs CAP_NET_ADMIN: without it (or without the connector) the subscription is not available, and the
+	// snapshot keeps discovering the tasks with full scans.
+	class proc_events
+	{
+	private:
+		static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+		int fd_{ -1 };
+		int error_{ 0 }; // errno of the subscription (0 if available)
+
+		// Sends a connector message to the proc connector with the operation (listen or ignore)
+		auto send_operation(const proc_cn_mcast_op operation) const -> bool
+		{
+			alignas(nlmsghdr) std::array<std::byte, NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))> buffer{};
+
+			auto * header       = reinterpret_cast<nlmsghdr *>(buffer.data()); // NOLINT
+			header->nlmsg_len   = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+			header->nlmsg_type  = NLMSG_DONE;
+			header->nlmsg_pid   = static_cast<__u32>(getpid());
+			header->nlmsg_flags = 0;
+			header->nlmsg_seq   = 0;
+
+			auto * message  = static_cast<cn_msg *>(detail::netlink_data(header));
+			message->id.idx = CN_IDX_PROC;
+			message->id.val = CN_VAL_PROC;
+			message->len    = sizeof(proc_cn_mcast_op);
+			std::memcpy(message->data, &operation, sizeof(operation));
+
+			return send(fd_, buffer.data(), header->nlmsg_len, 0) >= 0;
+		}
+
+		void close_socket()
+		{
+			if (fd_ >= 0) { close(fd_); }
+			fd_ = -1;
+		}
+
+	public:
+		proc_events()
+		{
+			fd_ = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+			if (fd_ < 0)
+			{
+				error_ = errno;
+				return;
+			}
+
+			sockaddr_nl address{};
+			address.nl_family = AF_NETLINK;
+			address.nl_groups = CN_IDX_PROC;
+			address.nl_pid    = 0; // Assigned by the kernel
+
+			if (bind(fd_, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0 or // NOLINT
+			    not send_operation(PROC_CN_MCAST_LISTEN))
+			{
+				error_ = errno;
+				close_socket();
+			}
+		}
+
+		proc_events(const proc_events &)                     = delete;
+		auto operator=(const proc_events &) -> proc_events & = delete;
+
+		proc_events(proc_events && other) noexcept :
+		    fd_(std::exchange(other.fd_, -1)), error_(std::exchange(other.error_, 0))
+		{}
+
+		auto operator=(proc_events && other) noexcept -> proc_events &
+		{
+			if (this != &other)
+			{
+				close_socket();
+				fd_    = std::exchange(other.fd_, -1);
+				error_ = std::exchange(other.error_, 0);
+			}
+			return *this;
+		}
+
+		~proc_events()
+		{
+			if (fd_ >= 0) { static_cast<void>(send_operation(PROC_CN_MCAST_IGNORE)); }
+			close_socket();
+		}
+
+		[[nodiscard]] auto available() const -> bool { return fd_ >= 0; }
+
+		// errno of the subscription (e.g. EPERM without CAP_NET_ADMIN), 0 if available
+		[[nodiscard]] auto error() const -> int { return error_; }
+
+		// Appends the events received since the last call, without blocking. Cost: O(events)
+		void poll(task_events & events)
+		{
+			if (fd_ < 0)
+			{
+				events.lost = true;
+				return;
+			}
+
+			alignas(nlmsghdr) std::array<std::byte, BUFFER_SIZE> buffer; // NOLINT: filled by recv
+
+			while (true)
+			{
+				const auto received = recv(fd_, buffer.data(), buffer.size(), 0);
+				if (received < 0)
+				{
+					if (errno == EINTR) { continue; }
+					if (errno == EAGAIN or errno == EWOULDBLOCK) { break; }
+
+					// ENOBUFS: the kernel dropped events, the rest are still worth reading
+					events.lost = true;
+					if (errno == ENOBUFS) { continue; }
+					break;
+				}
+
+				auto         remaining = static_cast<int>(received);
+				const auto * header    = reinterpret_cast<const nlmsghdr *>(buffer.data()); // NOLINT
+
+				for (; NLMSG_OK(header, remaining); header = detail::netlink_next(header, remaining))
+				{
+					if (header->nlmsg_type == NLMSG_ERROR or header->nlmsg_type == NLMSG_NOOP) { continue; }
+
+					const auto * message = static_cast<const cn_msg *>(detail::netlink_data(header));
+					if (message->id.idx != CN_IDX_PROC or message->id.val != CN_VAL_PROC) { continue; }
+
+					const auto * event = reinterpret_cast<const proc_event *>(message->data); // NOLINT
+					switch (event->what)
+					{
+						case proc_event::PROC_EVENT_FORK:
+							events.events.push_back({ task_event::kind::fork, event->event_data.fork.child_pid,
+							                          event->event_data.fork.parent_pid,
+							                          event->event_data.fork.child_tgid });
+							break;
+						case proc_event::PROC_EVENT_EXEC:
+							events.events.push_back({ task_event::kind::exec, event->event_data.exec.process_pid });
+							break;
+						case proc_event::PROC_EVENT_EXIT:
+							events.events.push_back({ task_event::kind::exit, event->event_data.exit.process_pid });
+							break;
+						default: break;
+					}
+				}
+			}
+		}
+	};
+} // namespace syssnap
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Readers of the procfs files of the tasks, shared by the sources and the snapshot
+	namespace procfs
+	{
+		// Fields of a stat line used by the sources (see proc(5))
+		struct stat_fields
+		{
+			pid_t         pid{};
+			cpu_t         processor{};
+			std::uint64_t ticks{}; // utime + stime
+		};
+
+		[[nodiscard]] inline auto parse_stat(const std::string_view line) -> std::optional<stat_fields>
+		{
+			// The command name may contain spaces and parentheses, so the fields start after the last ')'
+			const auto open  = line.find(" (");
+			const auto close = line.rfind(')');
+			if (open == std::string_view::npos or close == std::string_view::npos or close < open) { return {}; }
+
+			stat_fields fields;
+			if (std::from_chars(line.data(), line.data() + open, fields.pid).ec != std::errc{}) { return {}; }
+
+			// Index 0 is the state (field 3 in proc(5))
+			constexpr std::size_t UTIME     = 11;
+			constexpr std::size_t STIME     = 12;
+			constexpr std::size_t PROCESSOR = 36;
+
+			std::uint64_t utime = 0;
+			std::uint64_t stime = 0;
+			bool          found = false;
+
+			std::size_t field = 0;
+			for (auto pos = close + 2; pos < line.size(); ++field)
+			{
+				auto end = line.find(' ', pos);
+				if (end == std::string_view::npos) { end = line.size(); }
+
+				const auto * first = line.data() + pos;
+				const auto * last  = line.data() + end;
+
+				if (field == UTIME) { std::from_chars(first, last, utime); }
+				else if (field == STIME) { std::from_chars(first, last, stime); }
+				else if (field == PROCESSOR)
+				{
+					found = std::from_chars(first, last, fields.processor).ec == std::errc{};
+					break;
+				}
+
+				pos = end + 1;
+			}
+
+			if (not found) { return {}; }
+
+			fields.ticks = utime + stime;
+			return fields;
+		}
+
+		// /proc/<process>/task/<tid>/stat (none if the TID exited)
+		[[nodiscard]] inline auto read_stat(const pid_t process, const pid_t tid) -> std::optional<stat_fields>
+		{
+			std::ifstream stat(fmt::format("/proc/{}/task/{}/stat", process, tid));
+
+			std::string line;
+			if (not std::getline(stat, line)) { return {}; }
+			return parse_stat(line);
+		}
+
+		// Numbers of the "<key>:" line of /proc/<tid>/status, e.g. the real, effective, saved and filesystem UIDs of
+		// "Uid:" (none if it cannot be read)
+		template<typename T>
+		[[nodiscard]] auto status_numbers(const pid_t pid, const std::string_view key) -> std::vector<T>
+		{
+			std::ifstream status(fmt::format("/proc/{}/status", pid));
+
+			std::vector<T> numbers;
+			for (std::string line; std::getline(status, line);)
+			{
+				if (not line.starts_with(key) or line.size() <= key.size() or line[key.size()] != ':') { continue; }
+
+				const auto * last = line.data() + line.size(); // NOLINT
+				for (auto pos = line.find_first_not_of(" \t", key.size() + 1); pos != std::string::npos;
+				     pos      = line.find_first_not_of(" \t", pos))
+				{
+					T          value{};
+					const auto result = std::from_chars(line.data() + pos, last, value);
+					if (result.ec != std::errc{}) { break; }
+
+					numbers.push_back(value);
+					pos = static_cast<std::size_t>(result.ptr - line.data());
+				}
+				break;
+			}
+
+			return numbers;
+		}
+
+		// Thread group (process) of the TID, from the "Tgid:" line of /proc/<tid>/status (the TID if it cannot be read)
+		[[nodiscard]] inline auto thread_group_of(const pid_t pid) -> pid_t
+		{
+			const auto tgid = status_numbers<pid_t>(pid, "Tgid");
+			return tgid.empty() ? pid : tgid.front();
+		}
+
+		// Effective UID of the TID, the second field of the "Uid:" line of /proc/<tid>/status
+		[[nodiscard]] inline auto effective_uid(const pid_t pid) -> std::optional<uid_t>
+		{
+			const auto uids = status_numbers<uid_t>(pid, "Uid");
+			if (uids.size() < 2) { return {}; }
+			return uids[1];
+		}
+
+		// A line of /proc/<tid>/cgroup (hierarchy-ID:controllers:path)
+		struct cgroup_entry
+		{
+			bool        unified{ false }; // The unified hierarchy of cgroups v2 ("0::<path>")
+			std::string path;
+		};
+
+		// Cgroups of the TID in every hierarchy, in the order of /proc/<tid>/cgroup (none if it cannot be read)
+		[[nodiscard]] inline auto cgroups_of(const pid_t pid) -> std::vector<cgroup_entry>
+		{
+			std::ifstream cgroups(fmt::format("/proc/{}/cgroup", pid));
+
+			std::vector<cgroup_entry> entries;
+			for (std::string line; std::getline(cgroups, line);)
+			{
+				const auto colon = line.find(':', line.find(':') + 1);
+				if (colon == std::string::npos) { continue; }
+
+				entries.push_back({ line.starts_with("0::"), line.substr(colon + 1) });
+			}
+
+			return entries;
+		}
+
+		// Cgroup of the TID: its path in the unified hierarchy if there is one, in the first hierarchy otherwise
+		// (empty if it cannot be read)
+		[[nodiscard]] inline auto cgroup_of(const pid_t pid) -> std::string
+		{
+			auto entries = cgroups_of(pid);
+			if (entries.empty()) { return {}; }
+
+			const auto unified = std::ranges::find_if(entries, &cgroup_entry::unified);
+			return std::move(unified == entries.end() ? entries.front() : *unified).path;
+		}
+	} // namespace procfs
+} // namespace syssnap
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "affinity.hpp"
+#include "procfs.hpp"
+#include "sampling.hpp"
+#include "topology.hpp"
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Live process source that reads procfs itself, so the snapshot can sample it (see sampled_source).
+	// Every update lists the TIDs of the system (/proc/<pid>/task), but only reads the stat of the new ones and of
+	// the ones in the sampling plan: the rest keep their last CPU and use. The use of a TID is its CPU time between
+	// its last two reads, over the time between them. Its tasks do not know their children, so a subtree scope
+	// only follows the forks it is told about (see basic_snapshot::update(const task_events &)).
+	class procfs_processes
+	{
+	public:
+		class task
+		{
+			friend class procfs_processes;
+
+		private:
+			using clock = std::chrono::steady_clock;
+
+			pid_t  pid_{};
+			cpu_t  processor_{};
+			node_t numa_node_{};
+			float  cpu_use_{};
+
+			std::uint64_t     ticks_{};   // utime + stime at the last read
+			clock::time_point read_at_{}; // Time of the last read
+
+		public:
+			[[nodiscard]] auto pid() const { return pid_; }
+
+			[[nodiscard]] auto processor() const { return processor_; }
+
+			[[nodiscard]] auto numa_node() const { return numa_node_; }
+
+			[[nodiscard]] auto cpu_use() const { return cpu_use_; }
+		};
+
+	private:
+		std::vector<node_t> cpu_node_map_; // input: CPU, output: node
+		std::vector<cpu_t>  cpus_;
+
+		double ticks_per_second_{ static_cast<double>(sysconf(_SC_CLK_TCK)) };
+
+		std::vector<task>                      tasks_;
+		std::unordered_map<pid_t, std::size_t> index_; // input: TID, output: position in tasks_
+
+		std::uint64_t reads_{ 0 }; // Stat files read so far
+
+		[[nodiscard]] static auto pid_from(const std::filesystem::path & path) -> pid_t
+		{
+			const auto name = path.filename().string();
+
+			pid_t      pid    = 0;
+			const auto result = std::from_chars(name.data(), name.data() + name.size(), pid);
+			return result.ec == std::errc{} and result.ptr == name.data() + name.size() ? pid : 0;
+		}
+
+		// Reads the stat of the TID into t, from its last read (none for a new TID). False if it exited.
+		[[nodiscard]] auto read(const pid_t process, const pid_t tid, const task * last, const task::clock::time_point now,
+		                        task & t) -> bool
+		{
+			const auto fields = procfs::read_stat(process, tid);
+			if (not fields or idx(fields->processor) >= cpu_node_map_.size()) { return false; }
+
+			++reads_;
+
+			t.pid_       = tid;
+			t.processor_ = fields->processor;
+			t.numa_node_ = cpu_node_map_[idx(fields->processor)];
+			t.ticks_     = fields->ticks;
+			t.read_at_   = now;
+
+			// New TIDs have no previous read, so their use is 0
+			if (last != nullptr and fields->ticks >= last->ticks_ and now > last->read_at_)
+			{
+				const auto seconds = std::chrono::duration<double>(now - last->read_at_).count();
+				const auto delta   = static_cast<double>(fields->ticks - last->ticks_);
+				t.cpu_use_         = static_cast<float>(delta / ticks_per_second_ / seconds * 100.0); // NOLINT
+			}
+
+			return true;
+		}
+
+		[[nodiscard]] auto all_cpus() const -> cpu_mask
+		{
+			return { cpus_, static_cast<cpu_t>(cpu_node_map_.size() - 1) };
+		}
+
+		// Lists every TID, and reads the new ones and those for which sampled(pid) is true
+		void scan(const auto & sampled)
+		{
+			namespace fs = std::filesystem;
+
+			const auto now = task::clock::now();
+
+			std::vector<task>                      tasks;
+			std::unordered_map<pid_t, std::size_t> index;
+			tasks.reserve(tasks_.size());
+			index.reserve(index_.size());
+
+			// Processes may exit while iterating, so an error only ends the listing of its directory (the iterators
+			// never throw)
+			std::error_code ec;
+			for (fs::directory_iterator process("/proc", ec), end; not ec and process != end; process.increment(ec))
+			{
+				const auto pid = pid_from(process->path());
+				if (pid <= 0) { continue; }
+
+				std::error_code task_ec;
+				for (fs::directory_iterator thread(process->path() / "task", task_ec);
+				     not task_ec and thread != end; thread.increment(task_ec))
+				{
+					const auto tid = pid_from(thread->path());
+					if (tid <= 0) { continue; }
+
+					const auto * last = get(tid);
+
+					task t;
+					if (last != nullptr and not sampled(tid)) { t = *last; }
+					else if (not read(pid, tid, last, now, t)) { continue; }
+
+					index.emplace(tid, tasks.size());
+					tasks.emplace_back(t);
+				}
+			}
+
+			tasks_ = std::move(tasks);
+			index_ = std::move(index);
+		}
+
+	public:
+		template<typename Topology>
+		explicit procfs_processes(const Topology & topo)
+		{
+			const auto & cpus = topo.cpus();
+			cpus_.assign(cpus.begin(), cpus.end());
+
+			cpu_node_map_.resize(idx(topo.max_cpu()) + 1, 0);
+			for (const auto cpu : cpus_)
+			{
+				cpu_node_map_.at(idx(cpu)) = topo.node_from_cpu(cpu);
+			}
+
+			update();
+		}
+
+		procfs_processes() : procfs_processes(topology{}) {}
+
+		// Reads every TID
+		void update()
+		{
+			scan([](const pid_t /*pid*/) { return true; });
+		}
+
+		// Only the TIDs of the plan (and the new ones) are read, the rest keep their last use
+		void update(const sampling_plan & plan)
+		{
+			scan([&](const pid_t pid) { return plan.sampled(pid); });
+		}
+
+		// Stat files read so far
+		[[nodiscard]] auto reads() const -> std::uint64_t { return reads_; }
+
+		[[nodiscard]] auto begin() const { return tasks_.begin(); }
+
+		[[nodiscard]] auto end() const { return tasks_.end(); }
+
+		[[nodiscard]] auto size() const { return tasks_.size(); }
+
+		[[nodiscard]] auto get(const pid_t pid) const -> const task *
+		{
+			const auto it = index_.find(pid);
+			return it == index_.end() ? nullptr : &tasks_[it->second];
+		}
+
+		[[nodiscard]] auto find(const pid_t pid) const -> const task & { return tasks_.at(index_.at(pid)); }
+
+		[[nodiscard]] auto cpu_use(const pid_t pid) const -> float
+		{
+			const auto * t = get(pid);
+			return t == nullptr ? 0.0F : t->cpu_use();
+		}
+
+		// Lets the TID run on every CPU again
+		void unpin(const pid_t pid) const { static_cast<void>(all_cpus().apply(pid)); }
+
+		void unpin() const
+		{
+			const auto all = all_cpus();
+			for (const auto & t : tasks_)
+			{
+				static_cast<void>(all.apply(t.pid()));
+			}
+		}
+	};
+} // namespace syssnap
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Immutable copy of the committed state of a snapshot, as published to the readers (see version_channel)
+	class snapshot_version
+	{
+	private:
+		std::uint64_t            generation_{ 0 };
+		std::chrono::nanoseconds timestamp_{ 0 };
+
+		std::vector<std::uint32_t> cpu_offsets_; // input: CPU, output: first TID of the CPU in the arrays below
+		std::vector<pid_t>         pids_;        // TIDs, grouped by CPU
+		std::vector<float>         pid_use_;     // use of each TID
+		std::vector<float>         pid_load_;    // load of each TID
+
+		std::vector<float> cpu_use_;   // input: CPU,  output: use
+		std::vector<float> cpu_load_;  // input: CPU,  output: load
+		std::vector<float> node_use_;  // input: node, output: use
+		std::vector<float> node_load_; // input: node, output: load
+		float              system_load_{ 0.0F };
+
+		template<typename T>
+		[[nodiscard]] auto of_cpu(const std::vector<T> & values, const cpu_t cpu) const -> std::span<const T>
+		{
+			const auto first = cpu_offsets_.at(idx(cpu));
+			return std::span{ values }.subspan(first, cpu_offsets_.at(idx(cpu) + 1) - first);
+		}
+
+	public:
+		// Copies the committed state of the snapshot. The arrays keep their capacity, so a version that is
+		// reused for a later update does not allocate unless the system grew.
+		template<typename Snapshot>
+		void assign(const Snapshot & snapshot, const std::uint64_t generation)
+		{
+			const auto & topo = snapshot.system_topology();
+
+			const auto size_cpus  = static_cast<std::size_t>(topo.max_cpu()) + 1;
+			const auto size_nodes = static_cast<std::size_t>(topo.max_node()) + 1;
+
+			generation_ = generation;
+			timestamp_  = std::chrono::steady_clock::now().time_since_epoch();
+
+			cpu_offsets_.resize(size_cpus + 1);
+			pids_.clear();
+			pid_use_.clear();
+			pid_load_.clear();
+
+			cpu_use_.assign(size_cpus, 0.0F);
+			cpu_load_.assign(size_cpus, 0.0F);
+			node_use_.assign(size_nodes, 0.0F);
+			node_load_.assign(size_nodes, 0.0F);
+
+			// CPUs out of the topology (offline, not allowed) are left empty
+			for (std::size_t i = 0; i < size_cpus; ++i)
+			{
+				const auto cpu = static_cast<cpu_t>(i);
+
+				const auto pids = snapshot.original_pids_in_cpu(cpu);
+				const auto use  = snapshot.original_use_in_cpu(cpu);
+				const auto load = snapshot.original_loads_in_cpu(cpu);
+
+				cpu_offsets_[i] = static_cast<std::uint32_t>(pids_.size());
+
+				pids_.insert(pids_.end(), pids.begin(), pids.end());
+				pid_use_.insert(pid_use_.end(), use.begin(), use.end());
+				pid_load_.insert(pid_load_.end(), load.begin(), load.end());
+
+				cpu_use_[i]  = snapshot.cpu_use(cpu);
+				cpu_load_[i] = snapshot.original_load_of_cpu(cpu);
+			}
+			cpu_offsets_[size_cpus] = static_cast<std::uint32_t>(pids_.size());
+
+			for (const auto node : topo.nodes())
+			{
+				node_use_[idx(node)]  = snapshot.node_use(node);
+				node_load_[idx(node)] = snapshot.original_load_of_node(node);
+			}
+
+			system_load_ = snapshot.load_system();
+		}
+
+		// Number of versions published before this one
+		[[nodiscard]] auto generation() const -> std::uint64_t { return generation_; }
+
+		// When the version was published (steady clock)
+		[[nodiscard]] auto timestamp() const -> std::chrono::nanoseconds { return timestamp_; }
+
+		[[nodiscard]] auto size() const -> std::size_t { return pids_.size(); }
+
+		[[nodiscard]] auto pids_in_cpu(const cpu_t cpu) const { return of_cpu(pids_, cpu); }
+
+		// Use and load of each TID of the CPU, in the same order as pids_in_cpu()
+		[[nodiscard]] auto use_in_cpu(const cpu_t cpu) const { return of_cpu(pid_use_, cpu); }
+
+		[[nodiscard]] auto loads_in_cpu(const cpu_t cpu) const { return of_cpu(pid_load_, cpu); }
+
+		[[nodiscard]] auto cpu_use(const cpu_t cpu) const -> float { return cpu_use_.at(idx(cpu)); }
+
+		[[nodiscard]] auto node_use(const node_t node) const -> float { return node_use_.at(idx(node)); }
+
+		[[nodiscard]] auto load_of_cpu(const cpu_t cpu) const -> float { return cpu_load_.at(idx(cpu)); }
+
+		[[nodiscard]] auto load_of_node(const node_t node) const -> float { return node_load_.at(idx(node)); }
+
+		[[nodiscard]] auto load_system() const -> float { return system_load_; }
+	};
+
+	// Single-writer, multi-reader channel of snapshot versions.
+	// The writer fills a version that no reader holds and then publishes it with an atomic store. Readers pin the
+	// latest version with one counter increment, so they never block the writer nor each other, and a version is
+	// only reused once every reader has released it.
+	// If every version is still held (readers slower than the updates), publishing is skipped and the readers keep
+	// the previous version.
+	class version_channel
+	{
+	private:
+		struct alignas(64) slot // NOLINT: one cache line per slot, so the readers of different slots do not collide
+		{
+			std::atomic<std::uint32_t> readers{ 0 };
+			snapshot_version           version;
+		};
+
+		static constexpr std::uint32_t NONE = ~std::uint32_t{ 0 };
+
+		std::unique_ptr<slot[]> slots_; // NOLINT
+		std::size_t             size_{};
+
+		std::atomic<std::uint32_t> current_{ NONE };
+
+		std::uint64_t published_{ 0 };
+		std::uint64_t skipped_{ 0 };
+
+	public:
+		// Pins a version until it is destroyed
+		class handle
+		{
+			friend class version_channel;
+
+		private:
+			slot * slot_{ nullptr };
+
+			explicit handle(slot * s) : slot_(s) {}
+
+		public:
+			handle() = default;
+
+			handle(const handle &)                     = delete;
+			auto operator=(const handle &) -> handle & = delete;
+
+			handle(handle && other) noexcept : slot_(std::exchange(other.slot_, nullptr)) {}
+
+			auto operator=(handle && other) noexcept -> handle &
+			{
+				if (this != &other)
+				{
+					release();
+					slot_ = std::exchange(other.slot_, nullptr);
+				}
+				return *this;
+			}
+
+			~handle() { release(); }
+
+			void release()
+			{
+				if (slot_ != nullptr) { slot_->readers.fetch_sub(1, std::memory_order_release); }
+				slot_ = nullptr;
+			}
+
+			explicit operator bool() const { return slot_ != nullptr; }
+
+			[[nodiscard]] auto operator*() const -> const snapshot_version & { return slot_->version; }
+
+			[[nodiscard]] auto operator->() const -> const snapshot_version * { return &slot_->version; }
+		};
+
+		// versions: how many versions can exist at once (the published one, the one being written, and the ones
+		// still held by slow readers)
+		explicit version_channel(const std::size_t versions = 4) :
+		    slots_(std::make_unique<slot[]>(versions)), size_(versions) // NOLINT
+		{
+			if (versions < 2) { throw std::invalid_argument("A version channel needs at least two versions"); }
+		}
+
+		// Latest published version (empty handle if nothing was published yet). Lock-free: it only retries if the
+		// writer published a new version in between.
+		[[nodiscard]] auto acquire() const -> handle
+		{
+			while (true)
+			{
+				const auto current = current_.load();
+				if (current == NONE) { return {}; }
+
+				auto & s = slots_[current];
+				s.readers.fetch_add(1);
+
+				// The writer only reuses slots that are not current and have no readers, so once the slot is
+				// pinned and still current, it cannot be overwritten
+				if (current_.load() == current) { return handle{ &s }; }
+
+				s.readers.fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		// Publishes the state of the snapshot as a new version. Only one thread may publish.
+		// Returns false if every other version is still held by the readers.
+		template<typename Snapshot>
+		auto publish(const Snapshot & snapshot) -> bool
+		{
+			const auto current = current_.load(std::memory_order_relaxed);
+
+			for (std::size_t i = 0; i < size_; ++i)
+			{
+				auto & s = slots_[i];
+				if (i == current or s.readers.load() != 0) { continue; }
+
+				s.version.assign(snapshot, published_);
+				current_.store(static_cast<std::uint32_t>(i));
+
+				++published_;
+				return true;
+			}
+
+			++skipped_;
+			return false;
+		}
+
+		// Versions published and skipped so far (only meaningful for the writer thread)
+		[[nodiscard]] auto published() const -> std::uint64_t { return published_; }
+
+		[[nodiscard]] auto skipped() const -> std::uint64_t { return skipped_; }
+	};
+} // namespace syssnap
@@ -0,0 +1,654 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "synthetic.hpp"
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Binary record of snapshots, to capture every tick of a production system and analyse it offline.
+	// A record is a topology header followed by any number of frames, appended one per tick:
+	//
+	//   file_header                     magic, version, byte order, number of CPUs and nodes
+	//   i32 cpus[cpus]                  CPUs of the system
+	//   i32 cpu_nodes[cpus]             node of each CPU
+	//   i32 nodes[nodes]                nodes of the system
+	//   i32 distances[nodes * nodes]    NUMA distance between each pair of nodes
+	//
+	//   frame_header                    magic, size of the frame, timestamp, number of tasks and migrations
+	//   u32 cpu_offsets[cpus + 1]       the tasks of the i-th CPU are [cpu_offsets[i], cpu_offsets[i + 1])
+	//   i32 pids[tasks]                 TIDs, grouped by CPU
+	//   i32 nodes[tasks]                node of each TID
+	//   f32 cpu_use[tasks]              use of each TID
+	//   f32 load[tasks]                 load of each TID
+	//   migration migrations[migrations] pending (uncommitted) migrations
+	//
+	// Every section starts at a multiple of 8 bytes, and the values are stored in the byte order of the machine,
+	// so a memory-mapped record is read in place (see record::reader). A frame costs 16 bytes per task and 12 per
+	// migration, plus a fixed overhead of 40 bytes of header and 4 bytes per CPU.
+	namespace record
+	{
+		inline constexpr std::array<char, 8> MAGIC = { 'S', 'Y', 'S', 'S', 'N', 'A', 'P', 'B' };
+
+		inline constexpr std::uint32_t VERSION = 1;
+
+		inline constexpr std::uint32_t FRAME_MAGIC = 0x4D415246; // "FRAM" in little endian
+
+		inline constexpr std::uint32_t ENDIANNESS = 0x01020304;
+
+		inline constexpr std::size_t ALIGNMENT = 8;
+
+		struct file_header
+		{
+			std::array<char, 8> magic{ MAGIC };
+			std::uint32_t       version{ VERSION };
+			std::uint32_t       byte_order{ ENDIANNESS };
+			std::uint32_t       cpus{};
+			std::uint32_t       nodes{};
+		};
+
+		struct frame_header
+		{
+			std::uint32_t magic{ FRAME_MAGIC };
+			std::uint32_t reserved{};
+			std::uint64_t size{}; // Bytes of the frame, header included
+			std::int64_t  timestamp{}; // In ns
+			std::uint32_t tasks{};
+			std::uint32_t cpus{};
+			std::uint32_t migrations{};
+			std::uint32_t reserved_2{};
+		};
+
+		enum class migration_kind : std::int32_t
+		{
+			cpu, // Pinned to one CPU (migrate_to_cpu)
+			node // Pinned to the CPUs of a node (migrate_to_node)
+		};
+
+		struct migration
+		{
+			pid_t          pid{};
+			migration_kind kind{ migration_kind::cpu };
+			std::int32_t   target{}; // Destination CPU or node
+		};
+
+		static_assert(sizeof(file_header) % ALIGNMENT == 0);
+		static_assert(sizeof(frame_header) % ALIGNMENT == 0);
+		static_assert(std::is_trivially_copyable_v<migration> and sizeof(migration) == 12);
+		static_assert(sizeof(pid_t) == 4 and sizeof(cpu_t) == 4 and sizeof(node_t) == 4 and sizeof(float) == 4);
+
+		namespace detail
+		{
+			[[nodiscard]] constexpr auto aligned(const std::size_t size) -> std::size_t
+			{
+				return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+			}
+
+			// Bytes of an array section of n elements, padding included
+			template<typename T>
+			[[nodiscard]] constexpr auto section_size(const std::size_t n) -> std::size_t
+			{
+				return aligned(n * sizeof(T));
+			}
+
+			// Appends an array section, padded with zeros up to the alignment
+			template<typename T>
+			void put(std::vector<std::byte> & buffer, const std::span<const T> values)
+			{
+				const auto offset = buffer.size();
+				buffer.resize(offset + section_size<T>(values.size()), std::byte{ 0 });
+				if (not values.empty()) { std::memcpy(buffer.data() + offset, values.data(), values.size_bytes()); }
+			}
+
+			template<typename T>
+			void put(std::vector<std::byte> & buffer, const T & value)
+			{
+				put(buffer, std::span<const T>(&value, 1));
+			}
+
+			// View of an array section in a mapped record. Moves the cursor past the section.
+			template<typename T>
+			[[nodiscard]] auto take(std::span<const std::byte> & bytes, const std::size_t n) -> std::span<const T>
+			{
+				const auto size = section_size<T>(n);
+				if (bytes.size() < size) { throw std::runtime_error("Truncated snapshot record"); }
+
+				const auto * first = reinterpret_cast<const T *>(bytes.data()); // NOLINT
+				bytes              = bytes.subspan(size);
+				return { first, n };
+			}
+
+			struct unmapper
+			{
+				std::size_t size{};
+
+				void operator()(void * addr) const { munmap(addr, size); }
+			};
+		} // namespace detail
+
+		// Topology stored in the header of a record
+		class topology_view
+		{
+		private:
+			std::span<const cpu_t>        cpus_;
+			std::span<const node_t>       cpu_nodes_;
+			std::span<const node_t>       nodes_;
+			std::span<const std::int32_t> distances_;
+
+			std::vector<std::uint32_t> cpu_position_; // input: CPU, output: position in cpus_
+
+		public:
+			static constexpr auto NOT_RECORDED = ~std::uint32_t{ 0 };
+
+			topology_view() = default;
+
+			// Reads the topology at the beginning of bytes, and moves the cursor past it
+			explicit topology_view(std::span<const std::byte> & bytes)
+			{
+				const auto header = detail::take<file_header>(bytes, 1).front();
+
+				if (header.magic != MAGIC) { throw std::runtime_error("Not a syssnap snapshot record"); }
+				if (header.byte_order != ENDIANNESS)
+				{
+					throw std::runtime_error("The snapshot record was written with another byte order");
+				}
+				if (header.version != VERSION)
+				{
+					throw std::runtime_error(fmt::format("Unsupported snapshot record version {}", header.version));
+				}
+
+				cpus_      = detail::take<cpu_t>(bytes, header.cpus);
+				cpu_nodes_ = detail::take<node_t>(bytes, header.cpus);
+				nodes_     = detail::take<node_t>(bytes, header.nodes);
+				distances_ = detail::take<std::int32_t>(bytes, std::size_t{ header.nodes } * header.nodes);
+
+				for (std::size_t i = 0; i < cpus_.size(); ++i)
+				{
+					const auto cpu = idx(cpus_[i]);
+					if (cpu >= cpu_position_.size()) { cpu_position_.resize(cpu + 1, NOT_RECORDED); }
+					cpu_position_[cpu] = static_cast<std::uint32_t>(i);
+				}
+			}
+
+			[[nodiscard]] auto cpus() const -> std::span<const cpu_t> { return cpus_; }
+
+			[[nodiscard]] auto nodes() const -> std::span<const node_t> { return nodes_; }
+
+			[[nodiscard]] auto node_from_cpu(const cpu_t cpu) const -> node_t { return cpu_nodes_[position(cpu)]; }
+
+			[[nodiscard]] auto node_distance(const node_t node_1, const node_t node_2) const -> int
+			{
+				return distances_[node_position(node_1) * nodes_.size() + node_position(node_2)];
+			}
+
+			// Position of the CPU in cpus()
+			[[nodiscard]] auto position(const cpu_t cpu) const -> std::size_t
+			{
+				if (idx(cpu) >= cpu_position_.size() or cpu_position_[idx(cpu)] == NOT_RECORDED)
+				{
+					throw std::out_of_range(fmt::format("CPU {} is not in the record", cpu));
+				}
+				return cpu_position_[idx(cpu)];
+			}
+
+			// Position of the node in nodes()
+			[[nodiscard]] auto node_position(const node_t node) const -> std::size_t
+			{
+				const auto it = std::ranges::find(nodes_, node);
+				if (it == nodes_.end()) { throw std::out_of_range(fmt::format("Node {} is not in the record", node)); }
+				return static_cast<std::size_t>(it - nodes_.begin());
+			}
+
+			// Topology of the recorded machine, to build a snapshot out of it (e.g. with replay_processes)
+			[[nodiscard]] auto topology() const -> synthetic_topology
+			{
+				std::vector<node_t> cpu_node_map(idx(*std::ranges::max_element(cpus_)) + 1, 0);
+				for (std::size_t i = 0; i < cpus_.size(); ++i)
+				{
+					cpu_node_map[idx(cpus_[i])] = cpu_nodes_[i];
+				}
+				return synthetic_topology(std::move(cpu_node_map));
+			}
+		};
+
+		// Read-only view of a recorded snapshot. Every accessor points into the record, nothing is copied.
+		class frame_view
+		{
+		private:
+			const topology_view * topology_{ nullptr };
+
+			std::int64_t timestamp_{};
+
+			std::span<const std::uint32_t> cpu_offsets_;
+			std::span<const pid_t>         pids_;
+			std::span<const node_t>        nodes_;
+			std::span<const float>         cpu_use_;
+			std::span<const float>         loads_;
+			std::span<const migration>     migrations_;
+
+			template<typename T>
+			[[nodiscard]] auto of_cpu(const std::span<const T> values, const cpu_t cpu) const -> std::span<const T>
+			{
+				const auto i = topology_->position(cpu);
+				return values.subspan(cpu_offsets_[i], cpu_offsets_[i + 1] - cpu_offsets_[i]);
+			}
+
+		public:
+			frame_view() = default;
+
+			// Reads the frame at the beginning of bytes, which must hold the whole frame
+			frame_view(const topology_view & topo, std::span<const std::byte> bytes) : topology_(&topo)
+			{
+				const auto header = detail::take<frame_header>(bytes, 1).front();
+
+				if (header.magic != FRAME_MAGIC) { throw std::runtime_error("Corrupted snapshot record"); }
+				if (header.cpus != topo.cpus().size())
+				{
+					throw std::runtime_error("The frame does not match the topology of the record");
+				}
+
+				timestamp_   = header.timestamp;
+				cpu_offsets_ = detail::take<std::uint32_t>(bytes, std::size_t{ header.cpus } + 1);
+				pids_        = detail::take<pid_t>(bytes, header.tasks);
+				nodes_       = detail::take<node_t>(bytes, header.tasks);
+				cpu_use_     = detail::take<float>(bytes, header.tasks);
+				loads_       = detail::take<float>(bytes, header.tasks);
+				migrations_  = detail::take<migration>(bytes, header.migrations);
+
+				// The tasks of each CPU must lie within the frame
+				if (cpu_offsets_.back() != header.tasks or not std::ranges::is_sorted(cpu_offsets_))
+				{
+					throw std::runtime_error("Corrupted snapshot record");
+				}
+			}
+
+			[[nodiscard]] auto timestamp() const -> std::chrono::nanoseconds { return std::chrono::nanoseconds{ timestamp_ }; }
+
+			[[nodiscard]] auto system_topology() const -> const topology_view & { return *topology_; }
+
+			[[nodiscard]] auto size() const -> std::size_t { return pids_.size(); }
+
+			// Per-TID arrays, grouped by CPU (in the order of system_topology().cpus())
+			[[nodiscard]] auto pids() const -> std::span<const pid_t> { return pids_; }
+
+			[[nodiscard]] auto numa_nodes() const -> std::span<const node_t> { return nodes_; }
+
+			[[nodiscard]] auto cpu_use() const -> std::span<const float> { return cpu_use_; }
+
+			[[nodiscard]] auto loads() const -> std::span<const float> { return loads_; }
+
+			[[nodiscard]] auto migrations() const -> std::span<const migration> { return migrations_; }
+
+			[[nodiscard]] auto pids_in_cpu(const cpu_t cpu) const { return of_cpu(pids_, cpu); }
+
+			[[nodiscard]] auto use_in_cpu(const cpu_t cpu) const { return of_cpu(cpu_use_, cpu); }
+
+			[[nodiscard]] auto loads_in_cpu(const cpu_t cpu) const { return of_cpu(loads_, cpu); }
+
+			// CPU of the i-th TID, found by binary search over the CPU offsets
+			[[nodiscard]] auto processor(const std::size_t i) const -> cpu_t
+			{
+				const auto it = std::ranges::upper_bound(cpu_offsets_, static_cast<std::uint32_t>(i));
+				return topology_->cpus()[static_cast<std::size_t>(it - cpu_offsets_.begin()) - 1];
+			}
+
+			[[nodiscard]] auto cpu_use(const cpu_t cpu) const -> float
+			{
+				auto total = 0.0F;
+				for (const auto use : use_in_cpu(cpu))
+				{
+					total += use;
+				}
+				return total;
+			}
+
+			[[nodiscard]] auto load_of_cpu(const cpu_t cpu) const -> float
+			{
+				auto total = 0.0F;
+				for (const auto load : loads_in_cpu(cpu))
+				{
+					total += load;
+				}
+				return total;
+			}
+		};
+
+		// Appends the topology header of a record to buffer
+		template<typename Topology>
+		void encode_topology(std::vector<std::byte> & buffer, const Topology & topo)
+		{
+			const auto & cpus  = topo.cpus();
+			const auto & nodes = topo.nodes();
+
+			file_header header;
+			header.cpus  = static_cast<std::uint32_t>(std::size(cpus));
+			header.nodes = static_cast<std::uint32_t>(std::size(nodes));
+
+			std::vector<cpu_t>        cpu_list(std::begin(cpus), std::end(cpus));
+			std::vector<node_t>       cpu_nodes;
+			std::vector<node_t>       node_list(std::begin(nodes), std::end(nodes));
+			std::vector<std::int32_t> distances;
+
+			cpu_nodes.reserve(cpu_list.size());
+			for (const auto cpu : cpu_list)
+			{
+				cpu_nodes.emplace_back(topo.node_from_cpu(cpu));
+			}
+
+			distances.reserve(node_list.size() * node_list.size());
+			for (const auto node_1 : node_list)
+			{
+				for (const auto node_2 : node_list)
+				{
+					distances.emplace_back(topo.node_distance(node_1, node_2));
+				}
+			}
+
+			detail::put(buffer, header);
+			detail::put(buffer, std::span<const cpu_t>(cpu_list));
+			detail::put(buffer, std::span<const node_t>(cpu_nodes));
+			detail::put(buffer, std::span<const node_t>(node_list));
+			detail::put(buffer, std::span<const std::int32_t>(distances));
+		}
+
+		// Appends the committed state of the snapshot (plus its pending migrations) to buffer, as one frame.
+		// The buffer keeps its capacity, so encoding every tick into the same buffer does not allocate.
+		template<typename Snapshot>
+		void encode_frame(std::vector<std::byte> & buffer, const Snapshot & snapshot,
+		                  const std::chrono::nanoseconds timestamp)
+		{
+			const auto & cpus = snapshot.system_topology().cpus();
+
+			frame_header header;
+			header.timestamp = timestamp.count();
+			header.cpus      = static_cast<std::uint32_t>(std::size(cpus));
+
+			for (const auto cpu : cpus)
+			{
+				header.tasks += static_cast<std::uint32_t>(snapshot.original_pids_in_cpu(cpu).size());
+			}
+
+			const auto & cpu_migrations  = snapshot.pending_cpu_migrations();
+			const auto & node_migrations = snapshot.pending_node_migrations();
+
+			// The node migrations take precedence, as in commit()
+			for (const auto & [pid, cpu] : cpu_migrations)
+			{
+				if (not node_migrations.contains(pid)) { ++header.migrations; }
+			}
+			header.migrations += static_cast<std::uint32_t>(node_migrations.size());
+
+			header.size = sizeof(frame_header) + detail::section_size<std::uint32_t>(std::size_t{ header.cpus } + 1) +
+			              4 * detail::section_size<std::int32_t>(header.tasks) +
+			              detail::section_size<migration>(header.migrations);
+
+			const auto start = buffer.size();
+			buffer.resize(start + header.size, std::byte{ 0 });
+
+			// Sections are written in place, each at its aligned offset
+			auto * cursor = buffer.data() + start;
+
+			const auto section = [&cursor]<typename T>(const std::size_t n) {
+				auto * first = reinterpret_cast<T *>(cursor); // NOLINT
+				cursor += detail::section_size<T>(n);         // NOLINT
+				return std::span<T>(first, n);
+			};
+
+			std::memcpy(cursor, &header, sizeof(header));
+			cursor += sizeof(header); // NOLINT
+
+			const auto offsets = section.template operator()<std::uint32_t>(std::size_t{ header.cpus } + 1);
+			const auto pids    = section.template operator()<pid_t>(header.tasks);
+			const auto nodes   = section.template operator()<node_t>(header.tasks);
+			const auto use     = section.template operator()<float>(header.tasks);
+			const auto loads   = section.template operator()<float>(header.tasks);
+			const auto moves   = section.template operator()<migration>(header.migrations);
+
+			std::size_t task      = 0;
+			std::size_t cpu_index = 0;
+			for (const auto cpu : cpus)
+			{
+				offsets[cpu_index++] = static_cast<std::uint32_t>(task);
+
+				const auto cpu_pids  = snapshot.original_pids_in_cpu(cpu);
+				const auto cpu_use   = snapshot.original_use_in_cpu(cpu);
+				const auto cpu_loads = snapshot.original_loads_in_cpu(cpu);
+
+				for (std::size_t i = 0; i < cpu_pids.size(); ++i, ++task)
+				{
+					pids[task]  = cpu_pids[i];
+					nodes[task] = snapshot.original_numa_node(cpu_pids[i]);
+					use[task]   = cpu_use[i];
+					loads[task] = cpu_loads[i];
+				}
+			}
+			offsets[cpu_index] = static_cast<std::uint32_t>(task);
+
+			std::size_t m = 0;
+			for (const auto & [pid, cpu] : cpu_migrations)
+			{
+				if (not node_migrations.contains(pid)) { moves[m++] = { pid, migration_kind::cpu, cpu }; }
+			}
+			for (const auto & [pid, node] : node_migrations)
+			{
+				moves[m++] = { pid, migration_kind::node, node };
+			}
+		}
+
+		// Appends frames to a record file. A new (or empty) file gets the topology header first; an existing record
+		// must have been written for the same topology, and loses its last frame if it was cut short. Each frame is
+		// written with a single call.
+		class writer
+		{
+		private:
+			std::ofstream out_;
+
+			std::vector<std::byte> buffer_; // Reused for every frame
+
+			std::size_t frames_{ 0 };
+
+			void write_buffer()
+			{
+				out_.write(reinterpret_cast<const char *>(buffer_.data()), // NOLINT
+				           static_cast<std::streamsize>(buffer_.size()));
+				if (not out_) { throw std::runtime_error("Error writing the snapshot record"); }
+			}
+
+			// End of the last complete frame of a record of size bytes, whose frames start at offset
+			[[nodiscard]] static auto end_of_frames(std::ifstream & in, std::uint64_t offset, const std::uint64_t size)
+			    -> std::uint64_t
+			{
+				while (size - offset >= sizeof(frame_header))
+				{
+					frame_header header;
+					in.seekg(static_cast<std::streamoff>(offset));
+					if (not in.read(reinterpret_cast<char *>(&header), sizeof(header))) { break; } // NOLINT
+
+					if (header.magic != FRAME_MAGIC or header.size < sizeof(frame_header))
+					{
+						throw std::runtime_error("Corrupted snapshot record");
+					}
+					if (header.size > size - offset) { break; }
+
+					offset += header.size;
+				}
+				return offset;
+			}
+
+		public:
+			template<typename Topology>
+			writer(const std::filesystem::path & path, const Topology & topo)
+			{
+				encode_topology(buffer_, topo);
+
+				std::error_code ec;
+				const auto      existing = std::filesystem::file_size(path, ec);
+
+				if (not ec and existing > 0)
+				{
+					// Appending: the header on disk must be the one of this topology
+					std::vector<char> header(buffer_.size());
+
+					std::ifstream in(path, std::ios::binary);
+					if (not in.read(header.data(), static_cast<std::streamsize>(header.size())) or
+					    std::memcmp(header.data(), buffer_.data(), header.size()) != 0)
+					{
+						throw std::runtime_error(
+						    fmt::format("{} is not a snapshot record of this topology", path.string()));
+					}
+
+					// A frame cut short (e.g. the writer died in the middle of a tick) is dropped, so the new frames
+					// follow the last complete one instead of the partial bytes
+					const auto end = end_of_frames(in, header.size(), existing);
+					in.close();
+
+					if (end < existing) { std::filesystem::resize_file(path, end); }
+				}
+
+				out_.open(path, std::ios::binary | std::ios::app);
+				if (not out_) { throw std::runtime_error(fmt::format("Cannot open record {}", path.string())); }
+
+				if (ec or existing == 0)
+				{
+					write_buffer();
+					out_.flush();
+				}
+			}
+
+			// Appends the snapshot as a new frame. The timestamp defaults to the time of the call.
+			template<typename Snapshot>
+			void append(const Snapshot & snapshot, std::chrono::nanoseconds timestamp = std::chrono::nanoseconds{ -1 })
+			{
+				if (timestamp.count() < 0) { timestamp = std::chrono::steady_clock::now().time_since_epoch(); }
+
+				buffer_.clear();
+				encode_frame(buffer_, snapshot, timestamp);
+				write_buffer();
+
+				++frames_;
+			}
+
+			void flush() { out_.flush(); }
+
+			// Frames appended by this writer
+			[[nodiscard]] auto frames() const -> std::size_t { return frames_; }
+		};
+
+		// Memory-mapped record. The frames are read in place, without copying nor parsing them.
+		// A frame that was cut short (e.g. the writer died in the middle of a tick) is ignored.
+		class reader
+		{
+		private:
+			std::unique_ptr<void, detail::unmapper> mapping_;
+
+			std::span<const std::byte> bytes_;
+
+			topology_view topology_;
+
+			std::vector<std::span<const std::byte>> frames_;
+
+			void index(std::span<const std::byte> rest)
+			{
+				while (rest.size() >= sizeof(frame_header))
+				{
+					frame_header header;
+					std::memcpy(&header, rest.data(), sizeof(header));
+
+					if (header.magic != FRAME_MAGIC or header.size < sizeof(frame_header))
+					{
+						throw std::runtime_error("Corrupted snapshot record");
+					}
+					if (header.size > rest.size()) { break; }
+
+					frames_.emplace_back(rest.first(header.size));
+					rest = rest.subspan(header.size);
+				}
+			}
+
+		public:
+			explicit reader(const std::filesystem::path & path)
+			{
+				const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT
+				if (fd < 0)
+				{
+					throw std::runtime_error(fmt::format("Cannot open record {}: {}", path.string(), strerror(errno)));
+				}
+
+				struct stat info = {};
+				if (fstat(fd, &info) != 0 or info.st_size == 0)
+				{
+					close(fd);
+					throw std::runtime_error(fmt::format("{} is not a snapshot record", path.string()));
+				}
+
+				const auto size = static_cast<std::size_t>(info.st_size);
+				auto *     addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+				close(fd);
+
+				if (addr == MAP_FAILED)
+				{
+					throw std::runtime_error(fmt::format("Cannot map record {}: {}", path.string(), strerror(errno)));
+				}
+
+				mapping_ = { addr, detail::unmapper{ size } };
+				bytes_   = { static_cast<const std::byte *>(addr), size };
+
+				auto rest = bytes_;
+				topology_ = topology_view(rest);
+				index(rest);
+			}
+
+			// Reads the record from memory (e.g. a buffer filled with encode_topology() and encode_frame()).
+			// The bytes must outlive the reader and be aligned to 8 bytes.
+			explicit reader(const std::span<const std::byte> bytes) : bytes_(bytes)
+			{
+				auto rest = bytes_;
+				topology_ = topology_view(rest);
+				index(rest);
+			}
+
+			reader(const reader &)                     = delete;
+			auto operator=(const reader &) -> reader & = delete;
+
+			reader(reader &&)                     = delete;
+			auto operator=(reader &&) -> reader & = delete;
+
+			~reader() = default;
+
+			[[nodiscard]] auto system_topology() const -> const topology_view & { return topology_; }
+
+			[[nodiscard]] auto size() const -> std::size_t { return frames_.size(); }
+
+			[[nodiscard]] auto empty() const -> bool { return frames_.empty(); }
+
+			[[nodiscard]] auto operator[](const std::size_t i) const -> frame_view { return { topology_, frames_[i] }; }
+
+			[[nodiscard]] auto at(const std::size_t i) const -> frame_view { return { topology_, frames_.at(i) }; }
+
+			[[nodiscard]] auto back() const -> frame_view { return at(size() - 1); }
+		};
+	} // namespace record
+} // namespace syssnap
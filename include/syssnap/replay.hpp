@@ -0,0 +1,269 @@
+#pragma once
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "affinity.hpp"
+#include "locality.hpp"
+#include "memory.hpp"
+#include "procfs.hpp"
+#include "synthetic.hpp"
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Captures of procfs, to replay a system offline (see replay_processes).
+	// Text format, one header and then any number of frames:
+	//
+	//   # syssnap procfs capture v1
+	//   # clk_tck 100
+	//   # cpu <cpu> <node>          (one line per CPU)
+	//   # frame <timestamp in ns>
+	//   <contents of /proc/<pid>/task/<tid>/stat>   (one line per TID)
+	//   # frame <timestamp in ns>
+	//   ...
+	namespace capture
+	{
+		inline constexpr std::string_view MAGIC = "# syssnap procfs capture v1";
+
+		template<typename Topology>
+		void write_header(std::ostream & os, const Topology & topo)
+		{
+			os << MAGIC << '\n';
+			os << "# clk_tck " << sysconf(_SC_CLK_TCK) << '\n';
+			for (const auto cpu : topo.cpus())
+			{
+				os << "# cpu " << cpu << ' ' << topo.node_from_cpu(cpu) << '\n';
+			}
+		}
+
+		// Appends the stat line of every TID of the running system as a new frame
+		inline void write_frame(std::ostream & os)
+		{
+			namespace fs = std::filesystem;
+
+			const auto now = std::chrono::steady_clock::now().time_since_epoch();
+			os << "# frame " << std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() << '\n';
+
+			std::error_code ec;
+			for (const auto & process : fs::directory_iterator("/proc", ec))
+			{
+				const auto name = process.path().filename().string();
+				if (name.empty() or name.find_first_not_of("0123456789") != std::string::npos) { continue; }
+
+				// Processes may exit while iterating, so every error just skips them
+				for (const auto & thread : fs::directory_iterator(process.path() / "task", ec))
+				{
+					std::ifstream stat(thread.path() / "stat");
+					if (std::string line; std::getline(stat, line) and not line.empty()) { os << line << '\n'; }
+				}
+			}
+		}
+	} // namespace capture
+
+	// Process source that replays a procfs capture, one frame per update().
+	// The usage of each TID comes from the ticks between consecutive frames, as the live backend computes it.
+	class replay_processes
+	{
+	public:
+		class task
+		{
+			friend class replay_processes;
+
+		private:
+			pid_t  pid_{};
+			cpu_t  processor_{};
+			node_t numa_node_{};
+			float  cpu_use_{};
+
+		public:
+			[[nodiscard]] auto pid() const { return pid_; }
+
+			[[nodiscard]] auto processor() const { return processor_; }
+
+			[[nodiscard]] auto numa_node() const { return numa_node_; }
+
+			[[nodiscard]] auto cpu_use() const { return cpu_use_; }
+		};
+
+	private:
+		std::ifstream in_;
+		std::string   line_; // First line not consumed yet (the header of the next frame)
+
+		long                clk_tck_{ 100 }; // NOLINT
+		std::vector<node_t> cpu_node_map_;   // input: CPU, output: node
+
+		std::vector<task>                        tasks_;
+		std::unordered_map<pid_t, std::size_t>   index_; // input: TID, output: position in tasks_
+		std::unordered_map<pid_t, std::uint64_t> ticks_; // input: TID, output: ticks in the previous frame
+
+		std::int64_t timestamp_{ 0 };
+		bool         first_frame_{ true };
+		bool         at_end_{ false };
+
+		[[nodiscard]] auto next_line() -> bool
+		{
+			if (std::getline(in_, line_)) { return true; }
+			line_.clear();
+			return false;
+		}
+
+		void read_header()
+		{
+			if (not next_line() or line_ != capture::MAGIC) { throw std::runtime_error("Not a syssnap procfs capture"); }
+
+			while (next_line() and line_.starts_with("# ") and not line_.starts_with("# frame "))
+			{
+				std::istringstream header(line_.substr(2));
+				std::string        key;
+				header >> key;
+
+				if (key == "clk_tck") { header >> clk_tck_; }
+				else if (key == "cpu")
+				{
+					cpu_t  cpu  = 0;
+					node_t node = 0;
+					header >> cpu >> node;
+					if (idx(cpu) >= cpu_node_map_.size()) { cpu_node_map_.resize(idx(cpu) + 1, 0); }
+					cpu_node_map_[idx(cpu)] = node;
+				}
+			}
+
+			if (cpu_node_map_.empty()) { throw std::runtime_error("The capture does not list any CPU"); }
+		}
+
+		void read_frame()
+		{
+			if (not line_.starts_with("# frame "))
+			{
+				at_end_ = true;
+				return;
+			}
+
+			std::int64_t timestamp = 0;
+			std::from_chars(line_.data() + 8, line_.data() + line_.size(), timestamp); // NOLINT
+
+			const auto seconds          = static_cast<double>(timestamp - timestamp_) / 1e9;
+			const auto ticks_per_second = static_cast<double>(clk_tck_);
+
+			tasks_.clear();
+			index_.clear();
+
+			std::unordered_map<pid_t, std::uint64_t> ticks;
+			ticks.reserve(ticks_.size());
+
+			while (next_line() and not line_.starts_with("# frame "))
+			{
+				const auto fields = procfs::parse_stat(line_);
+				if (not fields or idx(fields->processor) >= cpu_node_map_.size()) { continue; }
+
+				task t;
+				t.pid_       = fields->pid;
+				t.processor_ = fields->processor;
+				t.numa_node_ = cpu_node_map_[idx(fields->processor)];
+
+				// New TIDs (and the first frame) have no previous sample, so their usage is 0
+				if (const auto prev = ticks_.find(fields->pid);
+				    not first_frame_ and seconds > 0 and prev != ticks_.end() and fields->ticks >= prev->second)
+				{
+					const auto delta = static_cast<double>(fields->ticks - prev->second);
+					t.cpu_use_       = static_cast<float>(delta / ticks_per_second / seconds * 100.0); // NOLINT
+				}
+
+				ticks.emplace(t.pid_, fields->ticks);
+				index_.emplace(t.pid_, tasks_.size());
+				tasks_.emplace_back(t);
+			}
+
+			ticks_       = std::move(ticks);
+			timestamp_   = timestamp;
+			first_frame_ = false;
+		}
+
+	public:
+		explicit replay_processes(const std::filesystem::path & path) : in_(path)
+		{
+			if (not in_) { throw std::runtime_error(fmt::format("Cannot open capture {}", path.string())); }
+
+			read_header();
+			read_frame();
+		}
+
+		// Moves to the next frame. Once the capture is over, the last frame stays.
+		void update()
+		{
+			if (at_end_) { return; }
+			read_frame();
+		}
+
+		// True after an update() found no more frames
+		[[nodiscard]] auto at_end() const -> bool { return at_end_; }
+
+		// Topology of the machine where the capture was recorded
+		[[nodiscard]] auto topology() const -> synthetic_topology { return synthetic_topology(cpu_node_map_); }
+
+		[[nodiscard]] auto begin() const { return tasks_.begin(); }
+
+		[[nodiscard]] auto end() const { return tasks_.end(); }
+
+		[[nodiscard]] auto size() const { return tasks_.size(); }
+
+		[[nodiscard]] auto get(const pid_t pid) const -> const task *
+		{
+			const auto it = index_.find(pid);
+			return it == index_.end() ? nullptr : &tasks_[it->second];
+		}
+
+		[[nodiscard]] auto find(const pid_t pid) const -> const task & { return tasks_.at(index_.at(pid)); }
+
+		[[nodiscard]] auto cpu_use(const pid_t pid) const -> float
+		{
+			const auto * t = get(pid);
+			return t == nullptr ? 0.0F : t->cpu_use();
+		}
+
+		// A recording cannot be changed: migrations of TIDs in the current frame succeed without effect
+		[[nodiscard]] auto set_affinity(const pid_t pid, const cpu_mask & /*mask*/) const -> int
+		{
+			return get(pid) == nullptr ? ESRCH : 0;
+		}
+
+		// Nor does a recording know the memory of its tasks
+		[[nodiscard]] auto numa_footprint(const pid_t /*pid*/) const -> syssnap::numa_footprint { return {}; }
+
+		[[nodiscard]] auto migrate_memory(const pid_t pid, const node_t /*node*/, const std::uint64_t /*max_bytes*/) const
+		    -> memory_step
+		{
+			return { 0, get(pid) == nullptr ? ESRCH : 0, true };
+		}
+
+		[[nodiscard]] auto numa_faults(const pid_t /*pid*/) const -> syssnap::numa_faults { return {}; }
+
+		// Nor their groups: each task is a process of its own, in the root cgroup
+		[[nodiscard]] auto thread_group(const pid_t pid) const -> pid_t { return pid; }
+
+		[[nodiscard]] auto cgroup(const pid_t /*pid*/) const -> std::string { return "/"; }
+
+		[[nodiscard]] auto nice(const pid_t /*pid*/) const -> int { return 0; }
+
+		void unpin(const pid_t /*pid*/) const {}
+
+		void unpin() const {}
+	};
+} // namespace syssnap
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "types.hpp"
+
+namespace syssnap
+{
+	struct sampling_config
+	{
+		float       hot_threshold{ 1.0F }; // Use (%) from which a TID is read on every update
+		std::size_t period{ 8 };           // Updates over which the use of every cold TID is read once
+	};
+
+	// TIDs whose use a sampled source reads on an update: the hot ones, plus a round-robin share of the cold ones
+	struct sampling_plan
+	{
+		const std::unordered_set<pid_t> * hot{ nullptr };
+
+		std::size_t period{ 1 };
+		std::size_t phase{ 0 }; // Cold TIDs with pid % period == phase are read on this update
+
+		[[nodiscard]] auto due(const pid_t pid) const -> bool { return idx(pid) % period == phase; }
+
+		[[nodiscard]] auto sampled(const pid_t pid) const -> bool
+		{
+			return due(pid) or (hot != nullptr and hot->contains(pid));
+		}
+	};
+
+	// Decides which TIDs are read on each update, and how old the use of each TID is.
+	// The TIDs read at or above the threshold and the ones just migrated are hot: they are read on every update.
+	// The rest are read once every period updates, keeping their last use in between, so an update reads about
+	// hot + tasks / period TIDs instead of every task (plus the new ones, read as the source discovers them).
+	class hot_set_sampler
+	{
+	private:
+		sampling_config config_;
+
+		std::uint64_t tick_{ 0 };
+
+		std::unordered_set<pid_t> hot_;   // Read on the next update
+		std::unordered_set<pid_t> read_;  // Hot TIDs read on the current update (the plan)
+		std::unordered_set<pid_t> fresh_; // New TIDs of the current update
+
+		// input: TID, output: update of its last read, for the TIDs read out of their turn that are not hot anymore
+		std::unordered_map<pid_t, std::uint64_t> read_at_;
+
+	public:
+		explicit hot_set_sampler(const sampling_config config = {}) : config_(config)
+		{
+			if (config_.period == 0) { config_.period = 1; }
+		}
+
+		[[nodiscard]] auto config() const -> const sampling_config & { return config_; }
+
+		// Updates so far (since sampling was enabled)
+		[[nodiscard]] auto tick() const -> std::uint64_t { return tick_; }
+
+		// Starts a new update: the hot TIDs found by the last one are read on this one
+		void advance()
+		{
+			++tick_;
+
+			std::swap(read_, hot_);
+			hot_.clear();
+			fresh_.clear();
+
+			// Past a period, the round-robin read is always more recent
+			if (tick_ % config_.period == 0)
+			{
+				std::erase_if(read_at_, [&](const auto & read) { return tick_ - read.second >= config_.period; });
+			}
+		}
+
+		[[nodiscard]] auto plan() const -> sampling_plan
+		{
+			return { &read_, config_.period, static_cast<std::size_t>(tick_ % config_.period) };
+		}
+
+		// A new TID: the source reads it as it discovers it
+		void discovered(const pid_t pid) { fresh_.insert(pid); }
+
+		// A migrated TID: read on the next update, to see how it does on its new CPU
+		void migrated(const pid_t pid) { hot_.insert(pid); }
+
+		// The use of a TID read on the current update, which decides whether it is hot on the next one
+		void observe(const pid_t pid, const float use)
+		{
+			if (use >= config_.hot_threshold) { hot_.insert(pid); }
+			else if (not plan().due(pid)) { read_at_[pid] = tick_; }
+		}
+
+		// Calls f(pid) for each TID read out of its round-robin turn on the current update (hot or new)
+		template<typename F>
+		void for_each_out_of_turn(F && f) const
+		{
+			const auto current = plan();
+
+			for (const auto pid : read_)
+			{
+				if (not current.due(pid)) { f(pid); }
+			}
+
+			for (const auto pid : fresh_)
+			{
+				if (not current.due(pid) and not read_.contains(pid)) { f(pid); }
+			}
+		}
+
+		// Updates since the use of the TID was last read (0 = read on the current update)
+		[[nodiscard]] auto age(const pid_t pid) const -> std::uint64_t
+		{
+			if (read_.contains(pid) or fresh_.contains(pid)) { return 0; }
+
+			const auto period = config_.period;
+			const auto phase  = idx(pid) % period;
+
+			auto age = (tick_ % period + period - phase) % period;
+
+			if (const auto it = read_at_.find(pid); it != read_at_.end()) { age = std::min(age, tick_ - it->second); }
+
+			// Everything was read when sampling started
+			return std::min(age, tick_);
+		}
+
+		// TIDs that the next update reads on top of the round-robin ones
+		[[nodiscard]] auto hot() const -> const std::unordered_set<pid_t> & { return hot_; }
+	};
+} // namespace syssnap
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "procfs.hpp"
+
+namespace syssnap
+{
+	// Subset of the tasks managed by a snapshot. The tasks out of the scope are not kept in the maps nor get a load,
+	// but their usage is still added up per CPU (see snapshot::foreign_use()).
+	class scope
+	{
+	public:
+		enum class kind
+		{
+			everything, // Every task of the system
+			subtree,    // A task plus its children and threads, recursively
+			cgroup,     // Tasks in a cgroup (or any of its descendants)
+			user,       // Tasks whose effective UID is the given one
+			predicate   // Tasks for which a user function returns true
+		};
+
+	private:
+		kind kind_{ kind::everything };
+
+		pid_t root_{ 0 }; // Root of the subtree
+
+		std::function<bool(pid_t)> test_; // Test of the cgroup, user and predicate scopes
+
+		scope(const kind k, std::function<bool(pid_t)> test, const pid_t root = 0) :
+		    kind_(k), root_(root), test_(std::move(test))
+		{}
+
+		// The TID is in the cgroup, or in one of its descendants, in any hierarchy
+		[[nodiscard]] static auto in_cgroup(const pid_t pid, const std::string & path) -> bool
+		{
+			return std::ranges::any_of(procfs::cgroups_of(pid), [&](const procfs::cgroup_entry & cgroup) {
+				const std::string_view task_path = cgroup.path;
+				return path == "/" or task_path == path or
+				       (task_path.starts_with(path) and task_path.size() > path.size() and task_path[path.size()] == '/');
+			});
+		}
+
+	public:
+		scope() = default;
+
+		[[nodiscard]] static auto everything() -> scope { return {}; }
+
+		// The root task, its threads and its children (with their own threads and children...).
+		// The subtree is walked again on every update, so the tasks that join or leave it are followed.
+		[[nodiscard]] static auto subtree(const pid_t root) -> scope { return { kind::subtree, nullptr, root }; }
+
+		// Tasks in the cgroup with the given path (e.g. "/system.slice/nginx.service") or in any of its descendants.
+		// A task is checked once, when it first appears, so tasks moved to another cgroup keep their scope.
+		[[nodiscard]] static auto cgroup(std::string path) -> scope
+		{
+			while (path.size() > 1 and path.ends_with('/'))
+			{
+				path.pop_back();
+			}
+
+			return { kind::cgroup, [path = std::move(path)](const pid_t pid) { return in_cgroup(pid, path); } };
+		}
+
+		// Tasks whose effective UID is uid. A task is checked once, when it first appears.
+		[[nodiscard]] static auto user(const uid_t uid) -> scope
+		{
+			return { kind::user, [uid](const pid_t pid) { return procfs::effective_uid(pid) == uid; } };
+		}
+
+		// Tasks for which f(tid) is true. A task is checked once, when it first appears.
+		[[nodiscard]] static auto predicate(std::function<bool(pid_t)> f) -> scope
+		{
+			return { kind::predicate, std::move(f) };
+		}
+
+		[[nodiscard]] auto type() const -> kind { return kind_; }
+
+		[[nodiscard]] auto root() const -> pid_t { return root_; }
+
+		// Only for the cgroup, user and predicate scopes (the subtree depends on the process tree)
+		[[nodiscard]] auto test(const pid_t pid) const -> bool { return not test_ or test_(pid); }
+	};
+} // namespace syssnap
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <concepts>
+#include <string>
+
+#include "affinity.hpp"
+#include "bitset.hpp"
+#include "hierarchy.hpp"
+#include "locality.hpp"
+#include "memory.hpp"
+#include "sampling.hpp"
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Where the snapshot gets its tasks from (e.g. prox::process_tree, procfs_processes, synthetic_processes,
+	// replay_processes). Iterating the source yields the tasks, each one with pid(), processor(), numa_node() and
+	// cpu_use().
+	template<typename T>
+	concept process_source = requires(T & source, const T & csource, const pid_t pid) {
+		source.update();
+		{ csource.cpu_use(pid) } -> std::convertible_to<float>;
+		static_cast<bool>(csource.get(pid));
+	};
+
+	// Where the snapshot gets the CPUs and nodes of the system from (e.g. topology, synthetic_topology)
+	template<typename T>
+	concept topology_source = requires(const T & topo, const cpu_t cpu, const node_t node) {
+		topo.cpus();
+		topo.nodes();
+		topo.cpus_from_node(node);
+		{ topo.cpu_set() } -> std::convertible_to<const cpu_bitset &>;
+		{ topo.node_cpu_set(node) } -> std::convertible_to<const cpu_bitset &>;
+		{ topo.node_from_cpu(cpu) } -> std::convertible_to<node_t>;
+		{ topo.max_cpu() } -> std::convertible_to<cpu_t>;
+		{ topo.max_node() } -> std::convertible_to<node_t>;
+	};
+
+	// Topologies that also know the cores, caches and packages of the CPUs
+	template<typename T>
+	concept hierarchical_topology = topology_source<T> and requires(const T & topo) {
+		{ topo.hierarchy() } -> std::convertible_to<const cpu_hierarchy &>;
+	};
+
+	// Process sources that do not represent real tasks handle the affinity changes themselves.
+	// Returns 0 on success, errno otherwise.
+	template<typename T>
+	concept affinity_handler = requires(T & source, const pid_t pid, const cpu_mask & mask) {
+		{ source.set_affinity(pid, mask) } -> std::convertible_to<int>;
+	};
+
+	// Process sources that can read the use of some TIDs only (the rest keep their last use), for adaptive sampling.
+	// Discovery still covers every task: new TIDs are read as they appear.
+	template<typename T>
+	concept sampled_source = requires(T & source, const sampling_plan & plan) { source.update(plan); };
+
+	// Likewise for the memory of the tasks: where it lives, and moving up to a number of bytes of it to a node (the
+	// source remembers how far it got, until the step is done)
+	template<typename T>
+	concept memory_handler =
+	    requires(T & source, const T & csource, const pid_t pid, const node_t node, const std::uint64_t max_bytes) {
+		    { csource.numa_footprint(pid) } -> std::convertible_to<numa_footprint>;
+		    { source.migrate_memory(pid, node, max_bytes) } -> std::convertible_to<memory_step>;
+	};
+
+	// And for where their memory accesses go (the NUMA faults of each TID)
+	template<typename T>
+	concept locality_source = requires(const T & csource, const pid_t pid) {
+		{ csource.numa_faults(pid) } -> std::convertible_to<numa_faults>;
+	};
+
+	// And for the groups of the tasks: their thread group (TGID) and the path of their cgroup
+	template<typename T>
+	concept grouped_source = requires(const T & csource, const pid_t pid) {
+		{ csource.thread_group(pid) } -> std::convertible_to<pid_t>;
+		{ csource.cgroup(pid) } -> std::convertible_to<std::string>;
+	};
+
+	// And for the nice of the tasks, which the weighted load models read on every update
+	template<typename T>
+	concept niced_source = requires(const T & csource, const pid_t pid) {
+		{ csource.nice(pid) } -> std::convertible_to<int>;
+	};
+} // namespace syssnap
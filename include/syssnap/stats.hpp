@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace syssnap
+{
+	// What the snapshot measures on every update and commit
+	enum class metric
+	{
+		update,             // Duration of update() (ns): scan + rebuild + loads
+		scan,               // Duration of the update of the process source, i.e. reading procfs (ns)
+		rebuild,            // Duration of the rebuild of the maps (ns)
+		loads,              // Duration of the computation of the loads (ns)
+		commit,             // Duration of commit(): affinity calls plus the rescan or promotion (ns)
+		tasks,              // TIDs in the maps after the rebuild
+		hash_buckets,       // Buckets of the hash tables of the TIDs (placement and scope cache)
+		scope_cache,        // TIDs in the scope cache
+		rehashes,           // Hash tables that grew (rehashed) during the rebuild
+		reallocations,      // Per-CPU arrays that had to grow while computing the loads
+		migrations_applied, // Migrations applied by commit()
+		migrations_failed,  // Migrations that failed in commit() (vanished or denied)
+		memory_migrated,    // Bytes of memory moved by commit() along with the migrated threads
+		task_events,        // Forks, execs and exits applied by the update (event-driven tracking only)
+		samples,            // TIDs whose use was read by the update (adaptive sampling only)
+		locality            // TIDs whose NUMA locality was collected by the update (locality only)
+	};
+
+	inline constexpr std::size_t METRICS = 16;
+
+	[[nodiscard]] constexpr auto metric_index(const metric m) -> std::size_t { return static_cast<std::size_t>(m); }
+
+	// Samples of a metric: the last ones are kept for the percentiles, min and max cover every sample
+	class metric_series
+	{
+	private:
+		std::vector<double> ring_;
+		std::size_t         next_{ 0 }; // Position of the next sample in the ring
+		std::size_t         kept_{ 0 };
+		std::uint64_t       count_{ 0 };
+
+		double min_{ std::numeric_limits<double>::infinity() };
+		double max_{ -std::numeric_limits<double>::infinity() };
+
+	public:
+		explicit metric_series(const std::size_t window = 128) : ring_(std::max<std::size_t>(1, window)) {}
+
+		void record(const double value)
+		{
+			ring_[next_] = value;
+			next_        = (next_ + 1) % ring_.size();
+			kept_        = std::min(kept_ + 1, ring_.size());
+			++count_;
+
+			min_ = std::min(min_, value);
+			max_ = std::max(max_, value);
+		}
+
+		void clear() { *this = metric_series(ring_.size()); }
+
+		// Samples recorded so far
+		[[nodiscard]] auto count() const -> std::uint64_t { return count_; }
+
+		[[nodiscard]] auto empty() const -> bool { return count_ == 0; }
+
+		[[nodiscard]] auto last() const -> double
+		{
+			return empty() ? 0.0 : ring_[(next_ + ring_.size() - 1) % ring_.size()];
+		}
+
+		[[nodiscard]] auto min() const -> double { return empty() ? 0.0 : min_; }
+
+		[[nodiscard]] auto max() const -> double { return empty() ? 0.0 : max_; }
+
+		// Mean of the samples in the window
+		[[nodiscard]] auto mean() const -> double
+		{
+			if (empty()) { return 0.0; }
+
+			auto total = 0.0;
+			for (std::size_t i = 0; i < kept_; ++i)
+			{
+				total += ring_[i];
+			}
+			return total / static_cast<double>(kept_);
+		}
+
+		// Nearest-rank percentile (0-100) of the samples in the window
+		[[nodiscard]] auto percentile(const double p) const -> double
+		{
+			if (empty()) { return 0.0; }
+
+			std::vector<double> sorted(ring_.begin(), ring_.begin() + static_cast<std::ptrdiff_t>(kept_));
+
+			const auto rank = static_cast<std::size_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 *
+			                                                     static_cast<double>(kept_)));
+			const auto nth  = sorted.begin() + static_cast<std::ptrdiff_t>(std::max<std::size_t>(rank, 1) - 1);
+
+			std::ranges::nth_element(sorted, nth);
+			return *nth;
+		}
+	};
+
+	// Instrumentation of the snapshot: the duration of each phase and the counters of each update, as series
+	class snapshot_stats
+	{
+	private:
+		std::array<metric_series, METRICS> series_;
+
+		// Reallocations noticed by the workers of the parallel computation of the loads, until the next update
+		std::atomic<std::uint64_t> reallocations_{ 0 };
+
+	public:
+		using time_point = std::chrono::steady_clock::time_point;
+
+		explicit snapshot_stats(const std::size_t window = 128)
+		{
+			series_.fill(metric_series(window));
+		}
+
+		// Copyable despite the atomic counter, so that the snapshot stays copyable
+		snapshot_stats(const snapshot_stats & other) :
+		    series_(other.series_), reallocations_(other.reallocations_.load())
+		{}
+
+		auto operator=(const snapshot_stats & other) -> snapshot_stats &
+		{
+			series_ = other.series_;
+			reallocations_.store(other.reallocations_.load());
+			return *this;
+		}
+
+		~snapshot_stats() = default;
+
+		[[nodiscard]] static auto start() -> time_point { return std::chrono::steady_clock::now(); }
+
+		// Records the time elapsed since start, in ns
+		void stop(const metric m, const time_point start)
+		{
+			record(m, static_cast<double>(std::chrono::nanoseconds(std::chrono::steady_clock::now() - start).count()));
+		}
+
+		void record(const metric m, const double value) { series_.at(metric_index(m)).record(value); }
+
+		// Safe to call from several threads at once
+		void add_reallocation() { reallocations_.fetch_add(1, std::memory_order_relaxed); }
+
+		// Reallocations noticed since the last call
+		auto take_reallocations() -> std::uint64_t { return reallocations_.exchange(0, std::memory_order_relaxed); }
+
+		[[nodiscard]] auto of(const metric m) const -> const metric_series & { return series_.at(metric_index(m)); }
+
+		void clear()
+		{
+			for (auto & series : series_)
+			{
+				series.clear();
+			}
+		}
+	};
+
+	// No instrumentation at all: every call compiles down to nothing
+	struct no_stats
+	{
+		struct time_point
+		{};
+
+		[[nodiscard]] static auto start() -> time_point { return {}; }
+
+		void stop(const metric /*m*/, const time_point /*start*/) {}
+
+		void record(const metric /*m*/, const double /*value*/) {}
+
+		void add_reallocation() {}
+
+		auto take_reallocations() -> std::uint64_t { return 0; }
+	};
+
+	// What the snapshot needs from its instrumentation (snapshot_stats or no_stats)
+	template<typename T>
+	concept snapshot_instrumentation = requires(T & stats, const metric m, const typename T::time_point start) {
+		{ T::start() } -> std::convertible_to<typename T::time_point>;
+		stats.stop(m, start);
+		stats.record(m, 0.0);
+		stats.add_reallocation();
+		{ stats.take_reallocations() } -> std::convertible_to<std::uint64_t>;
+	};
+} // namespace syssnap
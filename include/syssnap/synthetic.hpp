@@ -0,0 +1,454 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "affinity.hpp"
+#include "bitset.hpp"
+#include "hierarchy.hpp"
+#include "locality.hpp"
+#include "memory.hpp"
+#include "sampling.hpp"
+#include "types.hpp"
+
+namespace syssnap
+{
+	// Topology given by the node of each CPU, instead of detected from the running system.
+	// Useful to reproduce machines other than the one running the code (e.g. 1024 CPUs on a laptop).
+	class synthetic_topology
+	{
+	private:
+		static constexpr int LOCAL_DISTANCE  = 10;
+		static constexpr int REMOTE_DISTANCE = 20;
+
+		std::vector<node_t> nodes_;
+		std::vector<cpu_t>  cpus_;
+
+		std::vector<std::vector<node_t>> nodes_by_distance_; // Contains the list of nodes sorted by distance
+
+		std::vector<node_t>             cpu_node_map_; // input: CPU,  output: node
+		std::vector<std::vector<cpu_t>> node_cpu_map_; // input: node, output: list of CPUs
+
+		cpu_bitset              cpu_set_;      // all the CPUs
+		std::vector<cpu_bitset> node_cpu_set_; // input: node, output: set of CPUs
+
+		cpu_hierarchy hierarchy_;
+
+	public:
+		// CPUs are numbered 0..N-1, and cpu_node_map[cpu] is the node of each one.
+		// Each CPU is a core of its own, and the CPUs of each node share the L3 and the package.
+		explicit synthetic_topology(std::vector<node_t> cpu_node_map) : cpu_node_map_(std::move(cpu_node_map))
+		{
+			if (cpu_node_map_.empty()) { throw std::invalid_argument("A topology needs at least one CPU"); }
+
+			const auto size_nodes = idx(*std::ranges::max_element(cpu_node_map_)) + 1;
+
+			node_cpu_map_.resize(size_nodes);
+			node_cpu_set_.resize(size_nodes);
+			for (std::size_t cpu = 0; cpu < cpu_node_map_.size(); ++cpu)
+			{
+				cpus_.emplace_back(static_cast<cpu_t>(cpu));
+				cpu_set_.insert(static_cast<cpu_t>(cpu));
+				node_cpu_map_.at(idx(cpu_node_map_[cpu])).emplace_back(static_cast<cpu_t>(cpu));
+				node_cpu_set_.at(idx(cpu_node_map_[cpu])).insert(static_cast<cpu_t>(cpu));
+			}
+
+			for (std::size_t node = 0; node < size_nodes; ++node)
+			{
+				if (not node_cpu_map_[node].empty()) { nodes_.emplace_back(static_cast<node_t>(node)); }
+			}
+
+			// All the remote nodes are at the same distance, so each node is followed by the rest in order
+			nodes_by_distance_.resize(size_nodes);
+			for (const auto node : nodes_)
+			{
+				auto & by_distance = nodes_by_distance_.at(idx(node));
+				by_distance.emplace_back(node);
+				std::ranges::copy_if(nodes_, std::back_inserter(by_distance), [&](const auto n) { return n != node; });
+			}
+
+			hierarchy_ = cpu_hierarchy::regular(cpu_node_map_);
+		}
+
+		// CPUs split in consecutive blocks across the nodes
+		synthetic_topology(const std::size_t cpus, const std::size_t nodes) :
+		    synthetic_topology([&] {
+			    if (nodes == 0) { throw std::invalid_argument("A topology needs at least one node"); }
+
+			    std::vector<node_t> cpu_node_map(cpus);
+			    for (std::size_t cpu = 0; cpu < cpus; ++cpu)
+			    {
+				    cpu_node_map[cpu] = static_cast<node_t>(cpu * nodes / cpus);
+			    }
+			    return cpu_node_map;
+		    }())
+		{}
+
+		// Same, with threads_per_core SMT siblings per core and cores_per_llc cores per L3
+		synthetic_topology(const std::size_t cpus, const std::size_t nodes, const std::size_t threads_per_core,
+		                   const std::size_t cores_per_llc) :
+		    synthetic_topology(cpus, nodes)
+		{
+			hierarchy_ = cpu_hierarchy::regular(cpu_node_map_, threads_per_core, cores_per_llc);
+		}
+
+		[[nodiscard]] auto max_node() const -> node_t { return nodes_.back(); }
+
+		[[nodiscard]] auto max_cpu() const -> cpu_t { return cpus_.back(); }
+
+		[[nodiscard]] auto num_of_cpus() const -> size_t { return cpus_.size(); }
+
+		[[nodiscard]] auto num_of_nodes() const -> size_t { return nodes_.size(); }
+
+		[[nodiscard]] auto cpus() const -> const std::vector<cpu_t> & { return cpus_; }
+
+		[[nodiscard]] auto nodes() const -> const std::vector<node_t> & { return nodes_; }
+
+		[[nodiscard]] auto node_cpu_map() const -> const std::vector<std::vector<cpu_t>> & { return node_cpu_map_; }
+
+		[[nodiscard]] auto cpu_node_map() const -> const std::vector<node_t> & { return cpu_node_map_; }
+
+		[[nodiscard]] auto nodes_by_distance() const -> const std::vector<std::vector<node_t>> &
+		{
+			return nodes_by_distance_;
+		}
+
+		[[nodiscard]] auto nodes_by_distance(const node_t node) const -> const std::vector<node_t> &
+		{
+			return nodes_by_distance_.at(idx(node));
+		}
+
+		[[nodiscard]] static auto node_distance(const node_t node_1, const node_t node_2) -> int
+		{
+			return node_1 == node_2 ? LOCAL_DISTANCE : REMOTE_DISTANCE;
+		}
+
+		[[nodiscard]] auto cpus_from_node(const node_t node) const -> const std::vector<cpu_t> &
+		{
+			return node_cpu_map_.at(idx(node));
+		}
+
+		[[nodiscard]] auto node_from_cpu(const cpu_t cpu) const -> node_t { return cpu_node_map_.at(idx(cpu)); }
+
+		[[nodiscard]] auto cpu_set() const -> const cpu_bitset & { return cpu_set_; }
+
+		[[nodiscard]] auto node_cpu_set(const node_t node) const -> const cpu_bitset &
+		{
+			return node_cpu_set_.at(idx(node));
+		}
+
+		[[nodiscard]] auto hierarchy() const -> const cpu_hierarchy & { return hierarchy_; }
+	};
+
+	enum class usage_distribution
+	{
+		idle,        // Every task at 0%
+		uniform,     // Uniform between 0% and 2 * mean_use
+		exponential, // Exponential with mean mean_use (few busy tasks, many almost idle ones)
+		bimodal      // A busy_fraction of the tasks near 100%, the rest near 0%
+	};
+
+	struct synthetic_config
+	{
+		std::size_t        tasks{ 1'000 };
+		usage_distribution usage{ usage_distribution::exponential };
+		float              mean_use{ 5.0F };          // Mean CPU use (%) of the uniform and exponential distributions
+		float              busy_fraction{ 0.1F };     // Fraction of busy tasks of the bimodal distribution
+		float              moves_per_update{ 0.01F }; // Fraction of the tasks that change their CPU on each update
+		float              churn_per_update{ 0.0F };  // Fraction of the tasks that exit (and are replaced) on each update
+		std::uint64_t      seed{ 42 };                // NOLINT
+
+		// Resident memory of each task, all on the node where it spawned
+		std::uint64_t memory_per_task{ 64ULL << 20U }; // NOLINT
+
+		// The tasks form processes of consecutive TIDs, spread round-robin over the cgroups
+		std::size_t threads_per_process{ 1 };
+		std::size_t cgroups{ 1 };
+
+		// Nice of the tasks, spread by TID between -nice_spread and nice_spread
+		int nice_spread{ 0 };
+	};
+
+	// In-memory process source: N tasks spread over the CPUs of a synthetic_topology, with random usages.
+	// Every update() draws new usages and moves/replaces some tasks, deterministically for a given seed.
+	class synthetic_processes
+	{
+	public:
+		class task
+		{
+			friend class synthetic_processes;
+
+		private:
+			pid_t  pid_{};
+			cpu_t  processor_{};
+			node_t numa_node_{};
+			node_t memory_node_{}; // Where its memory lives: it does not follow the moves, only migrate_memory()
+			float  cpu_use_{};
+			bool   pinned_{ false };
+
+		public:
+			[[nodiscard]] auto pid() const { return pid_; }
+
+			[[nodiscard]] auto processor() const { return processor_; }
+
+			[[nodiscard]] auto numa_node() const { return numa_node_; }
+
+			[[nodiscard]] auto cpu_use() const { return cpu_use_; }
+		};
+
+	private:
+		std::vector<node_t> cpu_node_map_; // input: CPU, output: node
+		std::vector<cpu_t>  cpus_;
+
+		synthetic_config config_;
+
+		std::mt19937_64 gen_;
+
+		std::vector<task>                      tasks_;
+		std::unordered_map<pid_t, std::size_t> index_; // input: TID, output: position in tasks_
+
+		// input: TID, output: memory of the tasks that migrate_memory() left spread over several nodes
+		std::unordered_map<pid_t, syssnap::numa_footprint> split_memory_;
+
+		pid_t next_pid_{ 1 };
+
+		std::uint64_t reads_{ 0 }; // Usages drawn so far
+
+		[[nodiscard]] auto random_cpu() -> cpu_t
+		{
+			std::uniform_int_distribution<std::size_t> dist{ 0, cpus_.size() - 1 };
+			return cpus_[dist(gen_)];
+		}
+
+		[[nodiscard]] auto random_use() -> float
+		{
+			++reads_;
+
+			switch (config_.usage)
+			{
+				case usage_distribution::idle: return 0.0F;
+				case usage_distribution::uniform:
+					return std::uniform_real_distribution<float>{ 0.0F, 2.0F * config_.mean_use }(gen_);
+				case usage_distribution::exponential:
+					return std::min(100.0F, std::exponential_distribution<float>{ 1.0F / config_.mean_use }(gen_));
+				case usage_distribution::bimodal:
+					if (std::bernoulli_distribution{ config_.busy_fraction }(gen_))
+					{
+						return std::uniform_real_distribution<float>{ 80.0F, 100.0F }(gen_);
+					}
+					return std::uniform_real_distribution<float>{ 0.0F, 1.0F }(gen_);
+			}
+			return 0.0F;
+		}
+
+		void place(task & t, const cpu_t cpu)
+		{
+			t.processor_ = cpu;
+			t.numa_node_ = cpu_node_map_.at(idx(cpu));
+		}
+
+		void spawn(task & t)
+		{
+			t          = task{};
+			t.pid_     = next_pid_++;
+			t.cpu_use_ = random_use();
+			place(t, random_cpu());
+			t.memory_node_ = t.numa_node_;
+		}
+
+		// Draws a new use for the tasks for which sampled(pid) is true
+		void update_tasks(const auto & sampled)
+		{
+			std::bernoulli_distribution move{ config_.moves_per_update };
+			std::bernoulli_distribution churn{ config_.churn_per_update };
+
+			for (std::size_t i = 0; i < tasks_.size(); ++i)
+			{
+				auto & t = tasks_[i];
+
+				if (config_.churn_per_update > 0.0F and churn(gen_))
+				{
+					index_.erase(t.pid_);
+					split_memory_.erase(t.pid_);
+					spawn(t);
+					index_.emplace(t.pid_, i);
+					continue;
+				}
+
+				if (sampled(t.pid_)) { t.cpu_use_ = random_use(); }
+
+				if (not t.pinned_ and config_.moves_per_update > 0.0F and move(gen_)) { place(t, random_cpu()); }
+			}
+		}
+
+	public:
+		template<typename Topology>
+		synthetic_processes(const Topology & topo, const synthetic_config config) :
+		    cpus_(topo.cpus().begin(), topo.cpus().end()), config_(config), gen_(config.seed)
+		{
+			cpu_node_map_.resize(idx(topo.max_cpu()) + 1, 0);
+			for (const auto cpu : cpus_)
+			{
+				cpu_node_map_.at(idx(cpu)) = topo.node_from_cpu(cpu);
+			}
+
+			tasks_.resize(config_.tasks);
+			index_.reserve(config_.tasks);
+			for (std::size_t i = 0; i < tasks_.size(); ++i)
+			{
+				spawn(tasks_[i]);
+				index_.emplace(tasks_[i].pid_, i);
+			}
+		}
+
+		void update()
+		{
+			update_tasks([](const pid_t /*pid*/) { return true; });
+		}
+
+		// Only the tasks of the plan draw a new use, the rest keep theirs
+		void update(const sampling_plan & plan)
+		{
+			update_tasks([&](const pid_t pid) { return plan.sampled(pid); });
+		}
+
+		// Usages drawn so far: what a procfs source would have read
+		[[nodiscard]] auto reads() const -> std::uint64_t { return reads_; }
+
+		[[nodiscard]] auto begin() const { return tasks_.begin(); }
+
+		[[nodiscard]] auto end() const { return tasks_.end(); }
+
+		[[nodiscard]] auto size() const { return tasks_.size(); }
+
+		[[nodiscard]] auto get(const pid_t pid) const -> const task *
+		{
+			const auto it = index_.find(pid);
+			return it == index_.end() ? nullptr : &tasks_[it->second];
+		}
+
+		[[nodiscard]] auto find(const pid_t pid) const -> const task & { return tasks_.at(index_.at(pid)); }
+
+		[[nodiscard]] auto cpu_use(const pid_t pid) const -> float
+		{
+			const auto * t = get(pid);
+			return t == nullptr ? 0.0F : t->cpu_use();
+		}
+
+		// Pinned tasks move to the first CPU of the mask, and stay there until unpinned
+		[[nodiscard]] auto set_affinity(const pid_t pid, const cpu_mask & mask) -> int
+		{
+			const auto it = index_.find(pid);
+			if (it == index_.end()) { return ESRCH; }
+
+			const auto cpu = std::ranges::find_if(cpus_, [&](const auto c) { return mask.contains(c); });
+			if (cpu == cpus_.end()) { return EINVAL; }
+
+			auto & t = tasks_[it->second];
+			place(t, *cpu);
+			t.pinned_ = true;
+
+			return 0;
+		}
+
+		[[nodiscard]] auto numa_footprint(const pid_t pid) const -> syssnap::numa_footprint
+		{
+			if (const auto it = split_memory_.find(pid); it != split_memory_.end()) { return it->second; }
+
+			syssnap::numa_footprint footprint;
+			if (const auto * t = get(pid); t != nullptr) { footprint.add(t->memory_node_, config_.memory_per_task); }
+			return footprint;
+		}
+
+		// Moves up to max_bytes of the memory of the task to the node (at least a byte); done once it all is there
+		[[nodiscard]] auto migrate_memory(const pid_t pid, const node_t node, const std::uint64_t max_bytes)
+		    -> memory_step
+		{
+			const auto it = index_.find(pid);
+			if (it == index_.end()) { return { 0, ESRCH, true }; }
+
+			const auto before = numa_footprint(pid);
+			const auto budget = std::max<std::uint64_t>(max_bytes, 1);
+
+			syssnap::numa_footprint after;
+			after.add(node, before.bytes_on(node));
+
+			std::uint64_t moved = 0;
+			for (std::size_t n = 0; n < before.size(); ++n)
+			{
+				const auto from = static_cast<node_t>(n);
+				if (from == node) { continue; }
+
+				const auto bytes = before.bytes_on(from);
+				const auto taken = std::min(bytes, budget - moved);
+
+				moved += taken;
+				after.add(node, taken);
+				after.add(from, bytes - taken);
+			}
+
+			const auto done = after.bytes_off(node) == 0;
+			if (done)
+			{
+				tasks_[it->second].memory_node_ = node;
+				split_memory_.erase(pid);
+			}
+			else { split_memory_.insert_or_assign(pid, std::move(after)); }
+
+			return { moved, 0, done };
+		}
+
+		// First TID of the block of threads_per_process TIDs of the task (the TIDs start at 1)
+		[[nodiscard]] auto thread_group(const pid_t pid) const -> pid_t
+		{
+			const auto threads = static_cast<pid_t>(std::max<std::size_t>(config_.threads_per_process, 1));
+			return pid - (pid - 1) % threads;
+		}
+
+		[[nodiscard]] auto cgroup(const pid_t pid) const -> std::string
+		{
+			return "/synthetic/" + std::to_string(idx(thread_group(pid)) % std::max<std::size_t>(config_.cgroups, 1));
+		}
+
+		[[nodiscard]] auto nice(const pid_t pid) const -> int
+		{
+			const auto levels = 2 * std::clamp(config_.nice_spread, 0, 20) + 1; // NOLINT: nice is within [-20, 19]
+			return std::min(pid % levels - levels / 2, 19);                    // NOLINT
+		}
+
+		// Every access of a task goes to its memory: one fault per 0.1% of use, all on the node of its memory
+		[[nodiscard]] auto numa_faults(const pid_t pid) const -> syssnap::numa_faults
+		{
+			syssnap::numa_faults faults;
+			if (const auto * t = get(pid); t != nullptr)
+			{
+				faults.per_node.resize(idx(t->memory_node_) + 1, 0);
+				faults.per_node[idx(t->memory_node_)] = static_cast<std::uint64_t>(t->cpu_use_ * 10.0F); // NOLINT
+				faults.preferred_node                 = t->memory_node_;
+			}
+			return faults;
+		}
+
+		void unpin(const pid_t pid)
+		{
+			if (const auto it = index_.find(pid); it != index_.end()) { tasks_[it->second].pinned_ = false; }
+		}
+
+		void unpin()
+		{
+			for (auto & t : tasks_)
+			{
+				t.pinned_ = false;
+			}
+		}
+	};
+} // namespace syssnap
@@ -1,390 +1,1815 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include <fmt/format.h>
+
 #include <range/v3/all.hpp>
 
 #include <prox/prox.hpp>
 
+#include "affinity.hpp"
+#include "commit.hpp"
+#include "groups.hpp"
+#include "history.hpp"
+#include "load.hpp"
+#include "load_index.hpp"
+#include "load_models.hpp"
+#include "locality.hpp"
+#include "membership.hpp"
+#include "memory.hpp"
+#include "proc_events.hpp"
+#include "procfs.hpp"
+#include "procfs_processes.hpp"
+#include "published.hpp"
+#include "sampling.hpp"
+#include "scope.hpp"
+#include "sources.hpp"
+#include "stats.hpp"
+#include "thread_pool.hpp"
 #include "topology.hpp"
 #include "types.hpp"
 
 namespace syssnap
 {
-	class snapshot
+	// How the maps are refreshed after the process tree has been updated
+	enum class rebuild_policy
 	{
-		template<typename... args>
-		using fast_uset = std::unordered_set<args...>;
+		incremental, // Only touch the TIDs that appeared, exited or changed their CPU/node
+		full         // Discard the maps and insert every TID again
+	};
+
+	// What the snapshot becomes after the migrations have been applied
+	enum class commit_policy
+	{
+		rescan, // Read the process tree again (full update)
+		promote // Promote the dirty state to the committed one, and leave the next procfs scan to update()
+	};
 
+	// Snapshot of where every task runs and how much load it puts on its CPU/node.
+	// The tasks and the topology come from the live system by default, but any other source can be plugged in
+	// (e.g. synthetic_processes and synthetic_topology, to reproduce large machines deterministically).
+	// Stats measures each phase of the updates and commits (see snapshot_stats); no_stats compiles it out.
+	// Load turns the use of the TIDs of each CPU into their loads (sigmoid_load, linear_load, nice_weighted_load or
+	// decayed_load, see load_model).
+	template<process_source Processes = prox::process_tree, topology_source Topology = topology,
+	         snapshot_instrumentation Stats = snapshot_stats, load_model Load = sigmoid_load>
+	class basic_snapshot
+	{
 		template<typename... args>
 		using fast_umap = std::unordered_map<args...>;
 
 	private:
-		topology topology_{};
+		Topology topology_{};
+
+		Processes processes_{};
 
-		prox::process_tree processes_{};
+		// Tasks managed by the snapshot. The rest are skipped, and only add up to the foreign use of their CPU
+		scope scope_{};
+
+		fast_umap<pid_t, bool> scope_cache_; // input: TID, output: in the scope (cgroup, user and predicate scopes)
+		std::size_t            scope_cache_pruned_size_{ 0 };
+
+		std::unordered_set<pid_t> subtree_; // TIDs of the subtree scope, walked again on every untracked rebuild
+
+		std::vector<float> foreign_cpu_use_; // input: CPU, output: use of the tasks out of the scope
+
+		// Where each TID is, and its slot in the membership lists
+		struct placement
+		{
+			cpu_t  cpu{};
+			node_t node{};
+			slot_t cpu_slot{};
+			slot_t node_slot{};
+		};
 
 		// To know where each PID is (in terms of CPUs and node)
-		std::vector<fast_uset<pid_t>> cpu_pid_map_;  // input: CPU,  output: list of TIDs
-		std::vector<fast_uset<pid_t>> node_pid_map_; // input: node, output: list of TIDs
+		membership cpu_pid_map_;  // input: CPU,  output: list of TIDs
+		membership node_pid_map_; // input: node, output: list of TIDs
 
 		// Cache of the CPU and node of each PID
-		fast_umap<pid_t, cpu_t>  pid_cpu_map_;  // input: TID, output: CPU
-		fast_umap<pid_t, node_t> pid_node_map_; // input: TID, output: node
+		fast_umap<pid_t, placement> pid_placement_map_; // input: TID, output: CPU, node and slots
+
+		// Use and load of each PID, stored in the same order as cpu_pid_map_
+		std::vector<std::vector<float>> cpu_pid_use_;  // input: CPU, output: use of each TID in the CPU
+		std::vector<std::vector<float>> cpu_pid_load_; // input: CPU, output: load of each TID in the CPU
+
+		// Weight of the nice of each TID, in the same order (weighted load models only)
+		std::vector<std::vector<float>> cpu_pid_weight_; // input: CPU, output: weight of each TID in the CPU
+
+		Load model_{};
 
-		// Load of each PID
-		fast_umap<pid_t, float> pid_load_map_; // input: TID, output: load
+		// Aggregated loads, computed along with the load of each TID
+		std::vector<float> cpu_load_;  // input: CPU,  output: load
+		std::vector<float> node_load_; // input: node, output: load
+		float              system_load_{ 0.0F };
 
 		std::vector<float> cpu_use_;  // input: CPU,  output: use
 		std::vector<float> node_use_; // input: node, output: use
 
+		// Aggregates of the cores, caches and packages (only for topologies that know them)
+		std::array<std::vector<float>, DOMAIN_LEVELS> domain_use_;  // input: level, domain, output: use
+		std::array<std::vector<float>, DOMAIN_LEVELS> domain_load_; // input: level, domain, output: load
+
 		mutable bool dirty_{ false };
 
-		// To know where each PID is (in terms of CPUs and node)
-		std::vector<fast_uset<pid_t>> dirty_cpu_pid_map_;  // input: CPU,  output: list of TIDs
-		std::vector<fast_uset<pid_t>> dirty_node_pid_map_; // input: node, output: list of TIDs
+		// Copy-on-write overlay over the committed state: only the migrated TIDs are stored here,
+		// everything else falls back to the committed maps
+		fast_umap<pid_t, cpu_t>  dirty_pid_cpu_map_;  // input: TID,  output: CPU (only migrated TIDs)
+		fast_umap<pid_t, node_t> dirty_pid_node_map_; // input: TID,  output: node (only migrated TIDs)
 
-		// Cache of the CPU and node of each PID
-		fast_umap<pid_t, cpu_t>  dirty_pid_cpu_map_;  // input: TID,  output: CPU
-		fast_umap<pid_t, node_t> dirty_pid_node_map_; // input: TID,  output: node
+		fast_umap<cpu_t, float>  dirty_cpu_use_;  // input: CPU,  output: use delta w.r.t. cpu_use_
+		fast_umap<node_t, float> dirty_node_use_; // input: node, output: use delta w.r.t. node_use_
+
+		fast_umap<cpu_t, float>  dirty_cpu_load_;  // input: CPU,  output: load delta w.r.t. cpu_load_
+		fast_umap<node_t, float> dirty_node_load_; // input: node, output: load delta w.r.t. node_load_
 
-		std::vector<float> dirty_cpu_use_;  // input: CPU,  output: use
-		std::vector<float> dirty_node_use_; // input: node, output: use
+		// CPUs of each node by load after the (uncommitted) migrations, kept up to date by every migration
+		cpu_load_index least_loaded_;
 
 		fast_umap<pid_t, cpu_t>  cpu_migrations_;  // input: PID, output: destination CPU
 		fast_umap<pid_t, node_t> node_migrations_; // input: PID, output: destination node
 
-		template<typename Map>
-		void compute_load_sigmoid(const Map & pid_usage_map)
+		// Optional migration of the memory of the TIDs moved to another node (none = only their threads move)
+		std::optional<memory_migration_config> memory_migration_;
+
+		// Process whose memory is queued (its thread group, unless the source moves the memory of each TID), and the
+		// first page not visited yet (0 = not started)
+		struct pending_memory
 		{
-			static const auto load = [](const float cpu_use, const float slice) {
-				return std::min(1.0F, cpu_use / slice);
-			};
+			pid_t          pid{};
+			node_t         node{};
+			std::uintptr_t resume{ 0 };
+		};
 
-			// S-shape function between 0 and 1
-			static const auto weight = [](const float x) {
-				// If x ~ 0, return 0
-				if (x < std::numeric_limits<decltype(x)>::epsilon()) { return 0.0F; }
-				// If x ~ 1, return 1
-				if (x > 1.0F - std::numeric_limits<decltype(x)>::epsilon()) { return 1.0F; }
-				// Else, compute the function
-				constexpr auto beta = 3.0F;
-				return 1.0F / (1.0F + std::pow((x / (1.0F - x)), -beta));
-			};
+		std::deque<pending_memory>             memory_migrations_; // Page migrations left for the next commits
+		std::unordered_set<pid_t>              memory_queued_;     // Processes in memory_migrations_
 
-			// Generate a vector of 101 values such that v[i] = s_shape(i / 100);
-			static const auto weight_table = []() {
-				std::array<float, 101> table{};
+		// Optional history of the use of each TID and CPU over the last updates (none = only the last use)
+		std::optional<usage_history> history_;
 
-				for (size_t i = 0; i < table.size(); i++)
-				{
-					table.at(i) = weight(static_cast<float>(i) / 100.0F);
-				}
+		// Optional channel where a copy of the committed state is published after every update and commit
+		std::shared_ptr<version_channel> channel_;
 
-				return table;
-			}();
+		// Optional pool to rebuild the maps and compute the loads in parallel (none = sequential)
+		std::shared_ptr<thread_pool> pool_;
 
-			const auto free_cpu_use =
-			    std::clamp(100.0F - ranges::accumulate(pid_usage_map | ranges::views::values, 0.0F), 0.0F, 100.0F);
-			const auto max_cpu_use = ranges::max(pid_usage_map | ranges::views::values);
+		// Optional subscription to the forks, execs and exits of the kernel (none = membership from the scans only).
+		// Shared by the copies of the snapshot, so only one of them should update.
+		std::shared_ptr<proc_events> proc_events_;
 
-			const auto cpu_index = static_cast<int>(std::round(free_cpu_use));
+		// Events since the last update. While they are complete (tracked), the membership of the maps, the subtree and
+		// the scope cache follow them instead of being swept on every rebuild.
+		task_events task_events_;
+		bool        events_tracked_{ false };
 
-			const auto alpha = weight_table.at(idx(cpu_index));
-			const auto beta  = 1 - alpha;
+		// Optional adaptive sampling: only the hot TIDs are read on every update (none = every TID on every update)
+		std::optional<hot_set_sampler> sampler_;
 
-			for (const auto & [pid, cpu_use] : pid_usage_map)
-			{
-				const auto load_vs_free = load(cpu_use, free_cpu_use);
-				const auto load_vs_max  = load(cpu_use, max_cpu_use);
+		// Optional NUMA locality of the busy TIDs, collected on every update (none = not collected)
+		std::optional<locality_config>  locality_config_;
+		fast_umap<pid_t, task_locality> locality_; // input: TID, output: its faults and the memory of its process
 
-				const auto pid_load = alpha * load_vs_free + beta * load_vs_max;
+		numa_counters numa_counters_; // NUMA counters of the system as of the last update
+		numa_counters numa_activity_; // Their growth between the last two updates
 
-				pid_load_map_[pid] = pid_load;
-			}
-		}
+		// Optional aggregates of each process and cgroup, computed along with the loads and kept up to date by the
+		// migrations (none = per-TID maps only)
+		std::optional<grouping_config> grouping_;
 
-		void compute_loads(const cpu_t cpu)
+		struct group_ids
 		{
-			const auto & pids = cpu_pid_map_.at(idx(cpu));
+			pid_t         process{};
+			std::uint32_t cgroup{};
+		};
 
-			auto pid_usage_map = pids | ranges::views::transform([&](const auto pid) {
-				                     return std::pair<pid_t, float>{ pid, processes_.cpu_use(pid) };
-			                     });
+		fast_umap<pid_t, group_ids> group_cache_; // input: TID, output: its process and cgroup (read once per TID)
+		std::size_t                 group_cache_pruned_size_{ 0 };
 
-			compute_load_sigmoid(pid_usage_map);
-		}
+		// input: cgroup path, output: its ID (the cgroups of the cached TIDs, pruned along with the cache)
+		fast_umap<std::string, std::uint32_t> cgroup_ids_;
+		std::uint32_t                         next_cgroup_id_{ 0 };
+
+		fast_umap<pid_t, task_group>         thread_groups_; // input: TGID, output: aggregates of its managed TIDs
+		fast_umap<std::uint32_t, task_group> cgroups_;       // input: cgroup ID, output: aggregates of its managed TIDs
+
+		[[no_unique_address]] Stats stats_{};
 
-		void compute_loads()
+		// TID as read from the process tree, used to shard the parallel rebuild
+		struct task_sample
 		{
-			for (const auto cpu : topology_.cpus())
+			pid_t  pid{};
+			cpu_t  cpu{};
+			node_t node{};
+			float  cpu_use{};
+		};
+
+		// Work of each shard of the parallel rebuild
+		struct rebuild_shard
+		{
+			std::vector<float>       cpu_use;  // input: CPU,  output: use of the TIDs of the shard
+			std::vector<float>       node_use; // input: node, output: use of the TIDs of the shard
+			std::vector<task_sample> changes;  // TIDs that appeared or changed their CPU/node
+		};
+
+		std::vector<task_sample>   samples_;
+		std::vector<rebuild_shard> shards_;
+
+		// Calls f(i) for every i in [0, n), in the pool if there is one
+		template<typename F>
+		void for_each_index(const std::size_t n, F && f)
+		{
+			if (pool_) { pool_->parallel_for(n, f); }
+			else
 			{
-				compute_loads(cpu);
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					f(i);
+				}
 			}
 		}
 
-		void rebuild()
+		// Task behind the handle returned by processes_.get() (prox returns a reference to a shared_ptr)
+		[[nodiscard]] static auto task_of(const auto & handle) -> const auto &
 		{
-			// Reset variables
-			ranges::fill(cpu_pid_map_, fast_uset<pid_t>{});
-			ranges::fill(node_pid_map_, fast_uset<pid_t>{});
-
-			pid_cpu_map_.clear();
-			pid_node_map_.clear();
+			if constexpr (requires { *handle->get(); }) { return *handle->get(); }
+			else { return *handle; }
+		}
 
-			ranges::fill(cpu_use_, 0.0F);
-			ranges::fill(node_use_, 0.0F);
+		// Walks the subtree of the scope in the current process tree.
+		// Sources whose tasks do not know their children only have the root in the subtree.
+		void refresh_subtree()
+		{
+			subtree_.clear();
+			if (scope_.type() != scope::kind::subtree) { return; }
 
-			// Build the maps
-			for (const auto & proc : processes_)
+			std::vector<pid_t> pending{ scope_.root() };
+			while (not pending.empty())
 			{
-				const auto pid  = proc.pid();
-				const auto cpu  = proc.processor();
-				const auto node = proc.numa_node();
+				const auto pid = pending.back();
+				pending.pop_back();
 
-				cpu_pid_map_.at(idx(cpu)).insert(pid);
-				node_pid_map_.at(idx(node)).insert(pid);
+				const auto handle = processes_.get(pid);
+				if (not handle or not subtree_.insert(pid).second) { continue; }
 
-				pid_cpu_map_[pid]  = cpu;
-				pid_node_map_[pid] = node;
+				if constexpr (requires { task_of(handle).children_and_tasks(); })
+				{
+					for (const auto child : task_of(handle).children_and_tasks())
+					{
+						pending.emplace_back(child);
+					}
+				}
+			}
+		}
 
-				cpu_use_.at(idx(cpu)) += proc.cpu_use();
-				node_use_.at(idx(node)) += proc.cpu_use();
+		// The cgroup, user and predicate scopes are checked once per TID, when it first appears
+		[[nodiscard]] auto in_scope(const pid_t pid) -> bool
+		{
+			if (scope_.type() == scope::kind::everything) { return true; }
+			if (scope_.type() == scope::kind::subtree) { return subtree_.contains(pid); }
+
+			const auto [it, inserted] = scope_cache_.try_emplace(pid, false);
+			if (inserted) { it->second = scope_.test(pid); }
+			return it->second;
+		}
+
+		// The process and cgroup of a TID are read once, when it first appears (only the enabled ones)
+		[[nodiscard]] auto groups_of(const pid_t pid) -> const group_ids &
+		{
+			const auto [it, inserted] = group_cache_.try_emplace(pid, group_ids{ pid, 0 });
+			if (not inserted) { return it->second; }
+
+			std::string path;
+			if constexpr (grouped_source<Processes>)
+			{
+				if (grouping_->processes) { it->second.process = processes_.thread_group(pid); }
+				if (grouping_->cgroups) { path = processes_.cgroup(pid); }
+			}
+			else
+			{
+				if (grouping_->processes) { it->second.process = procfs::thread_group_of(pid); }
+				if (grouping_->cgroups) { path = procfs::cgroup_of(pid); }
 			}
 
-			// Update the dirty stuff
-			dirty_cpu_pid_map_  = cpu_pid_map_;
-			dirty_node_pid_map_ = node_pid_map_;
+			const auto [path_it, added] = cgroup_ids_.try_emplace(std::move(path), next_cgroup_id_);
+			if (added) { ++next_cgroup_id_; }
+
+			it->second.cgroup = path_it->second;
+			return it->second;
+		}
+
+		// Same pruning as the scope cache, for the TIDs that left the maps, and then for the cgroups none of the
+		// cached TIDs is in anymore (e.g. transient scopes and containers that are gone)
+		void prune_group_cache()
+		{
+			static constexpr std::size_t MIN_PRUNE_SIZE = 1024;
 
-			dirty_pid_cpu_map_  = pid_cpu_map_;
-			dirty_pid_node_map_ = pid_node_map_;
+			if (group_cache_.size() < std::max(2 * group_cache_pruned_size_, MIN_PRUNE_SIZE)) { return; }
 
-			dirty_cpu_use_  = cpu_use_;
-			dirty_node_use_ = node_use_;
+			std::erase_if(group_cache_,
+			              [&](const auto & pid_ids) { return not pid_placement_map_.contains(pid_ids.first); });
+			group_cache_pruned_size_ = group_cache_.size();
 
-			compute_loads();
+			std::unordered_set<std::uint32_t> cached;
+			for (const auto & [pid, ids] : group_cache_)
+			{
+				cached.insert(ids.cgroup);
+			}
+			std::erase_if(cgroup_ids_, [&](const auto & path_id) { return not cached.contains(path_id.second); });
 		}
 
-		void build()
+		// Adds up the use, load and nodes of the managed TIDs of each process and cgroup. Cost: O(tasks), plus
+		// reading the groups of the new TIDs. Only the groups with managed TIDs are kept.
+		void aggregate_groups()
 		{
-			const auto size_cpus  = static_cast<std::size_t>(topology::max_cpu()) + 1;
-			const auto size_nodes = static_cast<std::size_t>(topology::max_node()) + 1;
+			for (auto & [tgid, group] : thread_groups_)
+			{
+				group.clear();
+			}
 
-			assert(std::cmp_greater(size_cpus, 0));
-			assert(std::cmp_greater(size_nodes, 0));
+			for (auto & [id, group] : cgroups_)
+			{
+				group.clear();
+			}
 
-			// Resize stuff
-			cpu_pid_map_.resize(size_cpus, {});
-			node_pid_map_.resize(size_nodes, {});
+			for (const auto & [pid, where] : pid_placement_map_)
+			{
+				const auto & ids  = groups_of(pid);
+				const auto   use  = cpu_pid_use_.at(idx(where.cpu)).at(where.cpu_slot);
+				const auto   load = cpu_pid_load_.at(idx(where.cpu)).at(where.cpu_slot);
+				const auto   node = numa_node(pid); // After the (uncommitted) migrations, as the moves keep them
 
-			dirty_cpu_pid_map_.resize(size_cpus, {});
-			dirty_node_pid_map_.resize(size_nodes, {});
+				if (grouping_->processes) { thread_groups_[ids.process].add(pid, node, use, load); }
+				if (grouping_->cgroups) { cgroups_[ids.cgroup].add(pid, node, use, load); }
+			}
 
-			cpu_use_.resize(size_cpus, 0.0F);
-			node_use_.resize(size_nodes, 0.0F);
+			std::erase_if(thread_groups_, [](const auto & tgid_group) { return tgid_group.second.empty(); });
+			std::erase_if(cgroups_, [](const auto & id_group) { return id_group.second.empty(); });
+			prune_group_cache();
+		}
 
-			dirty_cpu_use_.resize(size_cpus, 0.0F);
-			dirty_node_use_.resize(size_nodes, 0.0F);
+		// A TID moved to another node: so does its share of the nodes of its groups. Cost: O(1)
+		void move_in_groups(const pid_t pid, const node_t from, const node_t to)
+		{
+			const auto ids = group_cache_.find(pid);
+			if (ids == group_cache_.end()) { return; }
+
+			if (const auto it = thread_groups_.find(ids->second.process); it != thread_groups_.end())
+			{
+				it->second.move(from, to);
+			}
 
-			rebuild();
+			if (const auto it = cgroups_.find(ids->second.cgroup); it != cgroups_.end()) { it->second.move(from, to); }
 		}
 
-		void pin_pid_to_cpu(const pid_t pid, const int cpu) { processes_.pin_processor(pid, cpu); }
+		void clear_groups()
+		{
+			group_cache_.clear();
+			group_cache_pruned_size_ = 0;
 
-		void pin_pid_to_node(const pid_t pid, const int node) { processes_.pin_numa_node(pid, node); }
+			cgroup_ids_.clear();
+			next_cgroup_id_ = 0;
 
-	public:
-		// ----------------
-		// Static functions
-		// ----------------
-		static auto priority_to_weight(const size_t priority = 20)
-		{
-			static constexpr std::array<int, 40> sched_prio_to_weight = {
-				/* -20 */ 88761, 71755, 56483, 46273, 36291,
-				/* -15 */ 29154, 23254, 18705, 14949, 11916,
-				/* -10 */ 9548,  7620,  6100,  4904,  3906,
-				/*  -5 */ 3121,  2501,  1991,  1586,  1277,
-				/*   0 */ 1024,  820,   655,   526,   423,
-				/*   5 */ 335,   272,   215,   172,   137,
-				/*  10 */ 110,   87,    70,    56,    45,
-				/*  15 */ 36,    29,    23,    18,    15,
-			};
+			thread_groups_.clear();
+			cgroups_.clear();
+		}
+
+		// Drops the cached scope of the TIDs that exited, once the cache has doubled since the last time
+		void prune_scope_cache()
+		{
+			static constexpr std::size_t MIN_PRUNE_SIZE = 1024;
+
+			if (scope_cache_.size() < std::max(2 * scope_cache_pruned_size_, MIN_PRUNE_SIZE)) { return; }
 
-			return sched_prio_to_weight.at(priority);
+			std::erase_if(scope_cache_, [&](const auto & pid_in_scope) { return not processes_.get(pid_in_scope.first); });
+			scope_cache_pruned_size_ = scope_cache_.size();
 		}
 
-		// ----------------
+		void gather_use(const cpu_t cpu)
+		{
+			const auto pids = cpu_pid_map_[idx(cpu)];
 
-		snapshot() { build(); }
+			auto & use  = cpu_pid_use_.at(idx(cpu));
+			auto & load = cpu_pid_load_.at(idx(cpu));
 
-		[[nodiscard]] auto system_topology() const -> const auto & { return topology_; }
+			if (pids.size() > use.capacity()) { stats_.add_reallocation(); }
 
-		[[nodiscard]] auto processes() const -> const auto & { return processes_; }
+			use.resize(pids.size());
+			load.resize(pids.size());
+
+			ranges::transform(pids, use.begin(), [&](const auto pid) { return processes_.cpu_use(pid); });
+
+			if constexpr (weighted_load_model<Load>)
+			{
+				auto & weight = cpu_pid_weight_.at(idx(cpu));
+				weight.resize(pids.size());
+				ranges::transform(pids, weight.begin(), [&](const auto pid) { return nice_to_weight(nice_of(pid)); });
+			}
+		}
 
-		void update()
+		[[nodiscard]] auto tasks_of(const cpu_t cpu, const std::span<const float> use) const -> cpu_tasks
 		{
-			// Update the process tree
-			processes_.update();
+			const auto pids = cpu_pid_map_[idx(cpu)];
 
-			// Rebuild the snapshot
-			rebuild();
+			if constexpr (weighted_load_model<Load>) { return { pids, use, cpu_pid_weight_.at(idx(cpu)) }; }
+			else { return { pids, use, {} }; }
 		}
 
-		void commit()
+		void compute_loads(const cpu_t cpu)
 		{
-			// If the snapshot is not dirty (nothing to change), do nothing
-			if (not dirty_) { return; }
+			const auto & use  = cpu_pid_use_.at(idx(cpu));
+			auto &       load = cpu_pid_load_.at(idx(cpu));
 
-			for (const auto & [pid, cpu] : cpu_migrations_)
+			if (history_ and history_->config().smooth_loads)
 			{
-				pin_pid_to_cpu(pid, cpu);
+				// The kernel reads the use of each TID before writing its load, so the smoothed use can be passed
+				// in the load array itself
+				ranges::transform(cpu_pid_map_[idx(cpu)], load.begin(),
+				                  [&](const auto pid) { return smoothed_use(pid); });
+				cpu_load_.at(idx(cpu)) = model_.compute(tasks_of(cpu, load), load);
 			}
+			else { cpu_load_.at(idx(cpu)) = model_.compute(tasks_of(cpu, use), load); }
+		}
 
-			for (const auto & [pid, node] : node_migrations_)
+		// Adds the use of every TID and CPU to the history, as a new update
+		void sample_history()
+		{
+			for (const auto cpu : topology_.cpus())
 			{
-				pin_pid_to_node(pid, node);
-			}
+				const auto   pids = cpu_pid_map_[idx(cpu)];
+				const auto & use  = cpu_pid_use_.at(idx(cpu));
 
-			cpu_migrations_.clear();
-			node_migrations_.clear();
+				for (std::size_t i = 0; i < pids.size(); ++i)
+				{
+					history_->record(pids[i], use[i]);
+				}
 
-			dirty_ = false;
+				history_->record_cpu(cpu, cpu_use_.at(idx(cpu)));
+			}
 
-			update();
+			history_->end_tick();
 		}
 
-		void rollback()
+		// new_sample: the use comes from a new update of the process tree, so it goes to the history
+		void compute_loads(const bool new_sample)
 		{
-			cpu_migrations_.clear();
-			node_migrations_.clear();
+			const auto start = stats_.start();
 
-			dirty_cpu_pid_map_  = cpu_pid_map_;
-			dirty_node_pid_map_ = node_pid_map_;
+			ranges::fill(cpu_load_, 0.0F);
 
-			dirty_pid_cpu_map_  = pid_cpu_map_;
-			dirty_pid_node_map_ = pid_node_map_;
+			// Each CPU only writes its own arrays, so the CPUs can be computed in parallel
+			const auto & cpus = topology_.cpus();
+			for_each_index(cpus.size(), [&](const std::size_t i) { gather_use(cpus[i]); });
 
-			dirty_cpu_use_  = cpu_use_;
-			dirty_node_use_ = node_use_;
+			if (history_ and new_sample) { sample_history(); }
 
-			dirty_ = false;
-		}
+			// Models with a state per TID (e.g. decayed_load) add the new TIDs before the CPUs are computed in parallel
+			if constexpr (requires { model_.prepare(pid_placement_map_ | ranges::views::keys, new_sample); })
+			{
+				model_.prepare(pid_placement_map_ | ranges::views::keys, new_sample);
+			}
 
-		[[nodiscard]] auto process(const pid_t pid) -> auto & { return processes_.find(pid); }
+			for_each_index(cpus.size(), [&](const std::size_t i) { compute_loads(cpus[i]); });
 
-		[[nodiscard]] auto process(const pid_t pid) const -> const auto & { return processes_.find(pid); }
+			const auto & nodes = topology_.nodes();
+			for_each_index(nodes.size(), [&](const std::size_t i) {
+				const auto pids = node_pid_map_[idx(nodes[i])];
 
-		[[nodiscard]] auto processor(const pid_t pid) const { return dirty_pid_cpu_map_.at(pid); }
+				node_load_.at(idx(nodes[i])) = ranges::accumulate(
+				    pids | ranges::views::transform([&](const auto pid) { return load_of(pid); }), 0.0F);
+			});
 
-		[[nodiscard]] auto original_processor(const pid_t pid) const { return pid_cpu_map_.at(pid); }
+			system_load_ = ranges::accumulate(cpu_load_, 0.0F);
 
-		[[nodiscard]] auto numa_node(const pid_t pid) const { return dirty_pid_node_map_.at(pid); }
+			compute_domains();
 
-		[[nodiscard]] auto original_numa_node(const pid_t pid) const { return pid_node_map_.at(pid); }
+			least_loaded_.reset(topology_, [&](const cpu_t cpu) { return cpu_load_.at(idx(cpu)); });
 
-		[[nodiscard]] auto pids_in_cpu(const cpu_t cpu) const -> const auto &
+			if (grouping_) { aggregate_groups(); }
+
+			stats_.stop(metric::loads, start);
+			stats_.record(metric::reallocations, static_cast<double>(stats_.take_reallocations()));
+		}
+
+		// Adds up the use and load of the CPUs of each domain. Cost: O(levels * CPUs)
+		void compute_domains()
 		{
-			return dirty_cpu_pid_map_.at(idx(cpu));
+			if constexpr (hierarchical_topology<Topology>)
+			{
+				const auto & hierarchy = topology_.hierarchy();
+
+				for (const auto level : { domain_level::core, domain_level::l2, domain_level::l3, domain_level::package })
+				{
+					auto & use  = domain_use_.at(level_index(level));
+					auto & load = domain_load_.at(level_index(level));
+
+					use.assign(hierarchy.num_of_domains(level), 0.0F);
+					load.assign(hierarchy.num_of_domains(level), 0.0F);
+
+					for (const auto cpu : topology_.cpus())
+					{
+						const auto domain = idx(hierarchy.domain_of(level, cpu));
+						use[domain] += cpu_use_.at(idx(cpu));
+						load[domain] += cpu_load_.at(idx(cpu));
+					}
+				}
+			}
 		}
 
-		[[nodiscard]] auto pids_in_node(const node_t node) const -> const auto &
+		void insert_pid(const pid_t pid, placement & where)
 		{
-			return dirty_node_pid_map_.at(idx(node));
+			where.cpu_slot  = cpu_pid_map_.insert(idx(where.cpu), pid);
+			where.node_slot = node_pid_map_.insert(idx(where.node), pid);
 		}
 
-		[[nodiscard]] auto original_pids_in_cpu(const cpu_t cpu) const -> const auto &
+		void erase_from_cpu(const placement & where)
 		{
-			return cpu_pid_map_.at(idx(cpu));
+			if (const auto moved = cpu_pid_map_.erase(idx(where.cpu), where.cpu_slot))
+			{
+				pid_placement_map_.at(*moved).cpu_slot = where.cpu_slot;
+			}
 		}
 
-		[[nodiscard]] auto original_pids_in_node(const node_t node) const -> const auto &
+		void erase_from_node(const placement & where)
 		{
-			return node_pid_map_.at(idx(node));
+			if (const auto moved = node_pid_map_.erase(idx(where.node), where.node_slot))
+			{
+				pid_placement_map_.at(*moved).node_slot = where.node_slot;
+			}
 		}
 
-		[[nodiscard]] auto cpu_use(const cpu_t cpu) const { return cpu_use_.at(idx(cpu)); }
+		void move_pid(const pid_t pid, const cpu_t cpu, const node_t node)
+		{
+			const auto [it, inserted] = pid_placement_map_.try_emplace(pid, placement{ cpu, node });
+			auto & where              = it->second;
 
-		[[nodiscard]] auto node_use(const node_t node) const { return node_use_.at(idx(node)); }
+			if (inserted)
+			{
+				insert_pid(pid, where);
+				if (sampler_) { sampler_->discovered(pid); }
+				return;
+			}
 
-		[[nodiscard]] auto load_of(const pid_t pid) const { return pid_load_map_.at(pid); }
+			if (where.cpu != cpu)
+			{
+				erase_from_cpu(where);
+				where.cpu      = cpu;
+				where.cpu_slot = cpu_pid_map_.insert(idx(cpu), pid);
+			}
 
-		[[nodiscard]] auto load_of_cpu(const cpu_t cpu) const
+			if (where.node != node)
+			{
+				erase_from_node(where);
+				where.node      = node;
+				where.node_slot = node_pid_map_.insert(idx(node), pid);
+			}
+		}
+
+		void remove_exited_pids()
 		{
-			return ranges::accumulate(
-			    pids_in_cpu(cpu) | ranges::views::transform([&](const auto pid) { return load_of(pid); }), 0.0F);
+			for (auto it = pid_placement_map_.begin(); it != pid_placement_map_.end();)
+			{
+				const auto pid = it->first;
+
+				if (processes_.get(pid) and in_scope(pid))
+				{
+					++it;
+					continue;
+				}
+
+				erase_from_cpu(it->second);
+				erase_from_node(it->second);
+
+				it = pid_placement_map_.erase(it);
+			}
 		}
 
-		[[nodiscard]] auto load_of_node(const node_t node) const
+		// Applies the events to the membership, in O(events). The scan stays the authority: what the events missed
+		// (e.g. a TID that exited after the poll) is caught by the sweep, which only runs when the counts disagree.
+		void apply_task_events()
 		{
-			return ranges::accumulate(
-			    pids_in_node(node) | ranges::views::transform([&](const auto pid) { return load_of(pid); }), 0.0F);
+			for (const auto & event : task_events_.events)
+			{
+				switch (event.what)
+				{
+					case task_event::kind::fork:
+						// The parent of a new thread is the parent of its process, so threads join through their process
+						if (scope_.type() == scope::kind::subtree and
+						    (subtree_.contains(event.parent) or subtree_.contains(event.process)))
+						{
+							subtree_.insert(event.pid);
+						}
+						break;
+					case task_event::kind::exec:
+						scope_cache_.erase(event.pid);
+						group_cache_.erase(event.pid);
+						break;
+					case task_event::kind::exit:
+						subtree_.erase(event.pid);
+						scope_cache_.erase(event.pid);
+						group_cache_.erase(event.pid);
+
+						if (const auto it = pid_placement_map_.find(event.pid); it != pid_placement_map_.end())
+						{
+							erase_from_cpu(it->second);
+							erase_from_node(it->second);
+							pid_placement_map_.erase(it);
+						}
+						break;
+				}
+			}
 		}
 
-		[[nodiscard]] auto load_system() const
+		void scan_processes()
 		{
-			return ranges::accumulate(pid_load_map_ | ranges::views::values, 0.0F);
+			if constexpr (sampled_source<Processes>)
+			{
+				if (sampler_)
+				{
+					sampler_->advance();
+					processes_.update(sampler_->plan());
+					return;
+				}
+			}
+
+			processes_.update();
 		}
 
-		void migrate_to_cpu(const pid_t pid, const cpu_t cpu)
+		// Feeds the use read by this update to the sampler, which picks the hot TIDs of the next one.
+		// Cost: O(tasks) over the per-CPU arrays for the round-robin share, plus a lookup per hot or new TID.
+		void settle_samples()
 		{
-			dirty_ = true;
+			auto &     sampler = *sampler_;
+			const auto plan    = sampler.plan();
 
-			const auto node = topology_.node_from_cpu(cpu);
+			std::size_t samples = 0;
+			for (const auto cpu : topology_.cpus())
+			{
+				const auto   pids = cpu_pid_map_[idx(cpu)];
+				const auto & use  = cpu_pid_use_.at(idx(cpu));
+
+				for (std::size_t i = 0; i < pids.size(); ++i)
+				{
+					if (not plan.due(pids[i])) { continue; }
 
-			const auto old_cpu  = dirty_pid_cpu_map_.at(pid);
-			const auto old_node = dirty_pid_node_map_.at(pid);
+					sampler.observe(pids[i], use[i]);
+					++samples;
+				}
+			}
 
-			// Update the dirty maps
-			dirty_cpu_pid_map_.at(idx(old_cpu)).erase(pid);
-			dirty_node_pid_map_.at(idx(old_node)).erase(pid);
+			sampler.for_each_out_of_turn([&](const pid_t pid) {
+				if (not manages(pid)) { return; }
 
-			dirty_cpu_pid_map_.at(idx(cpu)).insert(pid);
-			dirty_node_pid_map_.at(idx(node)).insert(pid);
+				sampler.observe(pid, processes_.cpu_use(pid));
+				++samples;
+			});
 
-			// Update the dirty usage
-			const auto cpu_use = processes_.cpu_use(pid) / 100.0F;
+			stats_.record(metric::samples, static_cast<double>(samples));
+		}
 
-			dirty_cpu_use_.at(idx(old_cpu)) -= cpu_use;
-			dirty_cpu_use_.at(idx(cpu)) += cpu_use;
+		// Reads the NUMA faults of the TIDs that used at least config.min_use, and the memory of their processes
+		// (once per process), in the pool if there is one. The idle TIDs cost nothing but the walk over the arrays.
+		void collect_locality()
+		{
+			const auto & config = *locality_config_;
 
-			dirty_node_use_.at(idx(old_node)) -= cpu_use;
-			dirty_node_use_.at(idx(node)) += cpu_use;
+			std::vector<pid_t> busy;
+			for (const auto cpu : topology_.cpus())
+			{
+				const auto   pids = cpu_pid_map_[idx(cpu)];
+				const auto & use  = cpu_pid_use_.at(idx(cpu));
 
-			cpu_migrations_[pid] = cpu;
+				for (std::size_t i = 0; i < pids.size(); ++i)
+				{
+					if (use[i] >= config.min_use) { busy.push_back(pids[i]); }
+				}
+			}
+
+			std::vector<task_locality> found(busy.size());
+			std::vector<pid_t>         groups(busy.begin(), busy.end()); // input: busy TID, output: its process
+
+			for_each_index(busy.size(), [&](const std::size_t i) {
+				if constexpr (locality_source<Processes>) { found[i].faults = processes_.numa_faults(busy[i]); }
+				else { found[i].faults = numa_faults::read(busy[i]); }
+
+				if constexpr (not memory_handler<Processes>)
+				{
+					if (config.memory) { groups[i] = procfs::thread_group_of(busy[i]); }
+				}
+			});
+
+			if (config.memory)
+			{
+				// The threads of a process share its memory, so numa_maps is read by the first busy one only
+				fast_umap<pid_t, std::size_t> reader_of; // input: process, output: busy TID that reads its memory
+				std::vector<std::size_t>      readers;
+
+				for (std::size_t i = 0; i < busy.size(); ++i)
+				{
+					if (reader_of.try_emplace(groups[i], i).second) { readers.push_back(i); }
+				}
+
+				for_each_index(readers.size(), [&](const std::size_t r) {
+					found[readers[r]].memory = memory_of(busy[readers[r]]);
+				});
+
+				for (std::size_t i = 0; i < busy.size(); ++i)
+				{
+					const auto reader = reader_of.at(groups[i]);
+					if (reader != i) { found[i].memory = found[reader].memory; }
+				}
+			}
+
+			locality_.clear();
+			for (std::size_t i = 0; i < busy.size(); ++i)
+			{
+				locality_.emplace(busy[i], std::move(found[i]));
+			}
+
+			// Sources that do not represent real tasks have no system counters
+			if constexpr (not locality_source<Processes>)
+			{
+				const auto counters = numa_counters::read_system();
+				numa_activity_      = counters - numa_counters_;
+				numa_counters_      = counters;
+			}
+
+			stats_.record(metric::locality, static_cast<double>(busy.size()));
 		}
 
-		void migrate_to_node(const pid_t pid, const node_t node)
+		// tracked: the events since the last update are known, so the membership follows them
+		void scan_and_rebuild(const rebuild_policy policy, const bool tracked)
 		{
-			dirty_ = true;
+			const auto start = stats_.start();
+
+			// Update the process tree
+			scan_processes();
+			stats_.stop(metric::scan, start);
 
-			const auto cpu = *(topology_.cpus_from_node(node) | ranges::views::sample(1)).begin();
+			events_tracked_ = tracked and not task_events_.lost;
+			if (events_tracked_) { apply_task_events(); }
+			if (tracked) { stats_.record(metric::task_events, static_cast<double>(task_events_.size())); }
+			task_events_.clear();
 
-			const auto old_cpu  = dirty_pid_cpu_map_.at(pid);
-			const auto old_node = dirty_pid_node_map_.at(pid);
+			// Rebuild the snapshot
+			rebuild(policy);
+			events_tracked_ = false;
 
-			// Update the dirty maps
-			dirty_cpu_pid_map_.at(idx(old_cpu)).erase(pid);
-			dirty_node_pid_map_.at(idx(old_node)).erase(pid);
+			if (sampler_) { settle_samples(); }
+			if (locality_config_) { collect_locality(); }
 
-			dirty_cpu_pid_map_.at(idx(cpu)).insert(pid);
-			dirty_node_pid_map_.at(idx(node)).insert(pid);
+			stats_.stop(metric::update, start);
+		}
 
-			// Update the dirty usage
-			const auto cpu_use = processes_.cpu_use(pid) / 100.0F;
+		void rebuild_incremental()
+		{
+			ranges::fill(cpu_use_, 0.0F);
+			ranges::fill(node_use_, 0.0F);
+
+			// Insert the new TIDs and move the ones that changed their CPU/node
+			std::size_t alive = 0;
+			for (const auto & proc : processes_)
+			{
+				const auto cpu  = proc.processor();
+				const auto node = proc.numa_node();
 
-			dirty_cpu_use_.at(idx(old_cpu)) -= cpu_use;
-			dirty_cpu_use_.at(idx(cpu)) += cpu_use;
+				if (not in_scope(proc.pid()))
+				{
+					foreign_cpu_use_.at(idx(cpu)) += proc.cpu_use();
+					continue;
+				}
 
-			dirty_node_use_.at(idx(old_node)) -= cpu_use;
-			dirty_node_use_.at(idx(node)) += cpu_use;
+				move_pid(proc.pid(), cpu, node);
 
-			node_migrations_[pid] = node;
+				cpu_use_.at(idx(cpu)) += proc.cpu_use();
+				node_use_.at(idx(node)) += proc.cpu_use();
+
+				++alive;
+			}
+
+			// Every alive TID is in the maps, so any extra entry belongs to a TID that exited
+			if (pid_placement_map_.size() > alive) { remove_exited_pids(); }
 		}
 
-		void unpin(const pid_t pid) { processes_.unpin(pid); }
+		// Same as rebuild_incremental(), but the diff against the previous state is sharded across the pool.
+		// The shards only read the maps: the few TIDs that changed are applied afterwards, and the partial usages
+		// are merged per CPU/node.
+		void rebuild_incremental_parallel()
+		{
+			samples_.clear();
+			for (const auto & proc : processes_)
+			{
+				if (not in_scope(proc.pid()))
+				{
+					foreign_cpu_use_.at(idx(proc.processor())) += proc.cpu_use();
+					continue;
+				}
 
-		void unpin() { processes_.unpin(); }
-	};
-} // namespace syssnap
\ No newline at end of file
+				samples_.push_back({ proc.pid(), proc.processor(), proc.numa_node(), proc.cpu_use() });
+			}
+
+			shards_.resize(pool_->size());
+			const auto shard_size = (samples_.size() + shards_.size() - 1) / shards_.size();
+
+			pool_->parallel_for(shards_.size(), [&](const std::size_t s) {
+				auto & shard = shards_[s];
+
+				shard.cpu_use.assign(cpu_use_.size(), 0.0F);
+				shard.node_use.assign(node_use_.size(), 0.0F);
+				shard.changes.clear();
+
+				const auto first = std::min(s * shard_size, samples_.size());
+				const auto last  = std::min(first + shard_size, samples_.size());
+
+				for (const auto & sample : std::span{ samples_ }.subspan(first, last - first))
+				{
+					shard.cpu_use.at(idx(sample.cpu)) += sample.cpu_use;
+					shard.node_use.at(idx(sample.node)) += sample.cpu_use;
+
+					const auto it = pid_placement_map_.find(sample.pid);
+					if (it == pid_placement_map_.end() or it->second.cpu != sample.cpu or
+					    it->second.node != sample.node)
+					{
+						shard.changes.emplace_back(sample);
+					}
+				}
+			});
+
+			for (const auto & shard : shards_)
+			{
+				for (const auto & sample : shard.changes)
+				{
+					move_pid(sample.pid, sample.cpu, sample.node);
+				}
+			}
+
+			for_each_index(cpu_use_.size(), [&](const std::size_t cpu) {
+				cpu_use_[cpu] = ranges::accumulate(
+				    shards_ | ranges::views::transform([&](const auto & shard) { return shard.cpu_use[cpu]; }), 0.0F);
+			});
+
+			for_each_index(node_use_.size(), [&](const std::size_t node) {
+				node_use_[node] = ranges::accumulate(
+				    shards_ | ranges::views::transform([&](const auto & shard) { return shard.node_use[node]; }), 0.0F);
+			});
+
+			// Every alive TID is in the maps, so any extra entry belongs to a TID that exited
+			if (pid_placement_map_.size() > samples_.size()) { remove_exited_pids(); }
+		}
+
+		void rebuild_full()
+		{
+			// Reset variables
+			cpu_pid_map_.clear();
+			node_pid_map_.clear();
+
+			pid_placement_map_.clear();
+
+			ranges::fill(cpu_use_, 0.0F);
+			ranges::fill(node_use_, 0.0F);
+
+			// Build the maps
+			for (const auto & proc : processes_)
+			{
+				const auto pid  = proc.pid();
+				const auto cpu  = proc.processor();
+				const auto node = proc.numa_node();
+
+				if (not in_scope(pid))
+				{
+					foreign_cpu_use_.at(idx(cpu)) += proc.cpu_use();
+					continue;
+				}
+
+				auto & where = pid_placement_map_[pid];
+				where        = placement{ cpu, node };
+				insert_pid(pid, where);
+
+				cpu_use_.at(idx(cpu)) += proc.cpu_use();
+				node_use_.at(idx(node)) += proc.cpu_use();
+			}
+		}
+
+		void build()
+		{
+			const auto size_cpus  = static_cast<std::size_t>(topology_.max_cpu()) + 1;
+			const auto size_nodes = static_cast<std::size_t>(topology_.max_node()) + 1;
+
+			assert(std::cmp_greater(size_cpus, 0));
+			assert(std::cmp_greater(size_nodes, 0));
+
+			// Resize stuff
+			cpu_pid_map_.resize(size_cpus);
+			node_pid_map_.resize(size_nodes);
+
+			cpu_use_.resize(size_cpus, 0.0F);
+			node_use_.resize(size_nodes, 0.0F);
+
+			foreign_cpu_use_.resize(size_cpus, 0.0F);
+
+			cpu_pid_use_.resize(size_cpus);
+			cpu_pid_load_.resize(size_cpus);
+			cpu_pid_weight_.resize(size_cpus);
+
+			cpu_load_.resize(size_cpus, 0.0F);
+			node_load_.resize(size_nodes, 0.0F);
+
+			rebuild(rebuild_policy::full);
+		}
+
+		void clear_dirty_overlay()
+		{
+			// The CPUs that the overlay changed go back to their committed load
+			for (const auto & [cpu, load] : dirty_cpu_load_)
+			{
+				least_loaded_.update(cpu, cpu_load_.at(idx(cpu)));
+			}
+
+			dirty_pid_cpu_map_.clear();
+			dirty_pid_node_map_.clear();
+
+			dirty_cpu_use_.clear();
+			dirty_node_use_.clear();
+
+			dirty_cpu_load_.clear();
+			dirty_node_load_.clear();
+		}
+
+		void move_dirty_pid(const pid_t pid, const cpu_t cpu, const node_t node)
+		{
+			const auto old_cpu  = processor(pid);
+			const auto old_node = numa_node(pid);
+
+			// Update the overlay. A TID that goes back to where it was does not need to be in it anymore
+			if (cpu == original_processor(pid) and node == original_numa_node(pid))
+			{
+				dirty_pid_cpu_map_.erase(pid);
+				dirty_pid_node_map_.erase(pid);
+			}
+			else
+			{
+				dirty_pid_cpu_map_[pid]  = cpu;
+				dirty_pid_node_map_[pid] = node;
+			}
+
+			// Update the dirty usage
+			const auto cpu_use = processes_.cpu_use(pid);
+
+			dirty_cpu_use_[old_cpu] -= cpu_use;
+			dirty_cpu_use_[cpu] += cpu_use;
+
+			dirty_node_use_[old_node] -= cpu_use;
+			dirty_node_use_[node] += cpu_use;
+
+			// Update the dirty loads
+			const auto load = load_of(pid);
+
+			dirty_cpu_load_[old_cpu] -= load;
+			dirty_cpu_load_[cpu] += load;
+
+			dirty_node_load_[old_node] -= load;
+			dirty_node_load_[node] += load;
+
+			least_loaded_.update(old_cpu, load_of_cpu(old_cpu));
+			least_loaded_.update(cpu, load_of_cpu(cpu));
+
+			if (grouping_ and old_node != node) { move_in_groups(pid, old_node, node); }
+		}
+
+		// Moves a TID of the committed state, along with its use and load
+		void promote_pid(const pid_t pid, const cpu_t cpu, const node_t node)
+		{
+			auto & where = pid_placement_map_.at(pid);
+
+			if (where.cpu != cpu)
+			{
+				auto & old_use  = cpu_pid_use_.at(idx(where.cpu));
+				auto & old_load = cpu_pid_load_.at(idx(where.cpu));
+
+				const auto use  = old_use.at(where.cpu_slot);
+				const auto load = old_load.at(where.cpu_slot);
+
+				// Same swap-remove as the membership list, so the arrays stay in the same order
+				old_use.at(where.cpu_slot)  = old_use.back();
+				old_load.at(where.cpu_slot) = old_load.back();
+				old_use.pop_back();
+				old_load.pop_back();
+
+				if constexpr (weighted_load_model<Load>)
+				{
+					auto &     old_weight         = cpu_pid_weight_.at(idx(where.cpu));
+					const auto weight             = old_weight.at(where.cpu_slot);
+					old_weight.at(where.cpu_slot) = old_weight.back();
+					old_weight.pop_back();
+					cpu_pid_weight_.at(idx(cpu)).emplace_back(weight);
+				}
+
+				erase_from_cpu(where);
+				where.cpu      = cpu;
+				where.cpu_slot = cpu_pid_map_.insert(idx(cpu), pid);
+
+				cpu_pid_use_.at(idx(cpu)).emplace_back(use);
+				cpu_pid_load_.at(idx(cpu)).emplace_back(load);
+			}
+
+			if (where.node != node)
+			{
+				erase_from_node(where);
+				where.node      = node;
+				where.node_slot = node_pid_map_.insert(idx(node), pid);
+			}
+		}
+
+		// Applies the overlay to the committed state. Cost: O(migrations)
+		void promote_dirty_state()
+		{
+			for (const auto & [pid, cpu] : dirty_pid_cpu_map_)
+			{
+				promote_pid(pid, cpu, dirty_pid_node_map_.at(pid));
+			}
+
+			for (const auto & [cpu, use] : dirty_cpu_use_)
+			{
+				cpu_use_.at(idx(cpu)) += use;
+			}
+
+			for (const auto & [node, use] : dirty_node_use_)
+			{
+				node_use_.at(idx(node)) += use;
+			}
+
+			for (const auto & [cpu, load] : dirty_cpu_load_)
+			{
+				cpu_load_.at(idx(cpu)) += load;
+			}
+
+			for (const auto & [node, load] : dirty_node_load_)
+			{
+				node_load_.at(idx(node)) += load;
+			}
+
+			if (not dirty_cpu_use_.empty()) { compute_domains(); }
+
+			clear_dirty_overlay();
+		}
+
+		// Size of the hash tables after a rebuild, and whether they grew (bucket counts before the rebuild)
+		void record_tables(const std::size_t placement_buckets, const std::size_t scope_buckets)
+		{
+			const auto rehashes = static_cast<int>(pid_placement_map_.bucket_count() > placement_buckets) +
+			                      static_cast<int>(scope_cache_.bucket_count() > scope_buckets);
+
+			stats_.record(metric::tasks, static_cast<double>(pid_placement_map_.size()));
+			stats_.record(metric::hash_buckets,
+			              static_cast<double>(pid_placement_map_.bucket_count() + scope_cache_.bucket_count()));
+			stats_.record(metric::scope_cache, static_cast<double>(scope_cache_.size()));
+			stats_.record(metric::rehashes, static_cast<double>(rehashes));
+		}
+
+		void publish()
+		{
+			if (channel_) { channel_->publish(*this); }
+		}
+
+		// Applies the affinity changes, grouped by destination so each CPU/node mask is built once.
+		// The calls are spread across the pool (if any), and each one reports its own result.
+		auto apply_migrations() -> std::vector<migration_result>
+		{
+			fast_umap<cpu_t, cpu_mask>  cpu_masks;
+			fast_umap<node_t, cpu_mask> node_masks;
+
+			std::vector<std::pair<pid_t, const cpu_mask *>> jobs;
+			jobs.reserve(cpu_migrations_.size() + node_migrations_.size());
+
+			for (const auto & [pid, cpu] : cpu_migrations_)
+			{
+				// The node migrations were applied last, so they take precedence
+				if (node_migrations_.contains(pid)) { continue; }
+
+				const auto [it, _] = cpu_masks.try_emplace(cpu, std::array{ cpu }, topology_.max_cpu());
+				jobs.emplace_back(pid, &it->second);
+			}
+
+			for (const auto & [pid, node] : node_migrations_)
+			{
+				const auto [it, _] = node_masks.try_emplace(node, topology_.node_cpu_set(node), topology_.max_cpu());
+				jobs.emplace_back(pid, &it->second);
+			}
+
+			std::vector<migration_result> results(jobs.size());
+
+			for_each_index(jobs.size(), [&](const std::size_t i) {
+				const auto [pid, mask] = jobs[i];
+
+				int error = 0;
+				if constexpr (affinity_handler<Processes>) { error = processes_.set_affinity(pid, *mask); }
+				else { error = mask->apply(pid); }
+
+				results[i] = { pid, migration_status_from_errno(error), error };
+			});
+
+			return results;
+		}
+
+		// Queues the memory of the TIDs that moved to another node, behind what previous commits left. The memory of a
+		// process is shared by its threads, so it is queued once even if several of its threads were migrated: a
+		// process already in the queue only gets the new node (and starts over if it changed).
+		void queue_memory_migrations(const std::vector<migration_result> & results)
+		{
+			for (const auto & result : results)
+			{
+				if (result.status != migration_status::applied) { continue; }
+
+				const auto it = node_migrations_.find(result.pid);
+				if (it == node_migrations_.end()) { continue; }
+
+				pid_t process = result.pid;
+				if constexpr (not memory_handler<Processes>) { process = procfs::thread_group_of(result.pid); }
+
+				if (memory_queued_.insert(process).second)
+				{
+					memory_migrations_.push_back({ process, it->second });
+					continue;
+				}
+
+				auto & queued = *std::ranges::find(memory_migrations_, process, &pending_memory::pid);
+				if (queued.node != it->second) { queued = { process, it->second }; }
+			}
+		}
+
+		// Moves the queued memory, a batch of pages at a time, until the byte or page budget of the commit runs out. A
+		// process whose memory does not fit stays at the front of the queue, and the next commit carries on where this
+		// one stopped.
+		auto migrate_memory() -> std::vector<memory_migration_result>
+		{
+			std::vector<memory_migration_result> results;
+			if (not memory_migration_) { return results; }
+
+			const auto budget = memory_migration_->max_bytes_per_commit;
+
+			std::uint64_t moved   = 0;
+			std::uint64_t visited = 0; // Pages visited, moved or not
+
+			while (not memory_migrations_.empty() and results.size() < memory_migration_->max_processes_per_commit and
+			       moved < budget and visited < memory_migration_->max_pages_per_commit)
+			{
+				auto & pending = memory_migrations_.front();
+
+				memory_step step;
+				if constexpr (memory_handler<Processes>)
+				{
+					step = processes_.migrate_memory(pending.pid, pending.node, budget - moved);
+				}
+				else
+				{
+					step = move_pages_to_node(pending.pid, pending.node, pending.resume, budget - moved,
+					                          memory_migration_->max_pages_per_commit - visited,
+					                          memory_migration_->pages_per_call);
+				}
+
+				results.push_back({ pending.pid, pending.node, step.bytes, step.error });
+				moved += step.bytes;
+				visited += step.pages;
+
+				if (step.error != 0 or step.done)
+				{
+					memory_queued_.erase(pending.pid);
+					memory_migrations_.pop_front();
+				}
+				else { break; }
+			}
+
+			stats_.record(metric::memory_migrated, static_cast<double>(moved));
+
+			return results;
+		}
+
+	public:
+		// ----------------
+		// Static functions
+		// ----------------
+		static auto priority_to_weight(const size_t priority = 20) { return syssnap::priority_to_weight(priority); }
+
+		// ----------------
+
+		basic_snapshot()
+		    requires std::default_initializable<Processes> and std::default_initializable<Topology>
+		{
+			build();
+		}
+
+		explicit basic_snapshot(const std::size_t workers)
+		    requires std::default_initializable<Processes> and std::default_initializable<Topology>
+		{
+			set_workers(workers);
+			build();
+		}
+
+		// Snapshot limited to the tasks in the scope
+		explicit basic_snapshot(scope managed, const std::size_t workers = 1)
+		    requires std::default_initializable<Processes> and std::default_initializable<Topology>
+		    : scope_(std::move(managed))
+		{
+			set_workers(workers);
+			build();
+		}
+
+		basic_snapshot(Processes processes, Topology topo, const std::size_t workers = 1, scope managed = {}) :
+		    topology_(std::move(topo)), processes_(std::move(processes)), scope_(std::move(managed))
+		{
+			set_workers(workers);
+			build();
+		}
+
+		// Number of threads used to rebuild the maps and compute the loads (1 = sequential)
+		void set_workers(const std::size_t workers)
+		{
+			if (workers > 1) { pool_ = std::make_shared<thread_pool>(workers); }
+			else { pool_.reset(); }
+		}
+
+		[[nodiscard]] auto workers() const -> std::size_t { return pool_ ? pool_->size() : 1; }
+
+		// Durations of the phases and counters of the last updates and commits (e.g. stats().of(metric::update))
+		[[nodiscard]] auto stats() const -> const Stats & { return stats_; }
+
+		void clear_stats()
+		    requires requires(Stats & stats) { stats.clear(); }
+		{
+			stats_.clear();
+		}
+
+		[[nodiscard]] auto system_topology() const -> const auto & { return topology_; }
+
+		[[nodiscard]] auto processes() const -> const auto & { return processes_; }
+
+		[[nodiscard]] auto managed_scope() const -> const scope & { return scope_; }
+
+		// Whether the TID is in the scope (and so in the maps) as of the last update
+		[[nodiscard]] auto manages(const pid_t pid) const -> bool { return pid_placement_map_.contains(pid); }
+
+		void update(const rebuild_policy policy = rebuild_policy::incremental)
+		{
+			if (proc_events_) { proc_events_->poll(task_events_); }
+
+			scan_and_rebuild(policy, proc_events_ != nullptr);
+		}
+
+		// Same as update(), with the forks, execs and exits since the last update known from elsewhere
+		// (e.g. a proc_events of the caller)
+		void update(const task_events & events, const rebuild_policy policy = rebuild_policy::incremental)
+		{
+			if (proc_events_) { proc_events_->poll(task_events_); }
+
+			task_events_.events.insert(task_events_.events.end(), events.events.begin(), events.events.end());
+			task_events_.lost = task_events_.lost or events.lost;
+
+			scan_and_rebuild(policy, true);
+		}
+
+		// Rebuild the maps from the current state of the process tree (without reading procfs again)
+		void rebuild(const rebuild_policy policy = rebuild_policy::incremental)
+		{
+			const auto start             = stats_.start();
+			const auto placement_buckets = pid_placement_map_.bucket_count();
+			const auto scope_buckets     = scope_cache_.bucket_count();
+
+			if (not events_tracked_) { refresh_subtree(); }
+			ranges::fill(foreign_cpu_use_, 0.0F);
+
+			if (policy == rebuild_policy::full) { rebuild_full(); }
+			else if (pool_) { rebuild_incremental_parallel(); }
+			else { rebuild_incremental(); }
+
+			if (not events_tracked_) { prune_scope_cache(); }
+
+			// The overlay refers to the previous state, so drop it
+			clear_dirty_overlay();
+
+			stats_.stop(metric::rebuild, start);
+			record_tables(placement_buckets, scope_buckets);
+
+			compute_loads(true);
+
+			publish();
+		}
+
+		// Recomputes the loads from the current maps (without reading procfs again nor adding to the history)
+		void recompute_loads() { compute_loads(false); }
+
+		// Publishes a copy of the committed state to the channel now and after every update and commit, so other
+		// threads can read it without locking (see version_channel). The snapshot itself is still single-threaded.
+		void publish_to(std::shared_ptr<version_channel> channel)
+		{
+			channel_ = std::move(channel);
+			publish();
+		}
+
+		[[nodiscard]] auto channel() const -> const std::shared_ptr<version_channel> & { return channel_; }
+
+		// Keeps the use of each TID and CPU over the last config.depth updates, from the next update on.
+		// With config.smooth_loads, the loads are computed from the EWMA of the use, so bursty TIDs do not swing.
+		void enable_history(const history_config config)
+		{
+			history_.emplace(config, static_cast<std::size_t>(topology_.max_cpu()) + 1);
+		}
+
+		void disable_history() { history_.reset(); }
+
+		[[nodiscard]] auto has_history() const -> bool { return history_.has_value(); }
+
+		[[nodiscard]] auto history() const -> const usage_history & { return history_.value(); }
+
+		// EWMA of the use of the TID, or its last use if there is no history of it
+		[[nodiscard]] auto smoothed_use(const pid_t pid) const -> float
+		{
+			if (history_)
+			{
+				if (const auto series = history_->of_task(pid); not series.empty()) { return series.ewma(); }
+			}
+			return processes_.cpu_use(pid);
+		}
+
+		// EWMA of the use of the CPU, or its last use if there is no history
+		[[nodiscard]] auto smoothed_cpu_use(const cpu_t cpu) const -> float
+		{
+			if (history_)
+			{
+				if (const auto series = history_->of_cpu(cpu); not series.empty()) { return series.ewma(); }
+			}
+			return cpu_use(cpu);
+		}
+
+		// Applies the migrations. A failed migration (e.g. the TID exited) does not abort the others: it is reported
+		// and, when promoting, the TID stays where it was.
+		auto commit(const commit_policy policy = commit_policy::rescan) -> commit_report
+		{
+			commit_report report;
+
+			// If the snapshot is not dirty (nothing to change), only move the memory left by the previous commits
+			if (not dirty_)
+			{
+				if (not memory_migrations_.empty()) { report.memory = migrate_memory(); }
+				return report;
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+
+			report.results = apply_migrations();
+
+			if (sampler_)
+			{
+				for (const auto & result : report.results)
+				{
+					if (result.status == migration_status::applied) { sampler_->migrated(result.pid); }
+				}
+			}
+
+			// The threads move first, so the pages they touch meanwhile are already allocated on the new node
+			if (memory_migration_)
+			{
+				queue_memory_migrations(report.results);
+				report.memory = migrate_memory();
+			}
+
+			cpu_migrations_.clear();
+			node_migrations_.clear();
+
+			dirty_ = false;
+
+			if (policy == commit_policy::promote)
+			{
+				for (const auto & result : report.results)
+				{
+					if (result.status != migration_status::applied)
+					{
+						move_dirty_pid(result.pid, original_processor(result.pid), original_numa_node(result.pid));
+					}
+				}
+
+				promote_dirty_state();
+				publish();
+			}
+			else { update(); }
+
+			report.elapsed = std::chrono::steady_clock::now() - start;
+
+			stats_.record(metric::commit, static_cast<double>(report.elapsed.count()));
+			stats_.record(metric::migrations_applied, static_cast<double>(report.applied()));
+			stats_.record(metric::migrations_failed, static_cast<double>(report.results.size() - report.applied()));
+
+			return report;
+		}
+
+		// Reads the use of the hot TIDs on every update, and of the cold ones round-robin over config.period updates,
+		// keeping their last use in between (see hot_set_sampler). Needs a source that can read some TIDs only (e.g.
+		// procfs_processes, see sampled_snapshot).
+		void enable_sampling(const sampling_config config = {})
+		    requires sampled_source<Processes>
+		{
+			sampler_.emplace(config);
+		}
+
+		void disable_sampling() { sampler_.reset(); }
+
+		[[nodiscard]] auto sampling() const -> const std::optional<hot_set_sampler> & { return sampler_; }
+
+		// Updates since the use of the TID was read (always 0 without sampling)
+		[[nodiscard]] auto sample_age(const pid_t pid) const -> std::uint64_t
+		{
+			return sampler_ ? sampler_->age(pid) : 0;
+		}
+
+		// Follows the forks, execs and exits of the kernel from the next updates on, so the membership of the maps
+		// costs O(events) instead of sweeps over the maps (the scan still refreshes the use of every task).
+		// Returns false, and keeps the sweeps, if the kernel refuses the subscription (e.g. without CAP_NET_ADMIN).
+		auto enable_task_events() -> bool
+		{
+			auto events = std::make_shared<proc_events>();
+			if (not events->available()) { return false; }
+
+			proc_events_ = std::move(events);
+
+			// What happened before the subscription is only known from the next sweeps
+			task_events_.clear();
+			task_events_.lost = true;
+
+			return true;
+		}
+
+		void disable_task_events()
+		{
+			proc_events_.reset();
+			task_events_.clear();
+		}
+
+		[[nodiscard]] auto tracks_task_events() const -> bool { return proc_events_ != nullptr; }
+
+		// Collects the NUMA faults of the TIDs that use at least config.min_use on every update, along with the memory
+		// of their processes (config.memory) and the NUMA counters of the system. The rest have no locality.
+		void enable_locality(const locality_config config = {})
+		{
+			locality_config_ = config;
+			numa_activity_   = {};
+
+			if constexpr (not locality_source<Processes>) { numa_counters_ = numa_counters::read_system(); }
+		}
+
+		void disable_locality()
+		{
+			locality_config_.reset();
+			locality_.clear();
+		}
+
+		[[nodiscard]] auto locality() const -> const std::optional<locality_config> & { return locality_config_; }
+
+		// Locality of the TID as of the last update (nullptr if it was not busy enough to be collected)
+		[[nodiscard]] auto locality_of(const pid_t pid) const -> const task_locality *
+		{
+			const auto it = locality_.find(pid);
+			return it == locality_.end() ? nullptr : &it->second;
+		}
+
+		// Fraction of the memory accesses of the TID that would be local on the node (1 if unknown, see task_locality)
+		[[nodiscard]] auto locality_on(const pid_t pid, const node_t node) const -> float
+		{
+			const auto * found = locality_of(pid);
+			return found == nullptr ? 1.0F : found->on(node);
+		}
+
+		// NUMA counters of the system as of the last update, and their growth since the update before
+		// (e.g. numa_activity().fault_locality()). Always zero for sources that do not represent real tasks.
+		[[nodiscard]] auto numa_totals() const -> const numa_counters & { return numa_counters_; }
+
+		[[nodiscard]] auto numa_activity() const -> const numa_counters & { return numa_activity_; }
+
+		// Keeps the threads, use, load and threads per node of each process and cgroup, computed along with the loads
+		// and kept up to date by the migrations, so whole applications can be queried in O(1) and migrated at once.
+		// The groups of each TID are read once, when it first appears.
+		void enable_groups(const grouping_config config = {})
+		{
+			clear_groups();
+			grouping_ = config;
+			aggregate_groups();
+		}
+
+		void disable_groups()
+		{
+			grouping_.reset();
+			clear_groups();
+		}
+
+		[[nodiscard]] auto grouping() const -> const std::optional<grouping_config> & { return grouping_; }
+
+		// Aggregates of the process, after the (uncommitted) migrations (nullptr if none of its TIDs is managed)
+		[[nodiscard]] auto thread_group(const pid_t tgid) const -> const task_group *
+		{
+			const auto it = thread_groups_.find(tgid);
+			return it == thread_groups_.end() ? nullptr : &it->second;
+		}
+
+		// Aggregates of the cgroup, after the (uncommitted) migrations (nullptr if none of its TIDs is managed).
+		// Only the cgroup itself: the TIDs of its descendants belong to theirs.
+		[[nodiscard]] auto cgroup(const std::string & path) const -> const task_group *
+		{
+			const auto id = cgroup_ids_.find(path);
+			if (id == cgroup_ids_.end()) { return nullptr; }
+
+			const auto it = cgroups_.find(id->second);
+			return it == cgroups_.end() ? nullptr : &it->second;
+		}
+
+		[[nodiscard]] auto thread_groups() const -> const auto & { return thread_groups_; }
+
+		// Paths of the cgroups of the TIDs seen since the last pruning (some may have no managed TID anymore)
+		[[nodiscard]] auto cgroup_paths() const { return cgroup_ids_ | ranges::views::keys; }
+
+		// Moves the memory of the TIDs migrated to another node along with their threads, in commit(). Each commit
+		// moves at most the byte and page budgets of the configuration, even within a process: the rest waits for the
+		// next commits.
+		void enable_memory_migration(const memory_migration_config config = {}) { memory_migration_ = config; }
+
+		void disable_memory_migration()
+		{
+			memory_migration_.reset();
+			memory_migrations_.clear();
+			memory_queued_.clear();
+		}
+
+		[[nodiscard]] auto memory_migration() const -> const std::optional<memory_migration_config> &
+		{
+			return memory_migration_;
+		}
+
+		// Processes whose memory is still waiting to be moved (or is partly moved)
+		[[nodiscard]] auto pending_memory_migrations() const -> std::size_t { return memory_migrations_.size(); }
+
+		// Resident memory of the process of the TID on each node (/proc/<pid>/numa_maps, read on each call)
+		[[nodiscard]] auto memory_of(const pid_t pid) const -> numa_footprint
+		{
+			if constexpr (memory_handler<Processes>) { return processes_.numa_footprint(pid); }
+			else { return numa_footprint::read(pid); }
+		}
+
+		void rollback()
+		{
+			cpu_migrations_.clear();
+			node_migrations_.clear();
+
+			// The groups follow the migrations, so they go back with them
+			if (grouping_)
+			{
+				for (const auto & [pid, node] : dirty_pid_node_map_)
+				{
+					move_in_groups(pid, node, original_numa_node(pid));
+				}
+			}
+
+			clear_dirty_overlay();
+
+			dirty_ = false;
+		}
+
+		[[nodiscard]] auto process(const pid_t pid) -> auto & { return processes_.find(pid); }
+
+		[[nodiscard]] auto process(const pid_t pid) const -> const auto & { return processes_.find(pid); }
+
+		[[nodiscard]] auto processor(const pid_t pid) const -> cpu_t
+		{
+			const auto it = dirty_pid_cpu_map_.find(pid);
+			return it == dirty_pid_cpu_map_.end() ? original_processor(pid) : it->second;
+		}
+
+		[[nodiscard]] auto original_processor(const pid_t pid) const -> cpu_t { return pid_placement_map_.at(pid).cpu; }
+
+		[[nodiscard]] auto numa_node(const pid_t pid) const -> node_t
+		{
+			const auto it = dirty_pid_node_map_.find(pid);
+			return it == dirty_pid_node_map_.end() ? original_numa_node(pid) : it->second;
+		}
+
+		[[nodiscard]] auto original_numa_node(const pid_t pid) const -> node_t
+		{
+			return pid_placement_map_.at(pid).node;
+		}
+
+		// TIDs in the CPU after the (uncommitted) migrations: the committed TIDs that stayed, plus the migrated ones
+		[[nodiscard]] auto pids_in_cpu(const cpu_t cpu) const
+		{
+			const auto stayed = [this, cpu](const pid_t pid) {
+				const auto it = dirty_pid_cpu_map_.find(pid);
+				return it == dirty_pid_cpu_map_.end() or it->second == cpu;
+			};
+
+			const auto arrived = [this, cpu](const auto & pid_cpu) {
+				return pid_cpu.second == cpu and original_processor(pid_cpu.first) != cpu;
+			};
+
+			return ranges::views::concat(original_pids_in_cpu(cpu) | ranges::views::filter(stayed),
+			                             dirty_pid_cpu_map_ | ranges::views::filter(arrived) | ranges::views::keys);
+		}
+
+		// TIDs in the node after the (uncommitted) migrations: the committed TIDs that stayed, plus the migrated ones
+		[[nodiscard]] auto pids_in_node(const node_t node) const
+		{
+			const auto stayed = [this, node](const pid_t pid) {
+				const auto it = dirty_pid_node_map_.find(pid);
+				return it == dirty_pid_node_map_.end() or it->second == node;
+			};
+
+			const auto arrived = [this, node](const auto & pid_node) {
+				return pid_node.second == node and original_numa_node(pid_node.first) != node;
+			};
+
+			return ranges::views::concat(original_pids_in_node(node) | ranges::views::filter(stayed),
+			                             dirty_pid_node_map_ | ranges::views::filter(arrived) | ranges::views::keys);
+		}
+
+		[[nodiscard]] auto original_pids_in_cpu(const cpu_t cpu) const -> std::span<const pid_t>
+		{
+			return cpu_pid_map_[idx(cpu)];
+		}
+
+		[[nodiscard]] auto original_pids_in_node(const node_t node) const -> std::span<const pid_t>
+		{
+			return node_pid_map_[idx(node)];
+		}
+
+		// Use and load of each committed TID of the CPU, in the same order as original_pids_in_cpu()
+		[[nodiscard]] auto original_use_in_cpu(const cpu_t cpu) const -> std::span<const float>
+		{
+			return cpu_pid_use_.at(idx(cpu));
+		}
+
+		[[nodiscard]] auto original_loads_in_cpu(const cpu_t cpu) const -> std::span<const float>
+		{
+			return cpu_pid_load_.at(idx(cpu));
+		}
+
+		// Migrations that the next commit() will apply. A TID in both maps is pinned to the node.
+		[[nodiscard]] auto pending_cpu_migrations() const -> const auto & { return cpu_migrations_; }
+
+		[[nodiscard]] auto pending_node_migrations() const -> const auto & { return node_migrations_; }
+
+		[[nodiscard]] auto cpu_use(const cpu_t cpu) const { return cpu_use_.at(idx(cpu)); }
+
+		[[nodiscard]] auto node_use(const node_t node) const { return node_use_.at(idx(node)); }
+
+		// Use of the CPU by the tasks out of the scope, which do not get a load nor can be migrated
+		[[nodiscard]] auto foreign_use(const cpu_t cpu) const { return foreign_cpu_use_.at(idx(cpu)); }
+
+		// The load model, e.g. to set the half-life of decayed_load
+		[[nodiscard]] auto model() -> Load & { return model_; }
+
+		[[nodiscard]] auto model() const -> const Load & { return model_; }
+
+		// Nice of the TID (from the source if it knows it, getpriority(2) otherwise)
+		[[nodiscard]] auto nice_of(const pid_t pid) const -> int
+		{
+			if constexpr (niced_source<Processes>) { return processes_.nice(pid); }
+			else { return read_nice(pid); }
+		}
+
+		[[nodiscard]] auto load_of(const pid_t pid) const -> float
+		{
+			const auto & where = pid_placement_map_.at(pid);
+			return cpu_pid_load_.at(idx(where.cpu)).at(where.cpu_slot);
+		}
+
+		// Load of the CPU after the (uncommitted) migrations
+		[[nodiscard]] auto load_of_cpu(const cpu_t cpu) const
+		{
+			const auto it = dirty_cpu_load_.find(cpu);
+			return original_load_of_cpu(cpu) + (it == dirty_cpu_load_.end() ? 0.0F : it->second);
+		}
+
+		// Least loaded CPU of the node after the (uncommitted) migrations (-1 if the node has no CPUs).
+		// Cost: O(1), the index is updated on every migration.
+		[[nodiscard]] auto least_loaded_cpu(const node_t node) const -> cpu_t
+		{
+			return least_loaded_.least_loaded(node);
+		}
+
+		// The k least loaded CPUs of the node after the (uncommitted) migrations, the least loaded first.
+		// Cost: O(log CPUs + k)
+		[[nodiscard]] auto least_loaded_cpus(const node_t node, const std::size_t k) const -> std::vector<cpu_t>
+		{
+			return least_loaded_.least_loaded(node, k);
+		}
+
+		// Load of the node after the (uncommitted) migrations
+		[[nodiscard]] auto load_of_node(const node_t node) const
+		{
+			const auto it = dirty_node_load_.find(node);
+			return original_load_of_node(node) + (it == dirty_node_load_.end() ? 0.0F : it->second);
+		}
+
+		[[nodiscard]] auto original_load_of_cpu(const cpu_t cpu) const -> float { return cpu_load_.at(idx(cpu)); }
+
+		[[nodiscard]] auto original_load_of_node(const node_t node) const -> float
+		{
+			return node_load_.at(idx(node));
+		}
+
+		// Use of the CPUs of a core, cache or package (see cpu_hierarchy)
+		[[nodiscard]] auto domain_use(const domain_level level, const domain_t domain) const -> float
+		    requires hierarchical_topology<Topology>
+		{
+			return domain_use_.at(level_index(level)).at(idx(domain));
+		}
+
+		// Load of the CPUs of a core, cache or package after the (uncommitted) migrations
+		[[nodiscard]] auto load_of_domain(const domain_level level, const domain_t domain) const -> float
+		    requires hierarchical_topology<Topology>
+		{
+			auto load = original_load_of_domain(level, domain);
+			if (dirty_cpu_load_.empty()) { return load; }
+
+			for (const auto cpu : topology_.hierarchy().cpus_in_domain(level, domain))
+			{
+				const auto it = dirty_cpu_load_.find(cpu);
+				if (it != dirty_cpu_load_.end()) { load += it->second; }
+			}
+			return load;
+		}
+
+		[[nodiscard]] auto original_load_of_domain(const domain_level level, const domain_t domain) const -> float
+		    requires hierarchical_topology<Topology>
+		{
+			return domain_load_.at(level_index(level)).at(idx(domain));
+		}
+
+		// Migrations move load around, so the load of the whole system does not change until the next update
+		[[nodiscard]] auto load_system() const { return system_load_; }
+
+		void migrate_to_cpu(const pid_t pid, const cpu_t cpu)
+		{
+			dirty_ = true;
+
+			move_dirty_pid(pid, cpu, topology_.node_from_cpu(cpu));
+
+			cpu_migrations_[pid] = cpu;
+		}
+
+		// The TID is pinned to the CPUs of the node, and accounted to its least loaded CPU
+		void migrate_to_node(const pid_t pid, const node_t node)
+		{
+			const auto cpu = least_loaded_cpu(node);
+			if (cpu < 0) { throw std::invalid_argument(fmt::format("Node {} has no CPUs", node)); }
+
+			dirty_ = true;
+
+			move_dirty_pid(pid, cpu, node);
+
+			node_migrations_[pid] = node;
+		}
+
+		// Migrates every managed TID of the process to the node, each one accounted to the least loaded CPU of the
+		// node at its turn. Cost: O(threads of the process)
+		void migrate_thread_group_to_node(const pid_t tgid, const node_t node)
+		{
+			if (const auto * group = thread_group(tgid); group != nullptr)
+			{
+				for (const auto pid : group->threads)
+				{
+					migrate_to_node(pid, node);
+				}
+			}
+		}
+
+		// Same, for every managed TID of the cgroup
+		void migrate_cgroup_to_node(const std::string & path, const node_t node)
+		{
+			if (const auto * group = cgroup(path); group != nullptr)
+			{
+				for (const auto pid : group->threads)
+				{
+					migrate_to_node(pid, node);
+				}
+			}
+		}
+
+		void unpin(const pid_t pid) { processes_.unpin(pid); }
+
+		void unpin() { processes_.unpin(); }
+	};
+
+	using snapshot = basic_snapshot<>;
+
+	// Snapshot of the live system that can sample the use of its tasks (see enable_sampling())
+	using sampled_snapshot = basic_snapshot<procfs_processes>;
+} // namespace syssnap
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace syssnap
+{
+	// Fixed pool of worker threads to run data-parallel loops.
+	// parallel_for() hands out the indices through an atomic counter, so there are no locks in the work itself.
+	// The calling thread takes part in the loop, so a pool of N threads has N - 1 workers.
+	class thread_pool
+	{
+	private:
+		std::vector<std::jthread> workers_;
+
+		std::mutex              submit_mutex_; // Only one loop at a time
+		std::mutex              mutex_;
+		std::condition_variable job_cv_;
+		std::condition_variable done_cv_;
+
+		std::function<void(std::size_t)> job_;
+		std::size_t                      tasks_{ 0 };
+		std::atomic<std::size_t>         next_{ 0 };
+		std::size_t                      active_{ 0 };
+		std::uint64_t                    generation_{ 0 };
+		bool                             stop_{ false };
+
+		std::exception_ptr error_;
+
+		void run_tasks()
+		{
+			for (auto i = next_.fetch_add(1); i < tasks_; i = next_.fetch_add(1))
+			{
+				try
+				{
+					job_(i);
+				}
+				catch (...)
+				{
+					const std::lock_guard lock{ mutex_ };
+					if (not error_) { error_ = std::current_exception(); }
+				}
+			}
+		}
+
+		void work()
+		{
+			std::uint64_t seen = 0;
+
+			while (true)
+			{
+				{
+					std::unique_lock lock{ mutex_ };
+					job_cv_.wait(lock, [&] { return stop_ or generation_ != seen; });
+					if (stop_) { return; }
+					seen = generation_;
+				}
+
+				run_tasks();
+
+				{
+					const std::lock_guard lock{ mutex_ };
+					--active_;
+				}
+				done_cv_.notify_one();
+			}
+		}
+
+	public:
+		explicit thread_pool(const std::size_t threads)
+		{
+			const auto workers = threads > 1 ? threads - 1 : 0;
+
+			workers_.reserve(workers);
+			for (std::size_t i = 0; i < workers; ++i)
+			{
+				workers_.emplace_back([this] { work(); });
+			}
+		}
+
+		thread_pool(const thread_pool &)                     = delete;
+		thread_pool(thread_pool &&)                          = delete;
+		auto operator=(const thread_pool &) -> thread_pool & = delete;
+		auto operator=(thread_pool &&) -> thread_pool &      = delete;
+
+		~thread_pool()
+		{
+			{
+				const std::lock_guard lock{ mutex_ };
+				stop_ = true;
+			}
+			job_cv_.notify_all();
+		}
+
+		[[nodiscard]] auto size() const -> std::size_t { return workers_.size() + 1; }
+
+		// Calls f(i) for every i in [0, n) and waits until all of them are done.
+		// The first exception thrown by f is rethrown here.
+		template<typename F>
+		void parallel_for(const std::size_t n, F && f)
+		{
+			const std::lock_guard submit_lock{ submit_mutex_ };
+
+			{
+				const std::lock_guard lock{ mutex_ };
+				job_    = std::ref(f);
+				tasks_  = n;
+				active_ = workers_.size();
+				error_  = nullptr;
+				next_.store(0);
+				++generation_;
+			}
+			job_cv_.notify_all();
+
+			run_tasks();
+
+			std::unique_lock lock{ mutex_ };
+			done_cv_.wait(lock, [&] { return active_ == 0; });
+
+			job_ = nullptr;
+			if (error_) { std::rethrow_exception(std::exchange(error_, nullptr)); }
+		}
+	};
+} // namespace syssnap
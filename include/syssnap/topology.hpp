@@ -12,6 +12,8 @@
 
 #include <tabulate/table.hpp>
 
+#include "bitset.hpp"
+#include "hierarchy.hpp"
 #include "types.hpp"
 
 namespace syssnap
@@ -30,10 +32,18 @@ namespace syssnap
 		std::vector<node_t>             cpu_node_map_; // input: CPU,  output: node
 		std::vector<std::vector<cpu_t>> node_cpu_map_; // input: node, output: list of CPUs
 
+		// Same as cpus_ and node_cpu_map_, as sets for the set algebra and the affinity masks
+		cpu_bitset              cpu_set_;      // all the allowed CPUs
+		std::vector<cpu_bitset> node_cpu_set_; // input: node, output: set of CPUs
+
+		// Cores, caches and packages of the CPUs
+		cpu_hierarchy hierarchy_;
+
 		void detect_system_UMA()
 		{
-			nodes_ = { node_t{ 0 } };
-			cpus_  = allowed_cpus();
+			nodes_   = { node_t{ 0 } };
+			cpu_set_ = allowed_cpu_set();
+			cpus_    = cpu_set_.to_vector();
 
 			// disable implicit conversion temporarily
 			// NOLINTBEGIN
@@ -44,6 +54,9 @@ namespace syssnap
 			node_cpu_map_.resize(size_nodes, {});
 			node_cpu_map_.at(0) = cpus_;
 
+			node_cpu_set_.resize(size_nodes, {});
+			node_cpu_set_.at(0) = cpu_set_;
+
 			cpu_node_map_.resize(size_cpus, nodes_.front());
 
 			// Compute the lists of nodes sorted by distance from a given node...
@@ -54,28 +67,34 @@ namespace syssnap
 
 		void detect_system_NUMA()
 		{
-			nodes_ = allowed_nodes();
-			cpus_  = allowed_cpus();
+			nodes_   = allowed_nodes();
+			cpu_set_ = allowed_cpu_set();
+			cpus_    = cpu_set_.to_vector();
 
 			const auto size_cpus  = static_cast<std::size_t>(max_cpu() + 1); // NOLINT
 			const auto size_nodes = static_cast<std::size_t>(max_node() + 1); // NOLINT
 
+			// The allowed CPUs are read once, and each node only masks them with its own CPUs
 			node_cpu_map_.resize(size_nodes, {});
+			node_cpu_set_.resize(size_nodes, {});
+			cpu_node_map_.resize(size_cpus, 0);
 			for (const auto node : nodes_)
 			{
-				node_cpu_map_.at(idx(node)) = detect_cpus_from_node(node);
-				if (node_cpu_map_.at(idx(node)).empty())
+				auto & cpu_set = node_cpu_set_.at(idx(node));
+
+				cpu_set = detect_cpu_set_from_node(node, cpu_set_);
+				if (cpu_set.empty())
 				{
 					const auto error = fmt::format("Error retrieving cpus from node {}", node);
 					throw std::runtime_error(error);
 				}
-			}
 
-			// For each CPU, reads topology file to get package (node) id
-			cpu_node_map_.resize(size_cpus, 0);
-			for (const auto cpu : cpus_)
-			{
-				cpu_node_map_.at(idx(cpu)) = numa_node_of_cpu(cpu);
+				node_cpu_map_.at(idx(node)) = cpu_set.to_vector();
+
+				for (const auto cpu : cpu_set)
+				{
+					cpu_node_map_.at(idx(cpu)) = node;
+				}
 			}
 
 			// Compute the lists of nodes sorted by distance from a given node...
@@ -106,6 +125,8 @@ namespace syssnap
 		{
 			if (std::cmp_less(numa_available(), 0)) { detect_system_UMA(); }
 			else { detect_system_NUMA(); }
+
+			hierarchy_ = cpu_hierarchy::detect(cpus_);
 		}
 
 	public:
@@ -118,25 +139,28 @@ namespace syssnap
 
 		[[nodiscard]] static auto max_cpu() -> cpu_t
 		{
-			static const auto MAX_CPU = ranges::max(allowed_cpus());
+			static const auto MAX_CPU = allowed_cpu_set().last();
 			return MAX_CPU;
 		}
 
-		[[nodiscard]] static auto allowed_cpus() -> std::vector<cpu_t>
+		// Copies a libnuma mask into a set (CPUs beyond MAX_CPUS are not supported)
+		[[nodiscard]] static auto to_cpu_set(const bitmask * mask) -> cpu_bitset
 		{
-			std::vector<cpu_t> allowed_cpus;
+			cpu_bitset cpus;
 
-			for (const auto cpu : ranges::views::indices(0U, static_cast<uint32_t>(numa_all_cpus_ptr->size)))
+			const auto size = std::min<std::size_t>(mask->size, MAX_CPUS);
+			for (const auto cpu : ranges::views::indices(0U, static_cast<uint32_t>(size)))
 			{
-				if (std::cmp_not_equal(numa_bitmask_isbitset(numa_all_cpus_ptr, cpu), 0))
-				{
-					allowed_cpus.emplace_back(cpu);
-				}
+				if (std::cmp_not_equal(numa_bitmask_isbitset(mask, cpu), 0)) { cpus.insert(static_cast<cpu_t>(cpu)); }
 			}
 
-			return allowed_cpus;
+			return cpus;
 		}
 
+		[[nodiscard]] static auto allowed_cpu_set() -> cpu_bitset { return to_cpu_set(numa_all_cpus_ptr); }
+
+		[[nodiscard]] static auto allowed_cpus() -> std::vector<cpu_t> { return allowed_cpu_set().to_vector(); }
+
 		[[nodiscard]] static auto allowed_nodes() -> std::vector<node_t>
 		{
 			std::vector<node_t> allowed_nodes;
@@ -156,10 +180,10 @@ namespace syssnap
 			return allowed_nodes;
 		}
 
-		[[nodiscard]] static auto detect_cpus_from_node(const node_t node) -> std::vector<cpu_t>
+		// Allowed CPUs of the node
+		[[nodiscard]] static auto detect_cpu_set_from_node(const node_t node, const cpu_bitset & allowed_cpus)
+		    -> cpu_bitset
 		{
-			std::vector<cpu_t> cpus_in_node;
-
 			bitmask * cpus_bm = numa_allocate_cpumask();
 
 			if (std::cmp_equal(numa_node_to_cpus(static_cast<int>(node), cpus_bm), -1))
@@ -169,21 +193,18 @@ namespace syssnap
 				throw std::runtime_error(error);
 			}
 
-			const auto allowed_cpus = topology::allowed_cpus();
-
-			for (const auto cpu : ranges::views::indices(0U, static_cast<uint32_t>(cpus_bm->size)))
-			{
-				if (std::cmp_not_equal(numa_bitmask_isbitset(cpus_bm, cpu), 0) and ranges::contains(allowed_cpus, cpu))
-				{
-					cpus_in_node.emplace_back(cpu);
-				}
-			}
+			const auto cpus_in_node = to_cpu_set(cpus_bm) & allowed_cpus;
 
 			numa_free_cpumask(cpus_bm);
 
 			return cpus_in_node;
 		}
 
+		[[nodiscard]] static auto detect_cpus_from_node(const node_t node) -> std::vector<cpu_t>
+		{
+			return detect_cpu_set_from_node(node, allowed_cpu_set()).to_vector();
+		}
+
 		topology() { detect_system(); }
 
 		[[nodiscard]] auto num_of_cpus() const -> size_t { return cpus_.size(); }
@@ -223,6 +244,15 @@ namespace syssnap
 			return cpu_node_map_.at(idx(cpu));
 		}
 
+		[[nodiscard]] auto cpu_set() const -> const cpu_bitset & { return cpu_set_; }
+
+		[[nodiscard]] auto node_cpu_set(const node_t node) const -> const cpu_bitset &
+		{
+			return node_cpu_set_.at(idx(node));
+		}
+
+		[[nodiscard]] auto hierarchy() const -> const cpu_hierarchy & { return hierarchy_; }
+
 		[[nodiscard]] auto ith_cpu_from_node(const node_t node, const std::unsigned_integral auto i) const -> int
 		{
 			return node_cpu_map_.at(node).at(i);
@@ -233,6 +263,12 @@ namespace syssnap
 			os << "Detected system: " << topo.num_of_cpus() << " total CPUs, " << topo.num_of_nodes()
 			   << " memory nodes." << '\n';
 
+			const auto & hierarchy = topo.hierarchy();
+			os << hierarchy.num_of_domains(domain_level::core) << " cores, "
+			   << hierarchy.num_of_domains(domain_level::l2) << " L2 caches, "
+			   << hierarchy.num_of_domains(domain_level::l3) << " L3 caches, "
+			   << hierarchy.num_of_domains(domain_level::package) << " packages." << '\n';
+
 			os << '\n';
 
 			// Print distance table
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+namespace syssnap::test
+{
+	// Snapshot over the synthetic sources, with any load model and instrumentation
+	template<load_model Load = sigmoid_load, snapshot_instrumentation Stats = snapshot_stats>
+	using basic_synthetic_snapshot = basic_snapshot<synthetic_processes, synthetic_topology, Stats, Load>;
+
+	using synthetic_snapshot = basic_synthetic_snapshot<>;
+
+	// Snapshot of the tasks of the configuration spread over the topology (deterministic for a given seed)
+	template<typename Snapshot = synthetic_snapshot>
+	auto make_snapshot(const synthetic_config & config, const synthetic_topology & topo, const std::size_t workers = 1,
+	                   scope managed = {}) -> Snapshot
+	{
+		return Snapshot(synthetic_processes(topo, config), topo, workers, std::move(managed));
+	}
+} // namespace syssnap::test
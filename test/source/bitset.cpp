@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include <syssnap/affinity.hpp>
+#include <syssnap/bitset.hpp>
+#include <syssnap/synthetic.hpp>
+
+using syssnap::cpu_bitset;
+using syssnap::cpu_t;
+
+TEST(bitset, insert_erase_contains)
+{
+	cpu_bitset cpus;
+	EXPECT_TRUE(cpus.empty());
+	EXPECT_EQ(cpus.first(), cpu_bitset::NONE);
+	EXPECT_EQ(cpus.last(), cpu_bitset::NONE);
+
+	cpus.insert(3);
+	cpus.insert(64);
+	cpus.insert(4095);
+
+	EXPECT_FALSE(cpus.empty());
+	EXPECT_EQ(cpus.count(), 3U);
+	EXPECT_TRUE(cpus.contains(64));
+	EXPECT_FALSE(cpus.contains(63));
+	EXPECT_FALSE(cpus.contains(-1));
+	EXPECT_FALSE(cpus.contains(4096));
+
+	cpus.erase(64);
+	EXPECT_FALSE(cpus.contains(64));
+	EXPECT_EQ(cpus.count(), 2U);
+
+	EXPECT_THROW(cpus.insert(4096), std::out_of_range);
+	EXPECT_THROW(cpus.insert(-1), std::out_of_range);
+}
+
+TEST(bitset, first_next_last)
+{
+	const cpu_bitset cpus(std::vector<cpu_t>{ 1, 63, 64, 200, 1'000 });
+
+	EXPECT_EQ(cpus.first(), 1);
+	EXPECT_EQ(cpus.next(1), 63);
+	EXPECT_EQ(cpus.next(63), 64);
+	EXPECT_EQ(cpus.next(64), 200);
+	EXPECT_EQ(cpus.next(500), 1'000);
+	EXPECT_EQ(cpus.next(1'000), cpu_bitset::NONE);
+	EXPECT_EQ(cpus.last(), 1'000);
+
+	EXPECT_EQ(cpus.to_vector(), (std::vector<cpu_t>{ 1, 63, 64, 200, 1'000 }));
+
+	std::vector<cpu_t> iterated;
+	for (const auto cpu : cpus)
+	{
+		iterated.emplace_back(cpu);
+	}
+	EXPECT_EQ(iterated, cpus.to_vector());
+}
+
+TEST(bitset, set_algebra)
+{
+	const cpu_bitset a(std::vector<cpu_t>{ 0, 1, 2, 100, 2'000 });
+	const cpu_bitset b(std::vector<cpu_t>{ 2, 3, 100, 3'000 });
+
+	EXPECT_EQ((a & b).to_vector(), (std::vector<cpu_t>{ 2, 100 }));
+	EXPECT_EQ((a | b).to_vector(), (std::vector<cpu_t>{ 0, 1, 2, 3, 100, 2'000, 3'000 }));
+	EXPECT_EQ((a - b).to_vector(), (std::vector<cpu_t>{ 0, 1, 2'000 }));
+
+	EXPECT_TRUE(a.intersects(b));
+	EXPECT_FALSE((a - b).intersects(b));
+
+	EXPECT_EQ(a & b, b & a);
+	EXPECT_NE(a, b);
+}
+
+TEST(bitset, topology_sets)
+{
+	const syssnap::synthetic_topology topo(1'024, 4);
+
+	EXPECT_EQ(topo.cpu_set().count(), 1'024U);
+	EXPECT_EQ(topo.cpu_set().to_vector(), topo.cpus());
+
+	cpu_bitset all;
+	for (const auto node : topo.nodes())
+	{
+		const auto & cpus = topo.node_cpu_set(node);
+		EXPECT_EQ(cpus.to_vector(), topo.cpus_from_node(node));
+		EXPECT_FALSE(all.intersects(cpus));
+		all |= cpus;
+	}
+	EXPECT_EQ(all, topo.cpu_set());
+}
+
+TEST(bitset, affinity_mask)
+{
+	const cpu_bitset cpus(std::vector<cpu_t>{ 0, 5, 130 });
+	const syssnap::cpu_mask mask(cpus);
+
+	EXPECT_TRUE(mask.contains(0));
+	EXPECT_TRUE(mask.contains(130));
+	EXPECT_FALSE(mask.contains(6));
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <syssnap/groups.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	using syssnap::test::synthetic_snapshot;
+
+	// Processes of 4 threads over 3 cgroups, on 2 nodes of 8 CPUs
+	auto grouped(const float moves, const float churn)
+	{
+		syssnap::synthetic_config config;
+		config.tasks               = 1'000;
+		config.usage               = syssnap::usage_distribution::uniform;
+		config.moves_per_update    = moves;
+		config.churn_per_update    = churn;
+		config.threads_per_process = 4;
+		config.cgroups             = 3;
+
+		return syssnap::test::make_snapshot(config, { 16, 2 });
+	}
+
+	// Each process in a cgroup of its own, as with transient scopes and containers
+	class transient_cgroups : public syssnap::synthetic_processes
+	{
+	public:
+		using synthetic_processes::synthetic_processes;
+
+		[[nodiscard]] auto cgroup(const pid_t pid) const -> std::string
+		{
+			return "/transient/" + std::to_string(thread_group(pid));
+		}
+	};
+
+	// Aggregates of a group, added up thread by thread
+	struct expected_group
+	{
+		std::size_t              threads{ 0 };
+		float                    use{ 0.0F };
+		float                    load{ 0.0F };
+		std::vector<std::size_t> threads_on = std::vector<std::size_t>(2, 0);
+	};
+
+	void expect_group(const syssnap::task_group * group, const expected_group & expected)
+	{
+		ASSERT_NE(group, nullptr);
+		EXPECT_EQ(group->size(), expected.threads);
+		EXPECT_NEAR(group->use, expected.use, 1e-2F);
+		EXPECT_NEAR(group->load, expected.load, 1e-2F);
+		EXPECT_EQ(group->threads_on_node(0), expected.threads_on[0]);
+		EXPECT_EQ(group->threads_on_node(1), expected.threads_on[1]);
+	}
+
+	void expect_groups(const synthetic_snapshot & snapshot)
+	{
+		std::map<pid_t, expected_group>       processes;
+		std::map<std::string, expected_group> cgroups;
+
+		for (const auto & task : snapshot.processes())
+		{
+			const auto pid = task.pid();
+
+			for (auto * group : { &processes[snapshot.processes().thread_group(pid)],
+			                      &cgroups[snapshot.processes().cgroup(pid)] })
+			{
+				++group->threads;
+				group->use += task.cpu_use();
+				group->load += snapshot.load_of(pid);
+				++group->threads_on.at(syssnap::idx(snapshot.numa_node(pid)));
+			}
+		}
+
+		EXPECT_EQ(snapshot.thread_groups().size(), processes.size());
+		for (const auto & [tgid, expected] : processes)
+		{
+			expect_group(snapshot.thread_group(tgid), expected);
+		}
+
+		EXPECT_EQ(cgroups.size(), 3U);
+		for (const auto & [path, expected] : cgroups)
+		{
+			expect_group(snapshot.cgroup(path), expected);
+		}
+	}
+} // namespace
+
+TEST(groups, aggregates_every_update)
+{
+	auto snapshot = grouped(0.1F, 0.05F);
+	EXPECT_FALSE(snapshot.grouping());
+	EXPECT_EQ(snapshot.thread_group(1), nullptr);
+
+	snapshot.enable_groups();
+	expect_groups(snapshot);
+
+	for (int i = 0; i < 5; ++i)
+	{
+		snapshot.update();
+		expect_groups(snapshot);
+	}
+
+	snapshot.rebuild(syssnap::rebuild_policy::full);
+	expect_groups(snapshot);
+
+	EXPECT_EQ(snapshot.cgroup("/elsewhere"), nullptr);
+
+	snapshot.disable_groups();
+	EXPECT_TRUE(snapshot.thread_groups().empty());
+}
+
+TEST(groups, follow_the_migrations)
+{
+	auto snapshot = grouped(0.0F, 0.0F);
+	snapshot.enable_groups();
+
+	const auto   tgid    = snapshot.processes().thread_group(snapshot.original_pids_in_node(0).front());
+	const auto * process = snapshot.thread_group(tgid);
+	ASSERT_NE(process, nullptr);
+	EXPECT_EQ(process->size(), 4U);
+
+	snapshot.migrate_thread_group_to_node(tgid, 1);
+	EXPECT_EQ(process->threads_on_node(1), 4U);
+	expect_groups(snapshot);
+
+	// Back to where the threads were
+	snapshot.rollback();
+	EXPECT_LT(process->threads_on_node(1), 4U);
+	expect_groups(snapshot);
+
+	snapshot.migrate_thread_group_to_node(tgid, 1);
+	static_cast<void>(snapshot.commit(syssnap::commit_policy::promote));
+	expect_groups(snapshot);
+
+	// The pinned threads stay on the node
+	snapshot.update();
+	EXPECT_EQ(snapshot.thread_group(tgid)->threads_on_node(1), 4U);
+	expect_groups(snapshot);
+}
+
+TEST(groups, cgroup_migration)
+{
+	auto snapshot = grouped(0.0F, 0.0F);
+	snapshot.enable_groups();
+
+	const auto * cgroup = snapshot.cgroup("/synthetic/1");
+	ASSERT_NE(cgroup, nullptr);
+
+	snapshot.migrate_cgroup_to_node("/synthetic/1", 0);
+	EXPECT_EQ(cgroup->threads_on_node(0), cgroup->size());
+	EXPECT_EQ(cgroup->threads_on_node(1), 0U);
+	EXPECT_EQ(snapshot.pending_node_migrations().size(), cgroup->size());
+	expect_groups(snapshot);
+
+	// Without the cgroups, only the processes are kept
+	snapshot.enable_groups({ true, false });
+	EXPECT_EQ(snapshot.cgroup("/synthetic/1"), nullptr);
+	EXPECT_FALSE(snapshot.thread_groups().empty());
+}
+
+TEST(groups, transient_cgroups_are_pruned)
+{
+	syssnap::synthetic_config config;
+	config.tasks               = 1'000;
+	config.moves_per_update    = 0.0F;
+	config.churn_per_update    = 0.2F;
+	config.threads_per_process = 4;
+
+	const syssnap::synthetic_topology topo(16, 2);
+
+	syssnap::basic_snapshot<transient_cgroups, syssnap::synthetic_topology> snapshot(transient_cgroups(topo, config),
+	                                                                                 topo);
+	snapshot.enable_groups();
+
+	std::set<pid_t> seen;
+	for (int i = 0; i < 200; ++i)
+	{
+		snapshot.update();
+
+		for (const auto & task : snapshot.processes())
+		{
+			seen.insert(snapshot.processes().thread_group(task.pid()));
+		}
+	}
+
+	// Only the cgroups of the TIDs since the last pruning are kept, not every cgroup seen
+	EXPECT_GT(seen.size(), 3 * config.tasks);
+	EXPECT_LE(static_cast<std::size_t>(ranges::distance(snapshot.cgroup_paths())), 3 * config.tasks);
+
+	// The cgroups of the processes that exited have no aggregates, the others have them all
+	EXPECT_EQ(snapshot.cgroup("/transient/1"), nullptr);
+	for (const auto & task : snapshot.processes())
+	{
+		const auto   tgid   = snapshot.processes().thread_group(task.pid());
+		const auto * cgroup = snapshot.cgroup("/transient/" + std::to_string(tgid));
+		ASSERT_NE(cgroup, nullptr);
+		EXPECT_EQ(cgroup->size(), snapshot.thread_group(tgid)->size());
+	}
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
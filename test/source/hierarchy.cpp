@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <syssnap/hierarchy.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	using syssnap::domain_level;
+
+	constexpr std::array LEVELS{ domain_level::core, domain_level::l2, domain_level::l3, domain_level::package };
+
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 1'000;
+		config.moves_per_update = 0.1F;
+
+		// 2 nodes of 8 CPUs: 2 threads per core, 2 cores per L3
+		return syssnap::test::make_snapshot(config, { 16, 2, 2, 2 });
+	}
+
+	void write_file(const std::filesystem::path & path, const std::string & content)
+	{
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream(path) << content << '\n';
+	}
+
+	// sysfs of 8 CPUs in one package: CPUs c and c+4 are SMT siblings (and share the L2), and cores 0-1 and 2-3
+	// share an L3
+	auto fake_sysfs()
+	{
+		const auto root = std::filesystem::temp_directory_path() / fmt::format("syssnap_sysfs_{}", getpid());
+		std::filesystem::remove_all(root);
+
+		for (int cpu = 0; cpu < 8; ++cpu)
+		{
+			const auto dir      = root / fmt::format("cpu{}", cpu);
+			const auto core     = cpu % 4;
+			const auto siblings = fmt::format("{},{}", core, core + 4);
+
+			write_file(dir / "topology" / "core_cpus_list", siblings);
+			write_file(dir / "topology" / "package_cpus_list", "0-7");
+
+			write_file(dir / "cache" / "index0" / "level", "1");
+			write_file(dir / "cache" / "index0" / "type", "Data");
+			write_file(dir / "cache" / "index0" / "shared_cpu_list", std::to_string(cpu));
+
+			write_file(dir / "cache" / "index2" / "level", "2");
+			write_file(dir / "cache" / "index2" / "type", "Unified");
+			write_file(dir / "cache" / "index2" / "shared_cpu_list", siblings);
+
+			write_file(dir / "cache" / "index3" / "level", "3");
+			write_file(dir / "cache" / "index3" / "type", "Unified");
+			write_file(dir / "cache" / "index3" / "shared_cpu_list", core < 2 ? "0-1,4-5" : "2-3,6-7");
+		}
+
+		return root;
+	}
+} // namespace
+
+TEST(hierarchy, parse_cpu_list)
+{
+	EXPECT_EQ(syssnap::parse_cpu_list("0-3,8,10-11"), (std::vector<syssnap::cpu_t>{ 0, 1, 2, 3, 8, 10, 11 }));
+	EXPECT_EQ(syssnap::parse_cpu_list("5"), (std::vector<syssnap::cpu_t>{ 5 }));
+	EXPECT_TRUE(syssnap::parse_cpu_list("").empty());
+}
+
+TEST(hierarchy, detect_from_sysfs)
+{
+	const auto root      = fake_sysfs();
+	const auto hierarchy = syssnap::cpu_hierarchy::detect({ 0, 1, 2, 3, 4, 5, 6, 7 }, root);
+
+	EXPECT_EQ(hierarchy.num_of_domains(domain_level::core), 4U);
+	EXPECT_EQ(hierarchy.num_of_domains(domain_level::l2), 4U);
+	EXPECT_EQ(hierarchy.num_of_domains(domain_level::l3), 2U);
+	EXPECT_EQ(hierarchy.num_of_domains(domain_level::package), 1U);
+
+	EXPECT_EQ(hierarchy.smt_siblings(1), (std::vector<syssnap::cpu_t>{ 1, 5 }));
+	EXPECT_EQ(hierarchy.cpus_in_domain(domain_level::l3, hierarchy.domain_of(domain_level::l3, 6)),
+	          (std::vector<syssnap::cpu_t>{ 2, 3, 6, 7 }));
+
+	EXPECT_EQ(hierarchy.closest_shared_level(0, 4), domain_level::core);
+	EXPECT_EQ(hierarchy.closest_shared_level(0, 5), domain_level::l3);
+	EXPECT_EQ(hierarchy.closest_shared_level(0, 2), domain_level::package);
+
+	std::filesystem::remove_all(root);
+}
+
+TEST(hierarchy, missing_levels_fall_back)
+{
+	// No sysfs at all: every CPU is a core, cache and package of its own
+	const auto hierarchy = syssnap::cpu_hierarchy::detect({ 0, 1, 2 }, "/nonexistent");
+
+	for (const auto level : LEVELS)
+	{
+		EXPECT_EQ(hierarchy.num_of_domains(level), 3U);
+	}
+	EXPECT_FALSE(hierarchy.closest_shared_level(0, 1));
+}
+
+TEST(hierarchy, regular)
+{
+	const std::vector<syssnap::node_t> cpu_node_map{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1 };
+
+	const auto hierarchy = syssnap::cpu_hierarchy::regular(cpu_node_map, 2, 2);
+	EXPECT_EQ(hierarchy.num_of_domains(domain_level::core), 8U);
+	EXPECT_EQ(hierarchy.num_of_domains(domain_level::l3), 4U);
+	EXPECT_EQ(hierarchy.num_of_domains(domain_level::package), 2U);
+	EXPECT_EQ(hierarchy.cpus_in_domain(domain_level::l3, 1), (std::vector<syssnap::cpu_t>{ 4, 5, 6, 7 }));
+
+	// By default, one core per CPU and one L3 per node
+	const auto flat = syssnap::cpu_hierarchy::regular(cpu_node_map);
+	EXPECT_EQ(flat.num_of_domains(domain_level::core), 16U);
+	EXPECT_EQ(flat.num_of_domains(domain_level::l3), 2U);
+}
+
+TEST(hierarchy, snapshot_domain_aggregates)
+{
+	auto snapshot = make_snapshot();
+	snapshot.update();
+
+	const auto & hierarchy = snapshot.system_topology().hierarchy();
+
+	for (const auto level : LEVELS)
+	{
+		auto load = 0.0F;
+
+		for (std::size_t i = 0; i < hierarchy.num_of_domains(level); ++i)
+		{
+			const auto domain = static_cast<syssnap::domain_t>(i);
+
+			auto cpus_use  = 0.0F;
+			auto cpus_load = 0.0F;
+			for (const auto cpu : hierarchy.cpus_in_domain(level, domain))
+			{
+				cpus_use += snapshot.cpu_use(cpu);
+				cpus_load += snapshot.original_load_of_cpu(cpu);
+			}
+
+			EXPECT_NEAR(snapshot.domain_use(level, domain), cpus_use, 1e-3);
+			EXPECT_NEAR(snapshot.original_load_of_domain(level, domain), cpus_load, 1e-3);
+
+			load += snapshot.original_load_of_domain(level, domain);
+		}
+
+		EXPECT_NEAR(load, snapshot.load_system(), 1e-2);
+	}
+}
+
+TEST(hierarchy, migrations_move_domain_load)
+{
+	auto snapshot = make_snapshot();
+	snapshot.update();
+
+	const auto & hierarchy = snapshot.system_topology().hierarchy();
+
+	// From the first L3 of node 0 to the last L3 of node 1
+	const auto pid  = snapshot.original_pids_in_cpu(0).front();
+	const auto load = snapshot.load_of(pid);
+	const auto from = hierarchy.domain_of(domain_level::l3, 0);
+	const auto to   = hierarchy.domain_of(domain_level::l3, 15);
+
+	const auto from_load = snapshot.original_load_of_domain(domain_level::l3, from);
+	const auto to_load   = snapshot.original_load_of_domain(domain_level::l3, to);
+
+	snapshot.migrate_to_cpu(pid, 15);
+
+	EXPECT_NEAR(snapshot.load_of_domain(domain_level::l3, from), from_load - load, 1e-3);
+	EXPECT_NEAR(snapshot.load_of_domain(domain_level::l3, to), to_load + load, 1e-3);
+	EXPECT_FLOAT_EQ(snapshot.original_load_of_domain(domain_level::l3, from), from_load);
+
+	snapshot.commit(syssnap::commit_policy::promote);
+
+	EXPECT_NEAR(snapshot.original_load_of_domain(domain_level::l3, from), from_load - load, 1e-3);
+	EXPECT_NEAR(snapshot.original_load_of_domain(domain_level::l3, to), to_load + load, 1e-3);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
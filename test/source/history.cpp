@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <syssnap/history.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 1'000;
+		config.usage            = syssnap::usage_distribution::bimodal;
+		config.moves_per_update = 0.0F;
+
+		return syssnap::test::make_snapshot(config, { 16, 2 });
+	}
+
+	auto history_config(const std::size_t depth, const std::size_t max_tasks)
+	{
+		syssnap::history_config config;
+		config.depth     = depth;
+		config.max_tasks = max_tasks;
+		config.alpha     = 0.5F;
+		return config;
+	}
+} // namespace
+
+TEST(history, ring_keeps_the_last_samples)
+{
+	syssnap::usage_history history(history_config(4, 8), 1);
+
+	for (int tick = 0; tick < 6; ++tick)
+	{
+		history.record(1, static_cast<float>(tick * 10));
+		history.record_cpu(0, static_cast<float>(tick));
+		history.end_tick();
+	}
+
+	const auto series = history.of_task(1);
+	ASSERT_EQ(series.size(), 4U);
+	EXPECT_FLOAT_EQ(series[0], 20.0F);
+	EXPECT_FLOAT_EQ(series[3], 50.0F);
+	EXPECT_FLOAT_EQ(series.latest(), 50.0F);
+	EXPECT_FLOAT_EQ(series.mean(), 35.0F);
+	EXPECT_FLOAT_EQ(series.max(), 50.0F);
+	EXPECT_FLOAT_EQ(series.percentile(50.0F), 30.0F);
+	EXPECT_FLOAT_EQ(series.percentile(100.0F), 50.0F);
+
+	// EWMA over every sample, not only the ones kept: 0, 5, 12.5, 21.25, 30.625, 40.3125
+	EXPECT_FLOAT_EQ(series.ewma(), 40.3125F);
+
+	const auto cpu = history.of_cpu(0);
+	ASSERT_EQ(cpu.size(), 4U);
+	EXPECT_FLOAT_EQ(cpu[0], 2.0F);
+	EXPECT_FLOAT_EQ(cpu.latest(), 5.0F);
+}
+
+TEST(history, exited_tasks_free_their_slot)
+{
+	syssnap::usage_history history(history_config(4, 2), 1);
+
+	EXPECT_TRUE(history.record(1, 1.0F));
+	EXPECT_TRUE(history.record(2, 1.0F));
+	EXPECT_FALSE(history.record(3, 1.0F));
+	history.end_tick();
+
+	EXPECT_EQ(history.tracked(), 2U);
+	EXPECT_EQ(history.untracked(), 1U);
+	EXPECT_TRUE(history.of_task(3).empty());
+
+	// TID 2 exits, and its slot is freed at the end of the update
+	EXPECT_TRUE(history.record(1, 1.0F));
+	EXPECT_FALSE(history.record(3, 1.0F));
+	history.end_tick();
+
+	// So TID 3 gets it in the next one (and starts from scratch)
+	EXPECT_TRUE(history.record(1, 1.0F));
+	EXPECT_TRUE(history.record(3, 7.0F));
+	history.end_tick();
+
+	EXPECT_FALSE(history.tracks(2));
+	EXPECT_EQ(history.untracked(), 0U);
+	EXPECT_EQ(history.of_task(1).size(), 3U);
+	ASSERT_EQ(history.of_task(3).size(), 1U);
+	EXPECT_FLOAT_EQ(history.of_task(3).ewma(), 7.0F);
+}
+
+TEST(history, snapshot_records_every_update)
+{
+	auto snapshot = make_snapshot();
+	snapshot.enable_history(history_config(8, 4'096));
+
+	for (int i = 0; i < 10; ++i)
+	{
+		snapshot.update();
+	}
+
+	const auto & history = snapshot.history();
+	EXPECT_EQ(history.ticks(), 10U);
+	EXPECT_EQ(history.tracked(), snapshot.processes().size());
+
+	for (const auto & task : snapshot.processes())
+	{
+		const auto series = history.of_task(task.pid());
+		ASSERT_EQ(series.size(), 8U);
+		EXPECT_FLOAT_EQ(series.latest(), task.cpu_use());
+	}
+
+	for (const auto cpu : snapshot.system_topology().cpus())
+	{
+		EXPECT_FLOAT_EQ(history.of_cpu(cpu).latest(), snapshot.cpu_use(cpu));
+	}
+
+	// Recomputing the loads is not a new update
+	snapshot.recompute_loads();
+	EXPECT_EQ(history.ticks(), 10U);
+}
+
+TEST(history, smoothed_loads)
+{
+	auto snapshot = make_snapshot();
+
+	auto config         = history_config(8, 4'096);
+	config.smooth_loads = true;
+	snapshot.enable_history(config);
+
+	for (int i = 0; i < 5; ++i)
+	{
+		snapshot.update();
+	}
+
+	for (const auto cpu : snapshot.system_topology().cpus())
+	{
+		std::vector<float> smoothed;
+		for (const auto pid : snapshot.original_pids_in_cpu(cpu))
+		{
+			smoothed.emplace_back(snapshot.history().of_task(pid).ewma());
+			EXPECT_FLOAT_EQ(snapshot.smoothed_use(pid), smoothed.back());
+		}
+
+		std::vector<float> load(smoothed.size());
+		EXPECT_NEAR(snapshot.original_load_of_cpu(cpu), syssnap::compute_load_sigmoid(smoothed, load), 1e-4);
+	}
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <syssnap/load_index.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	using syssnap::test::synthetic_snapshot;
+
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 2'000;
+		config.usage            = syssnap::usage_distribution::uniform;
+		config.moves_per_update = 0.0F;
+
+		return syssnap::test::make_snapshot(config, { 32, 2 });
+	}
+
+	// CPUs of the node sorted by their (dirty) load, by brute force
+	auto sorted_cpus(const synthetic_snapshot & snapshot, const syssnap::node_t node)
+	{
+		const auto & cpus = snapshot.system_topology().cpus_from_node(node);
+
+		std::vector<syssnap::cpu_t> sorted(cpus.begin(), cpus.end());
+		std::ranges::sort(sorted, [&](const auto a, const auto b) {
+			return std::pair(snapshot.load_of_cpu(a), a) < std::pair(snapshot.load_of_cpu(b), b);
+		});
+		return sorted;
+	}
+} // namespace
+
+TEST(load_index, least_loaded)
+{
+	const syssnap::synthetic_topology topo(8, 2);
+
+	const std::vector<float> loads = { 5.0F, 1.0F, 3.0F, 1.0F, 0.5F, 7.0F, 2.0F, 0.0F };
+
+	syssnap::cpu_load_index index;
+	index.reset(topo, [&](const syssnap::cpu_t cpu) { return loads[syssnap::idx(cpu)]; });
+
+	// Ties go to the lowest CPU
+	EXPECT_EQ(index.least_loaded(0), 1);
+	EXPECT_EQ(index.least_loaded(0, 3), (std::vector<syssnap::cpu_t>{ 1, 3, 2 }));
+	EXPECT_EQ(index.least_loaded(1, 10), (std::vector<syssnap::cpu_t>{ 7, 4, 6, 5 }));
+
+	index.update(1, 4.0F);
+	index.update(7, 9.0F);
+	EXPECT_EQ(index.least_loaded(0, 4), (std::vector<syssnap::cpu_t>{ 3, 2, 1, 0 }));
+	EXPECT_EQ(index.least_loaded(1), 4);
+	EXPECT_FLOAT_EQ(index.load_of(7), 9.0F);
+
+	// Unknown nodes and CPUs
+	EXPECT_EQ(index.least_loaded(5), -1);
+	EXPECT_TRUE(index.least_loaded(5, 2).empty());
+	index.update(100, 1.0F);
+}
+
+TEST(load_index, migrate_to_node_picks_least_loaded)
+{
+	auto snapshot = make_snapshot();
+
+	const auto pids = snapshot.original_pids_in_node(0);
+	for (std::size_t i = 0; i < 200; ++i)
+	{
+		const auto expected = sorted_cpus(snapshot, 1).front();
+		EXPECT_EQ(snapshot.least_loaded_cpu(1), expected);
+
+		snapshot.migrate_to_node(pids[i], 1);
+		EXPECT_EQ(snapshot.processor(pids[i]), expected);
+	}
+
+	const auto sorted = sorted_cpus(snapshot, 1);
+	EXPECT_EQ(snapshot.least_loaded_cpus(1, 4), std::vector(sorted.begin(), sorted.begin() + 4));
+	EXPECT_EQ(snapshot.least_loaded_cpus(0, 16), sorted_cpus(snapshot, 0));
+}
+
+TEST(load_index, follows_commit_and_rollback)
+{
+	auto snapshot = make_snapshot();
+
+	const auto before = sorted_cpus(snapshot, 1);
+
+	const auto pids = snapshot.original_pids_in_node(0);
+	for (std::size_t i = 0; i < 50; ++i)
+	{
+		snapshot.migrate_to_node(pids[i], 1);
+	}
+
+	snapshot.rollback();
+	EXPECT_EQ(snapshot.least_loaded_cpus(1, 16), before);
+
+	for (std::size_t i = 0; i < 50; ++i)
+	{
+		snapshot.migrate_to_node(pids[i], 1);
+	}
+	snapshot.commit(syssnap::commit_policy::promote);
+	EXPECT_EQ(snapshot.least_loaded_cpus(1, 16), sorted_cpus(snapshot, 1));
+
+	snapshot.update();
+	EXPECT_EQ(snapshot.least_loaded_cpus(0, 16), sorted_cpus(snapshot, 0));
+}
+
+TEST(load_index, rejected_node_migration)
+{
+	auto snapshot = make_snapshot();
+
+	const auto pid = snapshot.original_pids_in_node(0).front();
+	EXPECT_THROW(snapshot.migrate_to_node(pid, 5), std::invalid_argument);
+
+	// Nothing was migrated, so the commit has nothing to do
+	EXPECT_TRUE(snapshot.pending_node_migrations().empty());
+	EXPECT_EQ(snapshot.processor(pid), snapshot.original_processor(pid));
+
+	snapshot.commit();
+	EXPECT_EQ(snapshot.stats().of(syssnap::metric::commit).count(), 0U);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include <syssnap/load.hpp>
+
+namespace
+{
+	// Per-TID formulation of the sigmoid load, as computed before the batch kernel
+	auto reference_load(const std::vector<float> & cpu_use)
+	{
+		const auto load = [](const float use, const float slice) {
+			return std::min(1.0F, use / slice);
+		};
+
+		auto total = 0.0F;
+		for (const auto use : cpu_use)
+		{
+			total += use;
+		}
+		const auto free_cpu_use = std::clamp(100.0F - total, 0.0F, 100.0F);
+		const auto max_cpu_use  = *std::max_element(cpu_use.begin(), cpu_use.end());
+
+		const auto alpha = syssnap::detail::sigmoid_weight(static_cast<float>(std::round(free_cpu_use)) / 100.0F);
+		const auto beta  = 1 - alpha;
+
+		std::vector<float> loads;
+		for (const auto use : cpu_use)
+		{
+			loads.emplace_back(alpha * load(use, free_cpu_use) + beta * load(use, max_cpu_use));
+		}
+		return loads;
+	}
+} // namespace
+
+TEST(load_kernel, matches_reference)
+{
+	std::mt19937 gen{ 42 }; // NOLINT
+
+	for (const auto size : { 1U, 2U, 7U, 64U, 1000U })
+	{
+		for (const auto max_use : { 0.0F, 0.5F, 10.0F, 100.0F })
+		{
+			std::uniform_real_distribution<float> dist{ 0.0F, max_use };
+
+			std::vector<float> cpu_use(size);
+			for (auto & use : cpu_use)
+			{
+				use = dist(gen);
+			}
+
+			std::vector<float> load(size);
+			const auto         total = syssnap::compute_load_sigmoid(cpu_use, load);
+
+			const auto expected = reference_load(cpu_use);
+
+			auto expected_total = 0.0F;
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				EXPECT_EQ(load[i], expected[i]) << "size " << size << ", max use " << max_use << ", TID " << i;
+				expected_total += expected[i];
+			}
+			EXPECT_EQ(total, expected_total);
+		}
+	}
+}
+
+TEST(load_kernel, empty_cpu)
+{
+	EXPECT_EQ(syssnap::compute_load_sigmoid({}, {}), 0.0F);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
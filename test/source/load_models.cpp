@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <syssnap/load_models.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	template<typename Load>
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks       = 1'000;
+		config.usage       = syssnap::usage_distribution::uniform;
+		config.mean_use    = 10.0F;
+		config.nice_spread = 10;
+
+		return syssnap::test::make_snapshot<syssnap::test::basic_synthetic_snapshot<Load>>(config, { 16, 2 });
+	}
+} // namespace
+
+TEST(load_models, nice_weights)
+{
+	EXPECT_FLOAT_EQ(syssnap::nice_to_weight(0), syssnap::NICE_0_WEIGHT);
+	EXPECT_FLOAT_EQ(syssnap::nice_to_weight(-10), 9548.0F);
+	EXPECT_FLOAT_EQ(syssnap::nice_to_weight(19), 15.0F);
+	EXPECT_FLOAT_EQ(syssnap::nice_to_weight(-30), 88761.0F);
+	EXPECT_EQ(syssnap::snapshot::priority_to_weight(), 1024);
+
+	EXPECT_EQ(syssnap::read_nice(getpid()), nice(0));
+}
+
+TEST(load_models, kernels)
+{
+	const std::array<pid_t, 3> pids{ 1, 2, 3 };
+	const std::array<float, 3> use{ 50.0F, 20.0F, 100.0F };
+	const std::array<float, 3> weight{ syssnap::nice_to_weight(0), syssnap::nice_to_weight(-10),
+		                               syssnap::nice_to_weight(19) };
+
+	const syssnap::cpu_tasks tasks{ pids, use, weight };
+	std::array<float, 3>     load{};
+
+	EXPECT_FLOAT_EQ(syssnap::linear_load::compute(tasks, load), 1.7F);
+	EXPECT_FLOAT_EQ(load[0], 0.5F);
+
+	EXPECT_FLOAT_EQ(syssnap::nice_weighted_load::compute(tasks, load),
+	                0.5F + 0.2F * 9548.0F / 1024.0F + 15.0F / 1024.0F);
+	EXPECT_GT(load[1], load[0]);
+	EXPECT_LT(load[2], load[0]);
+
+	std::vector<float> sigmoid(3);
+	EXPECT_FLOAT_EQ(syssnap::sigmoid_load::compute(tasks, load), syssnap::compute_load_sigmoid(use, sigmoid));
+}
+
+TEST(load_models, decay)
+{
+	syssnap::decayed_load model(1.0F);
+	EXPECT_FLOAT_EQ(model.decay(), 0.5F);
+
+	const std::array<pid_t, 1> pid{ 7 };
+	const std::array<float, 1> weight{ syssnap::NICE_0_WEIGHT };
+	std::array<float, 1>       load{};
+
+	const auto compute = [&](const float use) {
+		const std::array<float, 1> uses{ use };
+		return model.compute({ pid, uses, weight }, load);
+	};
+
+	// New TIDs start from their first use
+	model.prepare(pid, true);
+	EXPECT_FLOAT_EQ(compute(100.0F), 1.0F);
+
+	model.prepare(pid, true);
+	EXPECT_FLOAT_EQ(compute(0.0F), 0.5F);
+
+	// Recomputing the loads of the same update does not decay them again
+	model.prepare(pid, false);
+	EXPECT_FLOAT_EQ(compute(0.0F), 0.5F);
+	EXPECT_FLOAT_EQ(model.decayed_use_of(7), 50.0F);
+
+	model.prepare(pid, true);
+	EXPECT_FLOAT_EQ(compute(0.0F), 0.25F);
+
+	// TIDs that left are dropped
+	model.prepare(std::array<pid_t, 0>{}, true);
+	EXPECT_FLOAT_EQ(model.decayed_use_of(7), -1.0F);
+}
+
+TEST(load_models, nice_weighted_snapshot)
+{
+	auto snapshot = make_snapshot<syssnap::nice_weighted_load>();
+
+	for (int i = 0; i < 3; ++i)
+	{
+		for (const auto & task : snapshot.processes())
+		{
+			const auto weight = syssnap::nice_to_weight(snapshot.nice_of(task.pid()));
+			EXPECT_FLOAT_EQ(snapshot.load_of(task.pid()), task.cpu_use() / 100.0F * weight / syssnap::NICE_0_WEIGHT);
+		}
+
+		// The weights follow the TIDs that a commit moves to another CPU
+		const auto pid = snapshot.original_pids_in_cpu(0).front();
+		const auto old = snapshot.load_of(pid);
+		snapshot.migrate_to_cpu(pid, 5);
+		static_cast<void>(snapshot.commit(syssnap::commit_policy::promote));
+		snapshot.recompute_loads();
+		EXPECT_FLOAT_EQ(snapshot.load_of(pid), old);
+
+		snapshot.update();
+	}
+}
+
+TEST(load_models, decayed_snapshot)
+{
+	auto snapshot = make_snapshot<syssnap::decayed_load>();
+	snapshot.model().set_half_life(2.0F);
+
+	auto linear = make_snapshot<syssnap::linear_load>();
+
+	for (int i = 0; i < 5; ++i)
+	{
+		snapshot.update();
+		linear.update();
+	}
+
+	auto decayed = 0.0F;
+	for (const auto & task : snapshot.processes())
+	{
+		const auto pid    = task.pid();
+		const auto weight = syssnap::nice_to_weight(snapshot.nice_of(pid));
+		const auto use    = snapshot.model().decayed_use_of(pid);
+
+		ASSERT_GE(use, 0.0F);
+		EXPECT_FLOAT_EQ(snapshot.load_of(pid), use / 100.0F * weight / syssnap::NICE_0_WEIGHT);
+
+		decayed += use;
+	}
+
+	// Same tasks, whose use swings less than the linear load
+	auto spread_decayed = 0.0F;
+	auto spread_linear  = 0.0F;
+	for (const auto & task : linear.processes())
+	{
+		spread_decayed += std::abs(snapshot.model().decayed_use_of(task.pid()) - decayed / 1'000.0F);
+		spread_linear += std::abs(task.cpu_use() - decayed / 1'000.0F);
+	}
+	EXPECT_LT(spread_decayed, spread_linear);
+
+	// Recomputing the loads does not decay them again
+	const auto load = snapshot.load_system();
+	snapshot.recompute_loads();
+	EXPECT_FLOAT_EQ(snapshot.load_system(), load);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
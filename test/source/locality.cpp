@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <sstream>
+#include <vector>
+
+#include <syssnap/locality.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	auto make_snapshot(const syssnap::usage_distribution usage)
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 1'000;
+		config.moves_per_update = 0.0F;
+		config.churn_per_update = 0.0F;
+		config.usage            = usage;
+
+		return syssnap::test::make_snapshot(config, { 16, 2 });
+	}
+} // namespace
+
+TEST(locality, parse_sched)
+{
+	std::istringstream sched("cat (4242, #threads: 1)\n"
+	                         "-------------------------------------------------------------------\n"
+	                         "se.exec_start                                :      12345.678901\n"
+	                         "numa_preferred_nid                           :                    1\n"
+	                         "total_numa_faults                            :                  260\n"
+	                         "numa_pages_migrated                          :                   17\n"
+	                         "numa_faults node=0 task_private=10 task_shared=5 group_private=0 group_shared=0\n"
+	                         "numa_faults node=1 task_private=200 task_shared=45 group_private=0 group_shared=0\n");
+
+	const auto faults = syssnap::numa_faults::parse(sched);
+
+	EXPECT_EQ(faults.preferred_node, 1);
+	EXPECT_EQ(faults.pages_migrated, 17U);
+	EXPECT_EQ(faults.on(0), 15U);
+	EXPECT_EQ(faults.on(1), 245U);
+	EXPECT_EQ(faults.on(2), 0U);
+	EXPECT_EQ(faults.total(), 260U);
+
+	const syssnap::task_locality locality{ faults, {} };
+	EXPECT_FLOAT_EQ(locality.on(1), 245.0F / 260.0F);
+
+	// Without NUMA balancing there are no faults: the memory decides, and without it every node is as good
+	syssnap::task_locality by_memory;
+	by_memory.memory.add(0, 3 * 4096);
+	by_memory.memory.add(1, 4096);
+	EXPECT_FLOAT_EQ(by_memory.on(0), 0.75F);
+	EXPECT_FLOAT_EQ(syssnap::task_locality{}.on(0), 1.0F);
+
+	EXPECT_TRUE(syssnap::numa_faults::read(-1).empty());
+}
+
+TEST(locality, parse_counters)
+{
+	std::istringstream vmstat("nr_free_pages 1000\n"
+	                          "numa_hit 500\n"
+	                          "numa_miss 20\n"
+	                          "numa_foreign 20\n"
+	                          "numa_interleave 7\n"
+	                          "numa_local 480\n"
+	                          "numa_other 40\n"
+	                          "numa_hint_faults 100\n"
+	                          "numa_hint_faults_local 75\n"
+	                          "numa_pages_migrated 9\n");
+
+	const auto system = syssnap::numa_counters::parse(vmstat);
+	EXPECT_EQ(system.hit, 500U);
+	EXPECT_EQ(system.other, 40U);
+	EXPECT_EQ(system.pages_migrated, 9U);
+	EXPECT_FLOAT_EQ(system.fault_locality(), 0.75F);
+
+	std::istringstream numastat("numa_hit 300\nnuma_miss 2\nnuma_foreign 1\n"
+	                            "interleave_hit 4\nlocal_node 290\nother_node 12\n");
+
+	const auto node = syssnap::numa_counters::parse(numastat);
+	EXPECT_EQ(node.interleave, 4U);
+	EXPECT_EQ(node.local, 290U);
+	EXPECT_EQ(node.other, 12U);
+	EXPECT_FLOAT_EQ(node.fault_locality(), 1.0F);
+
+	const auto activity = system - node;
+	EXPECT_EQ(activity.hit, 200U);
+	EXPECT_EQ(activity.hint_faults, 100U);
+}
+
+TEST(locality, only_busy_tasks)
+{
+	auto snapshot = make_snapshot(syssnap::usage_distribution::bimodal);
+	EXPECT_FALSE(snapshot.locality());
+
+	snapshot.enable_locality({ 50.0F, true });
+	snapshot.update();
+
+	std::size_t busy = 0;
+	for (const auto & task : snapshot.processes())
+	{
+		const auto * locality = snapshot.locality_of(task.pid());
+
+		EXPECT_EQ(locality != nullptr, task.cpu_use() >= 50.0F);
+		if (locality == nullptr) { continue; }
+
+		++busy;
+		EXPECT_EQ(locality->faults.preferred_node, task.numa_node());
+		EXPECT_FALSE(locality->memory.empty());
+		EXPECT_FLOAT_EQ(snapshot.locality_on(task.pid(), task.numa_node()), 1.0F);
+	}
+
+	EXPECT_GT(busy, 0U);
+	EXPECT_LT(busy, snapshot.processes().size());
+	EXPECT_DOUBLE_EQ(snapshot.stats().of(syssnap::metric::locality).last(), static_cast<double>(busy));
+
+	snapshot.disable_locality();
+	snapshot.update();
+	EXPECT_EQ(snapshot.locality_of(snapshot.processes().begin()->pid()), nullptr);
+}
+
+TEST(locality, follows_the_memory)
+{
+	auto snapshot = make_snapshot(syssnap::usage_distribution::uniform);
+	snapshot.enable_locality({ 0.0F, true });
+	snapshot.update();
+
+	const auto pid = snapshot.original_pids_in_node(0).front();
+	EXPECT_FLOAT_EQ(snapshot.locality_on(pid, 0), 1.0F);
+	EXPECT_FLOAT_EQ(snapshot.locality_on(pid, 1), 0.0F);
+
+	// The thread alone: its accesses are now remote
+	snapshot.migrate_to_node(pid, 1);
+	snapshot.commit(syssnap::commit_policy::promote);
+	snapshot.update();
+	EXPECT_FLOAT_EQ(snapshot.locality_on(pid, 1), 0.0F);
+
+	// Along with its memory: local again
+	snapshot.enable_memory_migration();
+	snapshot.migrate_to_node(pid, 0);
+	snapshot.commit(syssnap::commit_policy::promote);
+	snapshot.migrate_to_node(pid, 1);
+	snapshot.commit(syssnap::commit_policy::promote);
+	snapshot.update();
+	EXPECT_FLOAT_EQ(snapshot.locality_on(pid, 1), 1.0F);
+
+	// Synthetic tasks have no system counters
+	EXPECT_EQ(snapshot.numa_activity().hit, 0U);
+}
+
+TEST(locality, system_counters)
+{
+	const auto counters = syssnap::numa_counters::read_system();
+	if (counters.hit == 0) { GTEST_SKIP() << "The kernel does not count NUMA allocations"; }
+
+	const auto later = syssnap::numa_counters::read_system();
+	EXPECT_GE(later.hit, counters.hit);
+	EXPECT_GE(later.fault_locality(), 0.0F);
+	EXPECT_LE(later.fault_locality(), 1.0F);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
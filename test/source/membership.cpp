@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <syssnap/membership.hpp>
+
+TEST(membership, swap_remove_keeps_slots_valid)
+{
+	syssnap::membership buckets{ 2 };
+
+	std::vector<syssnap::slot_t> slots(4);
+	for (pid_t pid = 0; pid < 4; ++pid)
+	{
+		slots[static_cast<std::size_t>(pid)] = buckets.insert(0, pid);
+	}
+
+	// Erasing from the middle moves the last TID into the freed slot
+	const auto moved = buckets.erase(0, slots[1]);
+	ASSERT_TRUE(moved.has_value());
+	EXPECT_EQ(*moved, 3);
+	slots[3] = slots[1];
+
+	EXPECT_EQ(buckets.size(0), 3U);
+	EXPECT_EQ(buckets[0][slots[3]], 3);
+
+	// Erasing the last TID does not move anything
+	EXPECT_FALSE(buckets.erase(0, slots[2]).has_value());
+	EXPECT_EQ(buckets.size(0), 2U);
+
+	EXPECT_EQ(buckets.insert(1, 1), 0U);
+	EXPECT_EQ(buckets.size(1), 1U);
+
+	buckets.clear();
+	EXPECT_EQ(buckets.size(0), 0U);
+	EXPECT_EQ(buckets.size(1), 0U);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
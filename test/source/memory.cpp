@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include <syssnap/memory.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	constexpr std::uint64_t MIB = 1ULL << 20U;
+
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 1'000;
+		config.moves_per_update = 0.0F;
+		config.memory_per_task  = 64 * MIB;
+
+		return syssnap::test::make_snapshot(config, { 16, 2 });
+	}
+} // namespace
+
+TEST(memory, parse_numa_maps)
+{
+	std::istringstream numa_maps(
+	    "00400000 default file=/usr/bin/cat mapped=8 N0=6 N1=2 kernelpagesize_kB=4\n"
+	    "7f0000000000 interleave:0-1 anon=512 dirty=512 N1=512 kernelpagesize_kB=2048\n"
+	    "7ffd00000000 default stack anon=3 dirty=3 N0=3 kernelpagesize_kB=4\n"
+	    "7ffe00000000 default\n");
+
+	const auto footprint = syssnap::numa_footprint::parse(numa_maps);
+
+	EXPECT_EQ(footprint.size(), 2U);
+	EXPECT_EQ(footprint.bytes_on(0), 9 * 4 * 1024ULL);
+	EXPECT_EQ(footprint.bytes_on(1), 2 * 4 * 1024ULL + 512 * 2 * MIB);
+	EXPECT_EQ(footprint.bytes_on(5), 0U);
+	EXPECT_EQ(footprint.bytes_off(1), footprint.bytes_on(0));
+	EXPECT_EQ(footprint.total(), footprint.bytes_on(0) + footprint.bytes_on(1));
+}
+
+TEST(memory, unknown_tasks)
+{
+	EXPECT_TRUE(syssnap::numa_footprint::read(-1).empty());
+}
+
+TEST(memory, follows_node_migrations)
+{
+	auto snapshot = make_snapshot();
+	snapshot.enable_memory_migration();
+
+	const auto pid = snapshot.original_pids_in_node(0).front();
+	EXPECT_EQ(snapshot.memory_of(pid).bytes_on(0), 64 * MIB);
+
+	// Migrations within the node leave the memory where it is
+	const auto other = snapshot.original_pids_in_node(0).back();
+	snapshot.migrate_to_cpu(other, snapshot.system_topology().cpus_from_node(0).front());
+	snapshot.migrate_to_node(pid, 1);
+
+	const auto report = snapshot.commit(syssnap::commit_policy::promote);
+
+	ASSERT_EQ(report.memory.size(), 1U);
+	EXPECT_EQ(report.memory[0].pid, pid);
+	EXPECT_EQ(report.memory[0].node, 1);
+	EXPECT_EQ(report.memory[0].error, 0);
+	EXPECT_EQ(report.memory_moved(), 64 * MIB);
+
+	EXPECT_EQ(snapshot.memory_of(pid).bytes_on(1), 64 * MIB);
+	EXPECT_EQ(snapshot.memory_of(other).bytes_on(0), 64 * MIB);
+	EXPECT_EQ(snapshot.pending_memory_migrations(), 0U);
+	EXPECT_DOUBLE_EQ(snapshot.stats().of(syssnap::metric::memory_migrated).last(), 64.0 * MIB);
+}
+
+TEST(memory, disabled_by_default)
+{
+	auto snapshot = make_snapshot();
+	EXPECT_FALSE(snapshot.memory_migration());
+
+	const auto pid = snapshot.original_pids_in_node(0).front();
+	snapshot.migrate_to_node(pid, 1);
+
+	const auto report = snapshot.commit(syssnap::commit_policy::promote);
+
+	EXPECT_TRUE(report.memory.empty());
+	EXPECT_EQ(snapshot.numa_node(pid), 1);
+	EXPECT_EQ(snapshot.memory_of(pid).bytes_on(0), 64 * MIB);
+}
+
+TEST(memory, budget_spreads_over_commits)
+{
+	auto snapshot = make_snapshot();
+	snapshot.enable_memory_migration({ .max_bytes_per_commit = 128 * MIB, .max_processes_per_commit = 16 });
+
+	// Copied: the span changes with the commits
+	const auto               committed = snapshot.original_pids_in_node(0);
+	const std::vector<pid_t> pids(committed.begin(), committed.end());
+	for (std::size_t i = 0; i < 5; ++i)
+	{
+		snapshot.migrate_to_node(pids[i], 1);
+	}
+
+	auto report = snapshot.commit(syssnap::commit_policy::promote);
+	EXPECT_EQ(report.applied(), 5U);
+	EXPECT_EQ(report.memory_moved(), 128 * MIB);
+	EXPECT_EQ(snapshot.pending_memory_migrations(), 3U);
+
+	// Nothing else to migrate: the following commits only move the memory left
+	report = snapshot.commit(syssnap::commit_policy::promote);
+	EXPECT_TRUE(report.results.empty());
+	EXPECT_EQ(report.memory.size(), 2U);
+
+	report = snapshot.commit(syssnap::commit_policy::promote);
+	EXPECT_EQ(report.memory.size(), 1U);
+	EXPECT_EQ(snapshot.pending_memory_migrations(), 0U);
+
+	for (std::size_t i = 0; i < 5; ++i)
+	{
+		EXPECT_EQ(snapshot.memory_of(pids[i]).bytes_off(1), 0U);
+	}
+
+	// A process larger than the budget moves over several commits, and the next one waits behind it
+	snapshot.enable_memory_migration({ .max_bytes_per_commit = 16 * MIB, .max_processes_per_commit = 16 });
+	snapshot.migrate_to_node(pids[5], 1);
+	snapshot.migrate_to_node(pids[6], 1);
+
+	report = snapshot.commit(syssnap::commit_policy::promote);
+	ASSERT_EQ(report.memory.size(), 1U);
+	EXPECT_EQ(report.memory[0].pid, pids[5]);
+	EXPECT_EQ(report.memory_moved(), 16 * MIB);
+	EXPECT_EQ(snapshot.memory_of(pids[5]).bytes_on(0), 48 * MIB);
+	EXPECT_EQ(snapshot.memory_of(pids[5]).bytes_on(1), 16 * MIB);
+	EXPECT_EQ(snapshot.pending_memory_migrations(), 2U);
+
+	for (std::size_t i = 0; i < 3; ++i)
+	{
+		report = snapshot.commit(syssnap::commit_policy::promote);
+		EXPECT_EQ(report.memory_moved(), 16 * MIB);
+	}
+	EXPECT_EQ(snapshot.memory_of(pids[5]).bytes_off(1), 0U);
+	EXPECT_EQ(snapshot.memory_of(pids[6]).bytes_off(1), 64 * MIB);
+	EXPECT_EQ(snapshot.pending_memory_migrations(), 1U);
+}
+
+TEST(memory, process_is_queued_once)
+{
+	auto snapshot = make_snapshot();
+	snapshot.enable_memory_migration({ .max_bytes_per_commit = 16 * MIB, .max_processes_per_commit = 16 });
+
+	const auto pid = snapshot.original_pids_in_node(0).front();
+	snapshot.migrate_to_node(pid, 1);
+
+	auto report = snapshot.commit(syssnap::commit_policy::promote);
+	EXPECT_EQ(report.memory_moved(), 16 * MIB);
+	EXPECT_EQ(snapshot.pending_memory_migrations(), 1U);
+
+	// Moved back before its memory followed: the queued process only changes its node
+	snapshot.migrate_to_node(pid, 0);
+
+	report = snapshot.commit(syssnap::commit_policy::promote);
+	ASSERT_EQ(report.memory.size(), 1U);
+	EXPECT_EQ(report.memory[0].node, 0);
+	EXPECT_EQ(report.memory_moved(), 16 * MIB);
+
+	EXPECT_EQ(snapshot.memory_of(pid).bytes_on(0), 64 * MIB);
+	EXPECT_EQ(snapshot.pending_memory_migrations(), 0U);
+}
+
+TEST(memory, move_own_pages)
+{
+	const auto page = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+
+	std::vector<char> buffer(MIB, 1);
+	std::uintptr_t    resume = 0;
+
+	// The budget still lets a page move
+	const auto step = syssnap::move_pages_to_node(getpid(), 0, resume, 0, UINT64_MAX, 64);
+	if (step.error == ENOSYS or step.error == EPERM) { GTEST_SKIP() << "move_pages(2) is not available"; }
+
+	EXPECT_EQ(step.error, 0);
+	EXPECT_LE(step.bytes, page);
+	EXPECT_EQ(step.done, resume == 0);
+
+	std::uintptr_t none = 0;
+	EXPECT_NE(syssnap::move_pages_to_node(-1, 0, none, MIB, UINT64_MAX, 64).error, 0);
+}
+
+TEST(memory, page_walk_is_bounded)
+{
+	const auto        page    = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+	constexpr auto    RESERVE = 1ULL << 30U;
+	std::vector<char> buffer(MIB, 1);
+
+	// Reserved but never touched: nothing of it is resident, so it is never visited
+	auto * reserve = mmap(nullptr, RESERVE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	ASSERT_NE(reserve, MAP_FAILED);
+
+	std::uintptr_t resume = 0;
+
+	auto step = syssnap::move_pages_to_node(getpid(), 0, resume, MIB, 1, 64);
+	if (step.error == ENOSYS or step.error == EPERM) { GTEST_SKIP() << "move_pages(2) is not available"; }
+
+	// One page at most per step, and the next step carries on after it
+	std::uint64_t visited = step.pages;
+	for (std::size_t i = 0; i < 100'000 and not step.done and step.error == 0; ++i)
+	{
+		EXPECT_LE(step.pages, 1U);
+		EXPECT_NE(resume, 0U);
+
+		step = syssnap::move_pages_to_node(getpid(), 0, resume, MIB, 1, 64);
+		visited += step.pages;
+	}
+
+	EXPECT_EQ(step.error, 0);
+	EXPECT_TRUE(step.done);
+	EXPECT_EQ(resume, 0U);
+	EXPECT_LT(visited, RESERVE / page);
+
+	munmap(reserve, RESERVE);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <syssnap/planner.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	using syssnap::test::synthetic_snapshot;
+
+	// Few busy tasks per CPU, so the random placement leaves some CPUs much busier than others
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 256;
+		config.usage            = syssnap::usage_distribution::bimodal;
+		config.busy_fraction    = 0.5F;
+		config.moves_per_update = 0.0F;
+
+		return syssnap::test::make_snapshot(config, { 32, 4 });
+	}
+
+	auto imbalance(const synthetic_snapshot & snapshot)
+	{
+		const auto & cpus = snapshot.system_topology().cpus();
+
+		auto total = 0.0F;
+		auto max   = 0.0F;
+		for (const auto cpu : cpus)
+		{
+			total += snapshot.load_of_cpu(cpu);
+			max = std::max(max, snapshot.load_of_cpu(cpu));
+		}
+		return max - total / static_cast<float>(cpus.size());
+	}
+} // namespace
+
+TEST(planner, plan_reduces_imbalance)
+{
+	const auto snapshot = make_snapshot();
+
+	syssnap::planner_config config;
+	config.max_migrations = 32;
+
+	const auto plan = syssnap::planner(config).plan(snapshot);
+
+	ASSERT_FALSE(plan.empty());
+	EXPECT_LE(plan.size(), config.max_migrations);
+	EXPECT_NEAR(plan.imbalance_before, imbalance(snapshot), 1e-4);
+	EXPECT_LT(plan.imbalance_after, plan.imbalance_before);
+
+	// Planning does not touch the snapshot, and each TID moves once
+	EXPECT_TRUE(snapshot.pending_cpu_migrations().empty());
+
+	std::unordered_set<pid_t> moved;
+	for (const auto & migration : plan.migrations)
+	{
+		EXPECT_TRUE(moved.insert(migration.pid).second);
+		EXPECT_EQ(snapshot.processor(migration.pid), migration.from);
+		EXPECT_NE(migration.from, migration.to);
+		EXPECT_FLOAT_EQ(migration.load, snapshot.load_of(migration.pid));
+	}
+}
+
+TEST(planner, apply_through_dirty_state)
+{
+	auto snapshot = make_snapshot();
+
+	const auto plan = syssnap::planner().rebalance(snapshot);
+	ASSERT_FALSE(plan.empty());
+
+	for (const auto & migration : plan.migrations)
+	{
+		EXPECT_EQ(snapshot.processor(migration.pid), migration.to);
+	}
+	EXPECT_NEAR(imbalance(snapshot), plan.imbalance_after, 1e-3);
+
+	const auto report = snapshot.commit(syssnap::commit_policy::promote);
+	EXPECT_EQ(report.applied(), plan.size());
+	EXPECT_NEAR(imbalance(snapshot), plan.imbalance_after, 1e-3);
+}
+
+TEST(planner, distance_penalty_keeps_tids_in_their_node)
+{
+	const auto snapshot = make_snapshot();
+	const auto & topo   = snapshot.system_topology();
+
+	syssnap::planner_config config;
+	config.distance_penalty = 1'000.0F;
+
+	const auto plan = syssnap::planner(config).plan(snapshot);
+	ASSERT_FALSE(plan.empty());
+
+	for (const auto & migration : plan.migrations)
+	{
+		EXPECT_EQ(topo.node_from_cpu(migration.from), topo.node_from_cpu(migration.to));
+	}
+}
+
+TEST(planner, budget_and_min_gain)
+{
+	const auto snapshot = make_snapshot();
+
+	syssnap::planner_config config;
+	config.max_migrations = 3;
+	EXPECT_EQ(syssnap::planner(config).plan(snapshot).size(), 3U);
+
+	// No CPU has that much load to shed
+	config.max_migrations = 10'000;
+	config.min_gain       = 1'000.0F;
+	EXPECT_TRUE(syssnap::planner(config).plan(snapshot).empty());
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
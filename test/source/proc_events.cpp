@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <syssnap/proc_events.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	using syssnap::test::synthetic_snapshot;
+
+	auto make_snapshot(syssnap::scope managed = {})
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 1'000;
+		config.moves_per_update = 0.1F;
+		config.churn_per_update = 0.05F;
+
+		return syssnap::test::make_snapshot(config, { 16, 2 }, 1, std::move(managed));
+	}
+
+	auto pids_of(const syssnap::synthetic_processes & processes)
+	{
+		std::unordered_set<pid_t> pids;
+		for (const auto & task : processes)
+		{
+			pids.insert(task.pid());
+		}
+		return pids;
+	}
+
+	// Events of the next update of the source, found by updating a copy of it (the updates are deterministic)
+	auto next_events(const synthetic_snapshot & snapshot)
+	{
+		auto next = snapshot.processes();
+		next.update();
+
+		const auto before = pids_of(snapshot.processes());
+		const auto after  = pids_of(next);
+
+		syssnap::task_events events;
+		for (const auto pid : before)
+		{
+			if (not after.contains(pid)) { events.events.push_back({ syssnap::task_event::kind::exit, pid }); }
+		}
+		for (const auto pid : after)
+		{
+			if (not before.contains(pid)) { events.events.push_back({ syssnap::task_event::kind::fork, pid }); }
+		}
+		return events;
+	}
+
+	auto sorted(auto && range)
+	{
+		std::vector<pid_t> pids(range.begin(), range.end());
+		std::ranges::sort(pids);
+		return pids;
+	}
+} // namespace
+
+TEST(proc_events, tracked_updates_match_scans)
+{
+	auto scanned = make_snapshot();
+	auto tracked = make_snapshot();
+
+	for (int i = 0; i < 5; ++i)
+	{
+		const auto events = next_events(tracked);
+		EXPECT_FALSE(events.empty());
+
+		scanned.update();
+		tracked.update(events);
+
+		for (const auto cpu : scanned.system_topology().cpus())
+		{
+			EXPECT_EQ(sorted(scanned.original_pids_in_cpu(cpu)), sorted(tracked.original_pids_in_cpu(cpu)));
+			EXPECT_FLOAT_EQ(scanned.load_of_cpu(cpu), tracked.load_of_cpu(cpu));
+		}
+
+		EXPECT_DOUBLE_EQ(tracked.stats().of(syssnap::metric::task_events).last(),
+		                 static_cast<double>(events.size()));
+	}
+
+	EXPECT_TRUE(scanned.stats().of(syssnap::metric::task_events).empty());
+}
+
+TEST(proc_events, forks_extend_the_subtree)
+{
+	auto       snapshot = make_snapshot();
+	const auto root     = snapshot.processes().begin()->pid();
+	const auto child    = std::next(snapshot.processes().begin())->pid();
+
+	auto subtree = make_snapshot(syssnap::scope::subtree(root));
+	EXPECT_TRUE(subtree.manages(root));
+	EXPECT_FALSE(subtree.manages(child));
+
+	// Synthetic tasks do not know their children, so only the events can tell the subtree that the child is in it
+	syssnap::task_events events;
+	events.events.push_back({ syssnap::task_event::kind::fork, child, root });
+	subtree.update(events);
+	EXPECT_TRUE(subtree.manages(child));
+
+	// New threads of the subtree are reported as children of the parent of their process
+	const auto thread = std::next(snapshot.processes().begin(), 2)->pid();
+	events.clear();
+	events.events.push_back({ syssnap::task_event::kind::fork, thread, getppid(), child });
+	subtree.update(events);
+	EXPECT_TRUE(subtree.manages(thread));
+
+	// Lost events: the subtree is walked again
+	events.clear();
+	events.lost = true;
+	subtree.update(events);
+	EXPECT_FALSE(subtree.manages(child));
+}
+
+TEST(proc_events, execs_test_the_scope_again)
+{
+	auto excluded = std::make_shared<std::unordered_set<pid_t>>();
+
+	auto snapshot =
+	    make_snapshot(syssnap::scope::predicate([=](const pid_t pid) { return not excluded->contains(pid); }));
+
+	const auto pid = snapshot.processes().begin()->pid();
+	EXPECT_TRUE(snapshot.manages(pid));
+
+	// The scope of a TID is only tested when it first appears...
+	excluded->insert(pid);
+	syssnap::task_events events;
+	snapshot.update(events);
+	EXPECT_TRUE(snapshot.manages(pid));
+
+	// ... or when it execs
+	events.events.push_back({ syssnap::task_event::kind::exec, pid });
+	snapshot.update(events);
+	EXPECT_FALSE(snapshot.manages(pid));
+}
+
+TEST(proc_events, kernel_notifications)
+{
+	syssnap::proc_events subscription;
+	if (not subscription.available())
+	{
+		GTEST_SKIP() << "The proc connector is not available (errno " << subscription.error() << ")";
+	}
+
+	const auto child = fork();
+	ASSERT_GE(child, 0);
+	if (child == 0) { _exit(0); }
+	waitpid(child, nullptr, 0);
+
+	syssnap::task_events events;
+
+	const auto has = [&](const syssnap::task_event::kind what) {
+		return std::ranges::any_of(events.events, [&](const auto & e) { return e.what == what and e.pid == child; });
+	};
+
+	for (int i = 0; i < 100 and not has(syssnap::task_event::kind::exit); ++i)
+	{
+		subscription.poll(events);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	EXPECT_TRUE(has(syssnap::task_event::kind::fork));
+	EXPECT_TRUE(has(syssnap::task_event::kind::exit));
+
+	const auto forked = std::ranges::find_if(events.events, [&](const auto & e) { return e.pid == child; });
+	EXPECT_EQ(forked->parent, getpid());
+	EXPECT_EQ(forked->process, child);
+}
+
+TEST(proc_events, threads_join_a_tracked_subtree)
+{
+	syssnap::proc_events subscription;
+	if (not subscription.available())
+	{
+		GTEST_SKIP() << "The proc connector is not available (errno " << subscription.error() << ")";
+	}
+
+	syssnap::snapshot snapshot{ syssnap::scope::subtree(getpid()) };
+
+	// Nothing happened yet: the next updates follow the events only
+	syssnap::task_events events;
+	subscription.poll(events);
+	events.events.clear();
+	snapshot.update(events);
+
+	std::atomic<pid_t> tid{ 0 };
+	std::atomic<bool>  stop{ false };
+
+	std::jthread worker([&] {
+		tid = gettid();
+		while (not stop.load()) { std::this_thread::yield(); }
+	});
+	while (tid.load() == 0) { std::this_thread::yield(); }
+
+	const auto forked = [&] {
+		return std::ranges::find_if(events.events, [&](const auto & e) {
+			return e.what == syssnap::task_event::kind::fork and e.pid == tid.load();
+		});
+	};
+
+	for (int i = 0; i < 100 and forked() == events.events.end(); ++i)
+	{
+		subscription.poll(events);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	ASSERT_NE(forked(), events.events.end());
+	EXPECT_EQ(forked()->process, getpid());
+
+	if (events.lost) { GTEST_SKIP() << "The kernel dropped events"; }
+
+	snapshot.update(events);
+	EXPECT_TRUE(snapshot.manages(tid));
+
+	stop = true;
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
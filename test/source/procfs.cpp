@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+
+#include <syssnap/procfs.hpp>
+#include <syssnap/procfs_processes.hpp>
+#include <syssnap/sampling.hpp>
+#include <syssnap/syssnap.hpp>
+
+TEST(procfs, parse_stat)
+{
+	// The command name may contain spaces and parentheses
+	const auto fields = syssnap::procfs::parse_stat(
+	    "42 (a (b) c) S 1 42 42 0 -1 4194560 100 0 0 0 7 3 0 0 20 0 1 0 100 0 0 18446744073709551615 0 0 0 0 0 0 0 0 0 "
+	    "0 0 0 17 5 0 0 0 0 0");
+
+	ASSERT_TRUE(fields);
+	EXPECT_EQ(fields->pid, 42);
+	EXPECT_EQ(fields->ticks, 10U);
+	EXPECT_EQ(fields->processor, 5);
+
+	EXPECT_FALSE(syssnap::procfs::parse_stat("42 (truncated) S 1"));
+	EXPECT_FALSE(syssnap::procfs::read_stat(getpid(), -1));
+}
+
+TEST(procfs, status_and_cgroups)
+{
+	EXPECT_EQ(syssnap::procfs::thread_group_of(getpid()), getpid());
+	EXPECT_EQ(syssnap::procfs::effective_uid(getpid()), geteuid());
+
+	// Unknown TIDs are their own group, without a user nor a cgroup
+	EXPECT_EQ(syssnap::procfs::thread_group_of(-1), -1);
+	EXPECT_FALSE(syssnap::procfs::effective_uid(-1));
+	EXPECT_TRUE(syssnap::procfs::cgroup_of(-1).empty());
+
+	const auto self = syssnap::procfs::cgroup_of(getpid());
+	if (self.empty()) { GTEST_SKIP() << "/proc/self/cgroup cannot be read"; }
+	EXPECT_EQ(self.front(), '/');
+}
+
+TEST(procfs, lists_every_task)
+{
+	std::atomic<pid_t> tid{ 0 };
+	std::atomic<bool>  stop{ false };
+
+	std::jthread worker([&] {
+		tid = gettid();
+		while (not stop.load()) { std::this_thread::yield(); }
+	});
+	while (tid.load() == 0) { std::this_thread::yield(); }
+
+	const syssnap::procfs_processes processes;
+
+	ASSERT_NE(processes.get(getpid()), nullptr);
+	ASSERT_NE(processes.get(tid), nullptr);
+	EXPECT_EQ(processes.find(tid).pid(), tid);
+	EXPECT_GE(processes.reads(), processes.size());
+
+	stop = true;
+}
+
+TEST(procfs, reads_the_planned_tasks_only)
+{
+	syssnap::procfs_processes processes;
+
+	std::unordered_set<pid_t> known;
+	for (const auto & task : processes)
+	{
+		known.insert(task.pid());
+	}
+
+	const std::unordered_set<pid_t> hot{ getpid() };
+	const syssnap::sampling_plan    plan{ .hot = &hot, .period = 32, .phase = 0 };
+
+	const auto before = processes.reads();
+	processes.update(plan);
+
+	// The rest keep their last read
+	std::uint64_t expected = 0;
+	for (const auto & task : processes)
+	{
+		if (not known.contains(task.pid()) or plan.sampled(task.pid())) { ++expected; }
+	}
+	EXPECT_EQ(processes.reads() - before, expected);
+	EXPECT_NE(processes.get(getpid()), nullptr);
+}
+
+TEST(procfs, live_snapshot_samples)
+{
+	syssnap::sampled_snapshot snapshot;
+	snapshot.enable_sampling({ .hot_threshold = 5.0F, .period = 8 });
+
+	for (int i = 0; i < 8; ++i)
+	{
+		const auto before = snapshot.processes().reads();
+		snapshot.update();
+
+		// The snapshot counts the same reads as the source
+		EXPECT_DOUBLE_EQ(snapshot.stats().of(syssnap::metric::samples).last(),
+		                 static_cast<double>(snapshot.processes().reads() - before));
+	}
+
+	EXPECT_TRUE(snapshot.manages(getpid()));
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <syssnap/published.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 2'000;
+		config.moves_per_update = 0.1F;
+		config.churn_per_update = 0.05F;
+
+		return syssnap::test::make_snapshot(config, { 32, 2 });
+	}
+
+	// The per-TID loads of each CPU must add up to the load of the CPU, and so on up to the system
+	auto consistent(const syssnap::snapshot_version & version, const syssnap::synthetic_topology & topo) -> bool
+	{
+		auto system = 0.0F;
+		for (const auto cpu : topo.cpus())
+		{
+			auto load = 0.0F;
+			for (const auto pid_load : version.loads_in_cpu(cpu))
+			{
+				load += pid_load;
+			}
+
+			if (std::abs(load - version.load_of_cpu(cpu)) > 1e-3F) { return false; }
+			if (version.pids_in_cpu(cpu).size() != version.use_in_cpu(cpu).size()) { return false; }
+
+			system += load;
+		}
+
+		return std::abs(system - version.load_system()) < 1e-2F;
+	}
+} // namespace
+
+TEST(published, version_matches_snapshot)
+{
+	auto snapshot = make_snapshot();
+	auto channel  = std::make_shared<syssnap::version_channel>();
+
+	EXPECT_FALSE(channel->acquire());
+
+	snapshot.publish_to(channel);
+	snapshot.update();
+
+	const auto version = channel->acquire();
+	ASSERT_TRUE(version);
+	EXPECT_EQ(version->generation(), 1U);
+	EXPECT_EQ(version->size(), snapshot.processes().size());
+
+	for (const auto cpu : snapshot.system_topology().cpus())
+	{
+		const auto pids = version->pids_in_cpu(cpu);
+		const auto load = version->loads_in_cpu(cpu);
+
+		ASSERT_EQ(pids.size(), snapshot.original_pids_in_cpu(cpu).size());
+		for (std::size_t i = 0; i < pids.size(); ++i)
+		{
+			EXPECT_FLOAT_EQ(load[i], snapshot.load_of(pids[i]));
+		}
+
+		EXPECT_FLOAT_EQ(version->cpu_use(cpu), snapshot.cpu_use(cpu));
+		EXPECT_FLOAT_EQ(version->load_of_cpu(cpu), snapshot.original_load_of_cpu(cpu));
+	}
+
+	for (const auto node : snapshot.system_topology().nodes())
+	{
+		EXPECT_FLOAT_EQ(version->node_use(node), snapshot.node_use(node));
+		EXPECT_FLOAT_EQ(version->load_of_node(node), snapshot.original_load_of_node(node));
+	}
+}
+
+TEST(published, held_versions_are_not_overwritten)
+{
+	auto snapshot = make_snapshot();
+	auto channel  = std::make_shared<syssnap::version_channel>(2);
+
+	snapshot.publish_to(channel);
+
+	const auto first = channel->acquire();
+	const auto pids  = std::vector(first->pids_in_cpu(0).begin(), first->pids_in_cpu(0).end());
+
+	// One version is held and the other one is current once published: the third update has nowhere to go
+	snapshot.update();
+	const auto second = channel->acquire();
+	snapshot.update();
+
+	EXPECT_EQ(channel->published(), 2U);
+	EXPECT_EQ(channel->skipped(), 1U);
+	EXPECT_EQ(channel->acquire()->generation(), second->generation());
+	EXPECT_EQ(std::vector(first->pids_in_cpu(0).begin(), first->pids_in_cpu(0).end()), pids);
+}
+
+TEST(published, concurrent_readers)
+{
+	constexpr int UPDATES = 200;
+	constexpr int READERS = 4;
+
+	auto snapshot = make_snapshot();
+	auto channel  = std::make_shared<syssnap::version_channel>();
+	snapshot.publish_to(channel);
+
+	const auto topo = snapshot.system_topology();
+
+	std::atomic<bool> done{ false };
+	std::atomic<int>  inconsistent{ 0 };
+	std::atomic<int>  backwards{ 0 };
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < READERS; ++r)
+	{
+		readers.emplace_back([&] {
+			std::uint64_t last = 0;
+			while (not done.load())
+			{
+				const auto version = channel->acquire();
+				if (not consistent(*version, topo)) { ++inconsistent; }
+				if (version->generation() < last) { ++backwards; }
+				last = version->generation();
+			}
+		});
+	}
+
+	for (int i = 0; i < UPDATES; ++i)
+	{
+		snapshot.update();
+	}
+
+	done = true;
+	for (auto & reader : readers)
+	{
+		reader.join();
+	}
+
+	EXPECT_EQ(inconsistent.load(), 0);
+	EXPECT_EQ(backwards.load(), 0);
+	EXPECT_EQ(channel->published() + channel->skipped(), static_cast<std::uint64_t>(UPDATES) + 1);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
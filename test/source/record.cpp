@@ -0,0 +1,307 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <syssnap/record.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	using syssnap::test::synthetic_snapshot;
+
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 1'000;
+		config.moves_per_update = 0.1F;
+		config.churn_per_update = 0.05F;
+
+		return syssnap::test::make_snapshot(config, { 16, 2 });
+	}
+
+	auto temp_record(const char * name)
+	{
+		auto path = std::filesystem::temp_directory_path() / fmt::format("syssnap_{}_{}.bin", name, getpid());
+		std::filesystem::remove(path);
+		return path;
+	}
+
+	// The frame must hold the committed state of the snapshot, TID by TID
+	void expect_matches_snapshot(const syssnap::record::frame_view & frame, const synthetic_snapshot & snapshot)
+	{
+		EXPECT_EQ(frame.size(), snapshot.processes().size());
+
+		for (const auto cpu : snapshot.system_topology().cpus())
+		{
+			const auto pids = frame.pids_in_cpu(cpu);
+			const auto use  = frame.use_in_cpu(cpu);
+			const auto load = frame.loads_in_cpu(cpu);
+
+			ASSERT_EQ(pids.size(), snapshot.original_pids_in_cpu(cpu).size());
+
+			for (std::size_t i = 0; i < pids.size(); ++i)
+			{
+				EXPECT_EQ(snapshot.original_processor(pids[i]), cpu);
+				EXPECT_FLOAT_EQ(use[i], snapshot.processes().cpu_use(pids[i]));
+				EXPECT_FLOAT_EQ(load[i], snapshot.load_of(pids[i]));
+			}
+
+			EXPECT_NEAR(frame.cpu_use(cpu), snapshot.cpu_use(cpu), 1e-2);
+			EXPECT_NEAR(frame.load_of_cpu(cpu), snapshot.original_load_of_cpu(cpu), 1e-3);
+		}
+
+		for (std::size_t i = 0; i < frame.size(); ++i)
+		{
+			EXPECT_EQ(frame.processor(i), snapshot.original_processor(frame.pids()[i]));
+			EXPECT_EQ(frame.numa_nodes()[i], snapshot.original_numa_node(frame.pids()[i]));
+		}
+	}
+} // namespace
+
+TEST(record, topology_round_trip)
+{
+	const auto   path     = temp_record("topology");
+	const auto   snapshot = make_snapshot();
+	const auto & topo     = snapshot.system_topology();
+
+	{
+		syssnap::record::writer writer(path, topo);
+	}
+
+	const syssnap::record::reader reader(path);
+	EXPECT_TRUE(reader.empty());
+
+	const auto & recorded = reader.system_topology();
+	EXPECT_EQ(std::vector(recorded.cpus().begin(), recorded.cpus().end()), topo.cpus());
+	EXPECT_EQ(std::vector(recorded.nodes().begin(), recorded.nodes().end()), topo.nodes());
+
+	for (const auto cpu : topo.cpus())
+	{
+		EXPECT_EQ(recorded.node_from_cpu(cpu), topo.node_from_cpu(cpu));
+	}
+
+	EXPECT_EQ(recorded.node_distance(0, 0), topo.node_distance(0, 0));
+	EXPECT_EQ(recorded.node_distance(0, 1), topo.node_distance(0, 1));
+	EXPECT_EQ(recorded.topology().cpu_node_map(), topo.cpu_node_map());
+
+	std::filesystem::remove(path);
+}
+
+TEST(record, frames_round_trip)
+{
+	const auto path     = temp_record("frames");
+	auto       snapshot = make_snapshot();
+
+	std::vector<std::vector<pid_t>> pids;
+	{
+		syssnap::record::writer writer(path, snapshot.system_topology());
+
+		for (int i = 0; i < 3; ++i)
+		{
+			writer.append(snapshot, std::chrono::nanoseconds{ i });
+
+			pids.emplace_back();
+			for (const auto cpu : snapshot.system_topology().cpus())
+			{
+				const auto in_cpu = snapshot.original_pids_in_cpu(cpu);
+				pids.back().insert(pids.back().end(), in_cpu.begin(), in_cpu.end());
+			}
+
+			snapshot.update();
+		}
+
+		EXPECT_EQ(writer.frames(), 3U);
+	}
+
+	const syssnap::record::reader reader(path);
+	ASSERT_EQ(reader.size(), 3U);
+
+	for (std::size_t i = 0; i < reader.size(); ++i)
+	{
+		EXPECT_EQ(reader[i].timestamp(), std::chrono::nanoseconds(i));
+		EXPECT_EQ(std::vector(reader[i].pids().begin(), reader[i].pids().end()), pids[i]);
+	}
+
+	// The snapshot has not changed since the last update, so the last frame can be checked against it
+	{
+		syssnap::record::writer writer(path, snapshot.system_topology());
+		writer.append(snapshot);
+	}
+
+	const syssnap::record::reader appended(path);
+	ASSERT_EQ(appended.size(), 4U);
+	expect_matches_snapshot(appended.back(), snapshot);
+
+	std::filesystem::remove(path);
+}
+
+TEST(record, pending_migrations)
+{
+	auto snapshot = make_snapshot();
+
+	const auto & topo = snapshot.system_topology();
+	const auto   pid  = snapshot.original_pids_in_cpu(0).front();
+	const auto   pid2 = snapshot.original_pids_in_cpu(1).front();
+
+	snapshot.migrate_to_cpu(pid, 3);
+	snapshot.migrate_to_cpu(pid2, 4);
+	snapshot.migrate_to_node(pid2, 1);
+
+	std::vector<std::byte> buffer;
+	syssnap::record::encode_topology(buffer, topo);
+	syssnap::record::encode_frame(buffer, snapshot, std::chrono::nanoseconds{ 0 });
+
+	const syssnap::record::reader reader{ std::span<const std::byte>(buffer) };
+	ASSERT_EQ(reader.size(), 1U);
+
+	// The committed state is recorded, along with the migrations that the next commit will apply
+	expect_matches_snapshot(reader[0], snapshot);
+
+	const auto migrations = reader[0].migrations();
+	ASSERT_EQ(migrations.size(), 2U);
+
+	for (const auto & migration : migrations)
+	{
+		if (migration.pid == pid)
+		{
+			EXPECT_EQ(migration.kind, syssnap::record::migration_kind::cpu);
+			EXPECT_EQ(migration.target, 3);
+		}
+		else
+		{
+			EXPECT_EQ(migration.pid, pid2);
+			EXPECT_EQ(migration.kind, syssnap::record::migration_kind::node);
+			EXPECT_EQ(migration.target, 1);
+		}
+	}
+}
+
+TEST(record, truncated_frame_is_ignored)
+{
+	const auto path     = temp_record("truncated");
+	const auto snapshot = make_snapshot();
+
+	{
+		syssnap::record::writer writer(path, snapshot.system_topology());
+		writer.append(snapshot);
+		writer.append(snapshot);
+	}
+
+	// Cut the last frame short, as if the writer died in the middle of a tick
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 100);
+
+	const syssnap::record::reader reader(path);
+	EXPECT_EQ(reader.size(), 1U);
+	expect_matches_snapshot(reader[0], snapshot);
+
+	std::filesystem::remove(path);
+}
+
+TEST(record, append_after_truncated_frame)
+{
+	const auto path     = temp_record("append_truncated");
+	const auto snapshot = make_snapshot();
+
+	{
+		syssnap::record::writer writer(path, snapshot.system_topology());
+		writer.append(snapshot);
+		writer.append(snapshot);
+	}
+
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 100);
+
+	// The partial frame is dropped, so the new frames follow the complete one
+	{
+		syssnap::record::writer writer(path, snapshot.system_topology());
+		writer.append(snapshot);
+		writer.append(snapshot);
+	}
+
+	const syssnap::record::reader reader(path);
+	ASSERT_EQ(reader.size(), 3U);
+	for (std::size_t i = 0; i < reader.size(); ++i)
+	{
+		expect_matches_snapshot(reader[i], snapshot);
+	}
+
+	std::filesystem::remove(path);
+}
+
+TEST(record, rejects_unordered_cpu_offsets)
+{
+	const auto path     = temp_record("offsets");
+	const auto snapshot = make_snapshot();
+
+	{
+		syssnap::record::writer writer(path, snapshot.system_topology());
+		writer.append(snapshot);
+	}
+
+	std::vector<char> bytes(std::filesystem::file_size(path));
+	{
+		std::ifstream in(path, std::ios::binary);
+		in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	// The first CPU claims every task, so the offset of the second one goes backwards
+	const auto magic = std::bit_cast<std::array<char, 4>>(syssnap::record::FRAME_MAGIC);
+	const auto frame = std::ranges::search(bytes, magic).begin();
+	ASSERT_NE(frame, bytes.end());
+
+	const auto tasks   = static_cast<std::uint32_t>(snapshot.processes().size());
+	const auto offsets = static_cast<std::size_t>(frame - bytes.begin()) + sizeof(syssnap::record::frame_header);
+	std::memcpy(&bytes[offsets + sizeof(tasks)], &tasks, sizeof(tasks));
+	{
+		std::ofstream out(path, std::ios::binary);
+		out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	const syssnap::record::reader reader(path);
+	ASSERT_EQ(reader.size(), 1U);
+	EXPECT_THROW(static_cast<void>(reader[0]), std::runtime_error);
+
+	std::filesystem::remove(path);
+}
+
+TEST(record, rejects_other_files)
+{
+	const auto path = temp_record("other");
+
+	{
+		std::ofstream out(path);
+		out << "# syssnap procfs capture v1\n";
+	}
+
+	EXPECT_THROW(syssnap::record::reader{ path }, std::runtime_error);
+
+	// Appending to a record of another topology
+	const auto snapshot = make_snapshot();
+	std::filesystem::remove(path);
+	{
+		syssnap::record::writer writer(path, syssnap::synthetic_topology(8, 1));
+	}
+	EXPECT_THROW(syssnap::record::writer(path, snapshot.system_topology()), std::runtime_error);
+
+	std::filesystem::remove(path);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <syssnap/sampling.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	constexpr std::size_t TASKS = 10'000;
+
+	// A few busy tasks, most of them almost idle
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = TASKS;
+		config.usage            = syssnap::usage_distribution::bimodal;
+		config.busy_fraction    = 0.02F;
+		config.moves_per_update = 0.0F;
+
+		return syssnap::test::make_snapshot(config, { 32, 2 });
+	}
+} // namespace
+
+TEST(sampling, sampler)
+{
+	syssnap::hot_set_sampler sampler({ .hot_threshold = 10.0F, .period = 4 });
+
+	sampler.advance();
+	const auto plan = sampler.plan();
+	EXPECT_EQ(plan.phase, 1U);
+	EXPECT_TRUE(plan.sampled(5));
+	EXPECT_FALSE(plan.sampled(6));
+
+	// TID 8 is read out of its turn (it is new), and is busy
+	sampler.discovered(8);
+	EXPECT_EQ(sampler.age(8), 0U);
+	sampler.observe(8, 50.0F);
+	sampler.observe(5, 0.0F);
+
+	EXPECT_TRUE(sampler.hot().contains(8));
+	EXPECT_FALSE(sampler.hot().contains(5));
+	EXPECT_EQ(sampler.age(5), 0U);
+
+	// Two updates later: the hot TID is read every time, the cold one waits for its turn
+	for (int i = 0; i < 2; ++i)
+	{
+		sampler.advance();
+		EXPECT_TRUE(sampler.plan().sampled(8));
+
+		std::vector<pid_t> out_of_turn;
+		sampler.for_each_out_of_turn([&](const pid_t pid) { out_of_turn.push_back(pid); });
+		EXPECT_EQ(out_of_turn, std::vector<pid_t>{ 8 });
+
+		sampler.observe(8, 50.0F);
+	}
+	EXPECT_EQ(sampler.age(5), 2U);
+	EXPECT_EQ(sampler.age(8), 0U);
+
+	// Once idle, it is read in its turn only
+	sampler.advance();
+	sampler.observe(8, 0.0F);
+	sampler.advance();
+	EXPECT_FALSE(sampler.plan().sampled(8));
+	EXPECT_EQ(sampler.age(8), 1U);
+
+	// Ages never go back past the start of the sampling
+	EXPECT_EQ(syssnap::hot_set_sampler({ .period = 100 }).age(42), 0U);
+}
+
+TEST(sampling, reads_drop_by_an_order_of_magnitude)
+{
+	auto snapshot = make_snapshot();
+	snapshot.enable_sampling({ .hot_threshold = 5.0F, .period = 32 });
+
+	constexpr int UPDATES = 64;
+
+	const auto before = snapshot.processes().reads();
+	for (int i = 0; i < UPDATES; ++i)
+	{
+		snapshot.update();
+	}
+	const auto per_update = static_cast<double>(snapshot.processes().reads() - before) / UPDATES;
+
+	EXPECT_LT(per_update, static_cast<double>(TASKS) / 10.0);
+
+	// The snapshot counts the same reads as the source
+	const auto last = snapshot.processes().reads();
+	snapshot.update();
+	EXPECT_DOUBLE_EQ(snapshot.stats().of(syssnap::metric::samples).last(),
+	                 static_cast<double>(snapshot.processes().reads() - last));
+
+	// Every TID was read within the period
+	for (const auto & task : snapshot.processes())
+	{
+		EXPECT_LT(snapshot.sample_age(task.pid()), 32U);
+	}
+}
+
+TEST(sampling, hot_and_migrated_tasks_stay_fresh)
+{
+	auto snapshot = make_snapshot();
+	snapshot.enable_sampling({ .hot_threshold = 5.0F, .period = 32 });
+
+	for (int i = 0; i < 40; ++i)
+	{
+		const auto hot = snapshot.sampling()->hot();
+		snapshot.update();
+
+		for (const auto pid : hot)
+		{
+			EXPECT_EQ(snapshot.sample_age(pid), 0U);
+		}
+	}
+
+	// A migrated TID is read on the next update, whatever its use
+	const auto pid = snapshot.original_pids_in_cpu(0).front();
+	snapshot.migrate_to_cpu(pid, 1);
+	snapshot.commit();
+
+	EXPECT_EQ(snapshot.sample_age(pid), 0U);
+}
+
+TEST(sampling, disabled_reads_everything)
+{
+	auto snapshot = make_snapshot();
+
+	const auto before = snapshot.processes().reads();
+	snapshot.update();
+
+	EXPECT_EQ(snapshot.processes().reads() - before, TASKS);
+	EXPECT_EQ(snapshot.sample_age(snapshot.processes().begin()->pid()), 0U);
+	EXPECT_TRUE(snapshot.stats().of(syssnap::metric::samples).empty());
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	using syssnap::test::synthetic_snapshot;
+
+	auto make_snapshot(syssnap::scope managed, const std::size_t workers = 1)
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 10'000;
+		config.moves_per_update = 0.1F;
+		config.churn_per_update = 0.05F;
+
+		return syssnap::test::make_snapshot(config, { 64, 4 }, workers, std::move(managed));
+	}
+
+	// Only the tasks in the scope are in the maps, and the rest still count as foreign use
+	void expect_scoped(const synthetic_snapshot & snapshot, const auto & in_scope)
+	{
+		const auto & topo = snapshot.system_topology();
+
+		std::vector<std::size_t> managed(topo.num_of_cpus(), 0);
+		std::vector<float>       use(topo.num_of_cpus(), 0.0F);
+		std::vector<float>       foreign(topo.num_of_cpus(), 0.0F);
+
+		for (const auto & task : snapshot.processes())
+		{
+			const auto cpu = syssnap::idx(task.processor());
+
+			EXPECT_EQ(snapshot.manages(task.pid()), in_scope(task.pid()));
+
+			if (in_scope(task.pid()))
+			{
+				++managed[cpu];
+				use[cpu] += task.cpu_use();
+			}
+			else { foreign[cpu] += task.cpu_use(); }
+		}
+
+		for (const auto cpu : topo.cpus())
+		{
+			EXPECT_EQ(snapshot.original_pids_in_cpu(cpu).size(), managed[syssnap::idx(cpu)]);
+			EXPECT_NEAR(snapshot.cpu_use(cpu), use[syssnap::idx(cpu)], 1e-2);
+			EXPECT_NEAR(snapshot.foreign_use(cpu), foreign[syssnap::idx(cpu)], 1e-2);
+		}
+	}
+
+	void check_predicate_scope(const std::size_t workers)
+	{
+		const auto even = [](const pid_t pid) { return pid % 2 == 0; };
+
+		auto snapshot = make_snapshot(syssnap::scope::predicate(even), workers);
+		expect_scoped(snapshot, even);
+
+		for (int i = 0; i < 5; ++i)
+		{
+			snapshot.update();
+			expect_scoped(snapshot, even);
+		}
+
+		snapshot.rebuild(syssnap::rebuild_policy::full);
+		expect_scoped(snapshot, even);
+	}
+
+	auto own_cgroup() -> std::string
+	{
+		std::ifstream cgroups("/proc/self/cgroup");
+
+		std::string line;
+		std::getline(cgroups, line);
+		return line.substr(line.find(':', line.find(':') + 1) + 1);
+	}
+} // namespace
+
+TEST(scope, predicate)
+{
+	check_predicate_scope(1);
+}
+
+TEST(scope, parallel_predicate)
+{
+	check_predicate_scope(4);
+}
+
+TEST(scope, everything_has_no_foreign_use)
+{
+	auto snapshot = make_snapshot(syssnap::scope::everything());
+
+	for (const auto cpu : snapshot.system_topology().cpus())
+	{
+		EXPECT_FLOAT_EQ(snapshot.foreign_use(cpu), 0.0F);
+	}
+
+	for (const auto & task : snapshot.processes())
+	{
+		EXPECT_TRUE(snapshot.manages(task.pid()));
+	}
+}
+
+TEST(scope, subtree_follows_new_threads)
+{
+	syssnap::snapshot snapshot{ syssnap::scope::subtree(getpid()) };
+
+	EXPECT_TRUE(snapshot.manages(getpid()));
+	EXPECT_FALSE(snapshot.manages(1));
+
+	std::atomic<pid_t> tid{ 0 };
+	std::atomic<bool>  stop{ false };
+
+	std::jthread worker([&] {
+		tid = gettid();
+		while (not stop.load()) { std::this_thread::yield(); }
+	});
+	while (tid.load() == 0) { std::this_thread::yield(); }
+
+	snapshot.update();
+	EXPECT_TRUE(snapshot.manages(tid));
+
+	stop = true;
+	worker.join();
+
+	snapshot.update();
+	EXPECT_FALSE(snapshot.manages(tid));
+}
+
+TEST(scope, user_and_cgroup)
+{
+	const syssnap::snapshot by_user{ syssnap::scope::user(geteuid()) };
+	EXPECT_TRUE(by_user.manages(gettid()));
+
+	const syssnap::snapshot by_other_user{ syssnap::scope::user(geteuid() + 1) };
+	EXPECT_FALSE(by_other_user.manages(gettid()));
+
+	const syssnap::snapshot by_cgroup{ syssnap::scope::cgroup(own_cgroup()) };
+	EXPECT_TRUE(by_cgroup.manages(gettid()));
+
+	const syssnap::snapshot by_other_cgroup{ syssnap::scope::cgroup("/syssnap-no-such-cgroup") };
+	EXPECT_FALSE(by_other_cgroup.manages(gettid()));
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
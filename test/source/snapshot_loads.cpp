@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <thread>
+
+#include <syssnap/syssnap.hpp>
+
+namespace
+{
+	// Loads recomputed from scratch from the (dirty) TIDs in each CPU/node
+	void expect_consistent_loads(const syssnap::snapshot & snapshot)
+	{
+		const auto sum_loads = [&](auto && pids) {
+			return ranges::accumulate(pids | ranges::views::transform([&](const auto pid) {
+				                          return snapshot.load_of(pid);
+			                          }),
+			                          0.0F);
+		};
+
+		auto system_load = 0.0F;
+
+		for (const auto cpu : snapshot.system_topology().cpus())
+		{
+			EXPECT_NEAR(snapshot.load_of_cpu(cpu), sum_loads(snapshot.pids_in_cpu(cpu)), 1e-3);
+			system_load += snapshot.load_of_cpu(cpu);
+		}
+
+		for (const auto node : snapshot.system_topology().nodes())
+		{
+			EXPECT_NEAR(snapshot.load_of_node(node), sum_loads(snapshot.pids_in_node(node)), 1e-3);
+		}
+
+		EXPECT_NEAR(snapshot.load_system(), system_load, 1e-3);
+	}
+} // namespace
+
+TEST(snapshot_loads, aggregates_follow_migrations)
+{
+	syssnap::snapshot snapshot;
+	snapshot.update();
+
+	expect_consistent_loads(snapshot);
+
+	const auto tid  = gettid();
+	const auto cpus = snapshot.system_topology().cpus();
+
+	// Move the TID around every CPU, checking the projected loads at each step
+	for (const auto cpu : cpus)
+	{
+		snapshot.migrate_to_cpu(tid, cpu);
+		EXPECT_EQ(snapshot.processor(tid), cpu);
+		expect_consistent_loads(snapshot);
+	}
+
+	snapshot.rollback();
+	EXPECT_EQ(snapshot.processor(tid), snapshot.original_processor(tid));
+	for (const auto cpu : cpus)
+	{
+		EXPECT_FLOAT_EQ(snapshot.load_of_cpu(cpu), snapshot.original_load_of_cpu(cpu));
+	}
+	expect_consistent_loads(snapshot);
+
+	snapshot.migrate_to_cpu(tid, cpus.front());
+	const auto report = snapshot.commit();
+	EXPECT_EQ(report.results.size(), 1U);
+	EXPECT_TRUE(report.all_applied());
+	expect_consistent_loads(snapshot);
+
+	snapshot.unpin(tid);
+}
+
+TEST(snapshot_loads, promote_on_commit)
+{
+	syssnap::snapshot snapshot;
+	snapshot.update();
+
+	const auto tid = gettid();
+	const auto cpu = snapshot.system_topology().cpus().back();
+
+	const auto load_before = snapshot.load_of(tid);
+
+	snapshot.migrate_to_cpu(tid, cpu);
+	const auto projected_cpu_load = snapshot.load_of_cpu(cpu);
+
+	snapshot.commit(syssnap::commit_policy::promote);
+
+	// The committed state is now the projected one, without reading procfs again
+	EXPECT_EQ(snapshot.original_processor(tid), cpu);
+	EXPECT_EQ(snapshot.processor(tid), cpu);
+	EXPECT_TRUE(ranges::contains(snapshot.original_pids_in_cpu(cpu), tid));
+	EXPECT_FLOAT_EQ(snapshot.load_of(tid), load_before);
+	EXPECT_FLOAT_EQ(snapshot.original_load_of_cpu(cpu), projected_cpu_load);
+	expect_consistent_loads(snapshot);
+
+	snapshot.unpin(tid);
+}
+
+TEST(snapshot_loads, vanished_tasks_are_reported)
+{
+	syssnap::snapshot snapshot;
+
+	// Take a snapshot while a thread is alive, and migrate it after it exited
+	std::atomic<pid_t> exited_tid{ 0 };
+	{
+		std::atomic<bool>  stop{ false };
+		const std::jthread thread{ [&] {
+			exited_tid = gettid();
+			while (not stop.load()) { std::this_thread::yield(); }
+		} };
+
+		while (exited_tid.load() == 0) { std::this_thread::yield(); }
+		snapshot.update();
+		stop = true;
+	}
+
+	const auto tid = gettid();
+	const auto cpu = snapshot.system_topology().cpus().front();
+
+	const auto cpu_before = snapshot.original_processor(exited_tid);
+
+	snapshot.migrate_to_cpu(exited_tid, cpu);
+	snapshot.migrate_to_cpu(tid, cpu);
+
+	const auto report = snapshot.commit(syssnap::commit_policy::promote);
+
+	EXPECT_EQ(report.results.size(), 2U);
+	EXPECT_EQ(report.applied(), 1U);
+	EXPECT_EQ(report.vanished(), 1U);
+
+	// The TID that could not be migrated stays where it was
+	EXPECT_EQ(snapshot.original_processor(exited_tid), cpu_before);
+	EXPECT_EQ(snapshot.original_processor(tid), cpu);
+	expect_consistent_loads(snapshot);
+
+	snapshot.unpin(tid);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
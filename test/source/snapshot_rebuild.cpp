@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <syssnap/syssnap.hpp>
+
+namespace
+{
+	struct state
+	{
+		std::vector<std::vector<pid_t>> cpu_pids;
+		std::vector<std::vector<pid_t>> node_pids;
+		std::vector<std::pair<syssnap::cpu_t, syssnap::node_t>> placement;
+		std::vector<float> cpu_use;
+		std::vector<float> node_use;
+		std::vector<float> loads;
+	};
+
+	auto sorted(const auto & rng)
+	{
+		return rng | ranges::to_vector | ranges::actions::sort;
+	}
+
+	auto capture(const syssnap::snapshot & snapshot)
+	{
+		state s;
+
+		for (const auto cpu : snapshot.system_topology().cpus())
+		{
+			s.cpu_pids.emplace_back(sorted(snapshot.original_pids_in_cpu(cpu)));
+			s.cpu_use.emplace_back(snapshot.cpu_use(cpu));
+		}
+
+		for (const auto node : snapshot.system_topology().nodes())
+		{
+			s.node_pids.emplace_back(sorted(snapshot.original_pids_in_node(node)));
+			s.node_use.emplace_back(snapshot.node_use(node));
+		}
+
+		for (const auto & proc : snapshot.processes())
+		{
+			const auto pid = proc.pid();
+			s.placement.emplace_back(snapshot.original_processor(pid), snapshot.original_numa_node(pid));
+			s.loads.emplace_back(snapshot.load_of(pid));
+		}
+
+		return s;
+	}
+
+	void expect_same(const state & incremental, const state & full)
+	{
+		EXPECT_EQ(incremental.cpu_pids, full.cpu_pids);
+		EXPECT_EQ(incremental.node_pids, full.node_pids);
+		EXPECT_EQ(incremental.placement, full.placement);
+
+		ASSERT_EQ(incremental.cpu_use.size(), full.cpu_use.size());
+		for (std::size_t i = 0; i < full.cpu_use.size(); ++i)
+		{
+			EXPECT_FLOAT_EQ(incremental.cpu_use[i], full.cpu_use[i]);
+		}
+
+		ASSERT_EQ(incremental.node_use.size(), full.node_use.size());
+		for (std::size_t i = 0; i < full.node_use.size(); ++i)
+		{
+			EXPECT_FLOAT_EQ(incremental.node_use[i], full.node_use[i]);
+		}
+
+		ASSERT_EQ(incremental.loads.size(), full.loads.size());
+		for (std::size_t i = 0; i < full.loads.size(); ++i)
+		{
+			EXPECT_FLOAT_EQ(incremental.loads[i], full.loads[i]);
+		}
+	}
+
+	void check_incremental_matches_full(syssnap::snapshot & snapshot)
+	{
+		using namespace std::chrono_literals;
+
+		std::atomic<bool> stop{ false };
+
+		for (int i = 0; i < 5; ++i)
+		{
+			// Spawn and finish some threads between updates so TIDs appear and exit
+			std::vector<std::jthread> workers;
+			for (int w = 0; w < 4; ++w)
+			{
+				workers.emplace_back([&] {
+					while (not stop.load()) { std::this_thread::yield(); }
+				});
+			}
+
+			std::this_thread::sleep_for(10ms);
+			snapshot.update(syssnap::rebuild_policy::incremental);
+			const auto incremental = capture(snapshot);
+
+			snapshot.rebuild(syssnap::rebuild_policy::full);
+			const auto full = capture(snapshot);
+
+			expect_same(incremental, full);
+
+			stop = true;
+			workers.clear();
+			stop = false;
+		}
+	}
+} // namespace
+
+TEST(snapshot_rebuild, incremental_matches_full)
+{
+	syssnap::snapshot snapshot;
+	check_incremental_matches_full(snapshot);
+}
+
+TEST(snapshot_rebuild, parallel_incremental_matches_full)
+{
+	syssnap::snapshot snapshot{ 4 };
+	check_incremental_matches_full(snapshot);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
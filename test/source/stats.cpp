@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <syssnap/stats.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	using syssnap::test::synthetic_snapshot;
+
+	using uninstrumented_snapshot = syssnap::test::basic_synthetic_snapshot<syssnap::sigmoid_load, syssnap::no_stats>;
+
+	template<typename Snapshot = synthetic_snapshot>
+	auto make_snapshot()
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 1'000;
+		config.moves_per_update = 0.1F;
+		config.churn_per_update = 0.05F;
+
+		return syssnap::test::make_snapshot<Snapshot>(config, { 16, 2 });
+	}
+} // namespace
+
+TEST(stats, series)
+{
+	syssnap::metric_series series(4);
+	EXPECT_TRUE(series.empty());
+	EXPECT_DOUBLE_EQ(series.last(), 0.0);
+	EXPECT_DOUBLE_EQ(series.percentile(50.0), 0.0);
+
+	for (const auto value : { 5.0, 1.0, 9.0, 3.0, 7.0, 2.0 })
+	{
+		series.record(value);
+	}
+
+	// Min and max cover every sample, the rest only the last 4: 9, 3, 7, 2
+	EXPECT_EQ(series.count(), 6U);
+	EXPECT_DOUBLE_EQ(series.last(), 2.0);
+	EXPECT_DOUBLE_EQ(series.min(), 1.0);
+	EXPECT_DOUBLE_EQ(series.max(), 9.0);
+	EXPECT_DOUBLE_EQ(series.mean(), 5.25);
+	EXPECT_DOUBLE_EQ(series.percentile(0.0), 2.0);
+	EXPECT_DOUBLE_EQ(series.percentile(50.0), 3.0);
+	EXPECT_DOUBLE_EQ(series.percentile(75.0), 7.0);
+	EXPECT_DOUBLE_EQ(series.percentile(100.0), 9.0);
+
+	series.clear();
+	EXPECT_TRUE(series.empty());
+}
+
+TEST(stats, updates_record_every_phase)
+{
+	auto snapshot = make_snapshot();
+
+	// The constructor rebuilds the maps, but does not scan
+	EXPECT_EQ(snapshot.stats().of(syssnap::metric::rebuild).count(), 1U);
+	EXPECT_EQ(snapshot.stats().of(syssnap::metric::update).count(), 0U);
+
+	constexpr int UPDATES = 10;
+	for (int i = 0; i < UPDATES; ++i)
+	{
+		snapshot.update();
+	}
+
+	const auto & stats = snapshot.stats();
+	for (const auto m : { syssnap::metric::update, syssnap::metric::scan })
+	{
+		EXPECT_EQ(stats.of(m).count(), static_cast<std::uint64_t>(UPDATES));
+	}
+	for (const auto m : { syssnap::metric::rebuild, syssnap::metric::loads, syssnap::metric::tasks })
+	{
+		EXPECT_EQ(stats.of(m).count(), static_cast<std::uint64_t>(UPDATES) + 1);
+	}
+
+	// The whole update takes at least as long as any of its phases
+	EXPECT_GE(stats.of(syssnap::metric::update).last(), stats.of(syssnap::metric::scan).last());
+	EXPECT_GE(stats.of(syssnap::metric::update).last(), stats.of(syssnap::metric::loads).last());
+	EXPECT_GT(stats.of(syssnap::metric::update).max(), 0.0);
+
+	EXPECT_DOUBLE_EQ(stats.of(syssnap::metric::tasks).last(), static_cast<double>(snapshot.processes().size()));
+	EXPECT_GE(stats.of(syssnap::metric::hash_buckets).last(), stats.of(syssnap::metric::tasks).last());
+
+	// The first computation of the loads has to size every per-CPU array
+	EXPECT_GT(stats.of(syssnap::metric::reallocations).max(), 0.0);
+}
+
+TEST(stats, commit_counts_migrations)
+{
+	auto snapshot = make_snapshot();
+
+	const auto pids = snapshot.original_pids_in_cpu(0);
+	snapshot.migrate_to_cpu(pids[0], 1);
+	snapshot.migrate_to_cpu(pids[1], 2);
+	snapshot.migrate_to_node(pids[2], 1);
+
+	const auto report = snapshot.commit(syssnap::commit_policy::promote);
+
+	const auto & stats = snapshot.stats();
+	EXPECT_EQ(stats.of(syssnap::metric::commit).count(), 1U);
+	EXPECT_DOUBLE_EQ(stats.of(syssnap::metric::commit).last(), static_cast<double>(report.elapsed.count()));
+	EXPECT_DOUBLE_EQ(stats.of(syssnap::metric::migrations_applied).last(), 3.0);
+	EXPECT_DOUBLE_EQ(stats.of(syssnap::metric::migrations_failed).last(), 0.0);
+
+	snapshot.clear_stats();
+	EXPECT_TRUE(snapshot.stats().of(syssnap::metric::commit).empty());
+}
+
+TEST(stats, no_stats)
+{
+	static_assert(sizeof(uninstrumented_snapshot) < sizeof(synthetic_snapshot));
+
+	auto snapshot = make_snapshot<uninstrumented_snapshot>();
+	snapshot.update();
+
+	EXPECT_EQ(snapshot.processes().size(), 1'000U);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
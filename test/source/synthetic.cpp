@@ -0,0 +1,341 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+#include <syssnap/replay.hpp>
+#include <syssnap/synthetic.hpp>
+#include <syssnap/syssnap.hpp>
+
+#include "synthetic_fixture.hpp"
+
+namespace
+{
+	using syssnap::test::make_snapshot;
+	using syssnap::test::synthetic_snapshot;
+
+	auto sorted(auto && rng)
+	{
+		return rng | ranges::to_vector | ranges::actions::sort;
+	}
+
+	// The maps of the snapshot must match the tasks of the source, whatever the rebuild policy
+	void expect_matches_source(const synthetic_snapshot & snapshot)
+	{
+		const auto & topo = snapshot.system_topology();
+
+		std::vector<std::vector<pid_t>> cpu_pids(topo.num_of_cpus());
+		std::vector<float>              cpu_use(topo.num_of_cpus(), 0.0F);
+
+		for (const auto & task : snapshot.processes())
+		{
+			EXPECT_EQ(snapshot.original_processor(task.pid()), task.processor());
+			EXPECT_EQ(snapshot.original_numa_node(task.pid()), topo.node_from_cpu(task.processor()));
+
+			cpu_pids.at(syssnap::idx(task.processor())).emplace_back(task.pid());
+			cpu_use.at(syssnap::idx(task.processor())) += task.cpu_use();
+		}
+
+		for (const auto cpu : topo.cpus())
+		{
+			EXPECT_EQ(sorted(snapshot.original_pids_in_cpu(cpu)), sorted(cpu_pids.at(syssnap::idx(cpu))));
+			EXPECT_NEAR(snapshot.cpu_use(cpu), cpu_use.at(syssnap::idx(cpu)), 1e-2);
+		}
+	}
+
+	// TIDs and load of each CPU and node
+	struct placement_view
+	{
+		std::vector<std::vector<pid_t>> cpu_pids;
+		std::vector<std::vector<pid_t>> node_pids;
+		std::vector<float>              cpu_loads;
+		std::vector<float>              node_loads;
+	};
+
+	// After the (uncommitted) migrations, through the overlay
+	auto dirty_view(const synthetic_snapshot & snapshot)
+	{
+		placement_view view;
+		for (const auto cpu : snapshot.system_topology().cpus())
+		{
+			view.cpu_pids.emplace_back(sorted(snapshot.pids_in_cpu(cpu)));
+			view.cpu_loads.emplace_back(snapshot.load_of_cpu(cpu));
+		}
+		for (const auto node : snapshot.system_topology().nodes())
+		{
+			view.node_pids.emplace_back(sorted(snapshot.pids_in_node(node)));
+			view.node_loads.emplace_back(snapshot.load_of_node(node));
+		}
+		return view;
+	}
+
+	// The committed state only
+	auto committed_view(const synthetic_snapshot & snapshot)
+	{
+		placement_view view;
+		for (const auto cpu : snapshot.system_topology().cpus())
+		{
+			view.cpu_pids.emplace_back(sorted(snapshot.original_pids_in_cpu(cpu)));
+			view.cpu_loads.emplace_back(snapshot.original_load_of_cpu(cpu));
+		}
+		for (const auto node : snapshot.system_topology().nodes())
+		{
+			view.node_pids.emplace_back(sorted(snapshot.original_pids_in_node(node)));
+			view.node_loads.emplace_back(snapshot.original_load_of_node(node));
+		}
+		return view;
+	}
+
+	void expect_same_view(const placement_view & actual, const placement_view & expected)
+	{
+		EXPECT_EQ(actual.cpu_pids, expected.cpu_pids);
+		EXPECT_EQ(actual.node_pids, expected.node_pids);
+
+		ASSERT_EQ(actual.cpu_loads.size(), expected.cpu_loads.size());
+		for (std::size_t i = 0; i < expected.cpu_loads.size(); ++i)
+		{
+			EXPECT_NEAR(actual.cpu_loads[i], expected.cpu_loads[i], 1e-3);
+		}
+
+		ASSERT_EQ(actual.node_loads.size(), expected.node_loads.size());
+		for (std::size_t i = 0; i < expected.node_loads.size(); ++i)
+		{
+			EXPECT_NEAR(actual.node_loads[i], expected.node_loads[i], 1e-3);
+		}
+	}
+
+	void check_incremental_updates(const std::size_t workers)
+	{
+		syssnap::synthetic_config config;
+		config.tasks            = 10'000;
+		config.moves_per_update = 0.1F;
+		config.churn_per_update = 0.05F;
+
+		auto snapshot = make_snapshot(config, { 64, 4 }, workers);
+		expect_matches_source(snapshot);
+
+		for (int i = 0; i < 5; ++i)
+		{
+			snapshot.update(syssnap::rebuild_policy::incremental);
+			expect_matches_source(snapshot);
+		}
+	}
+
+	auto stat_line(const pid_t pid, const std::string & comm, const int utime, const int stime, const int cpu)
+	{
+		// Fields after the command, starting at the state (see proc(5))
+		std::vector<std::string> fields(40, "0");
+		fields[0]  = "S";
+		fields[11] = std::to_string(utime);
+		fields[12] = std::to_string(stime);
+		fields[36] = std::to_string(cpu);
+
+		return fmt::format("{} ({}) {}", pid, comm, fmt::join(fields, " "));
+	}
+} // namespace
+
+TEST(synthetic, topology_splits_cpus_across_nodes)
+{
+	const syssnap::synthetic_topology topo(8, 2);
+
+	EXPECT_EQ(topo.num_of_cpus(), 8U);
+	EXPECT_EQ(topo.num_of_nodes(), 2U);
+	EXPECT_EQ(topo.max_cpu(), 7);
+	EXPECT_EQ(topo.max_node(), 1);
+	EXPECT_EQ(topo.cpus_from_node(0), (std::vector<syssnap::cpu_t>{ 0, 1, 2, 3 }));
+	EXPECT_EQ(topo.node_from_cpu(5), 1);
+	EXPECT_EQ(topo.nodes_by_distance(1), (std::vector<syssnap::node_t>{ 1, 0 }));
+}
+
+TEST(synthetic, same_seed_same_snapshot)
+{
+	syssnap::synthetic_config config;
+	config.tasks = 1'000;
+
+	auto first  = make_snapshot(config, { 64, 4 });
+	auto second = make_snapshot(config, { 64, 4 });
+
+	first.update();
+	second.update();
+
+	for (const auto cpu : first.system_topology().cpus())
+	{
+		EXPECT_EQ(sorted(first.original_pids_in_cpu(cpu)), sorted(second.original_pids_in_cpu(cpu)));
+		EXPECT_FLOAT_EQ(first.load_of_cpu(cpu), second.load_of_cpu(cpu));
+	}
+}
+
+TEST(synthetic, incremental_updates_follow_the_source)
+{
+	check_incremental_updates(1);
+}
+
+TEST(synthetic, parallel_incremental_updates_follow_the_source)
+{
+	check_incremental_updates(4);
+}
+
+TEST(synthetic, commit_moves_the_tasks)
+{
+	syssnap::synthetic_config config;
+	config.tasks = 1'000;
+
+	auto snapshot = make_snapshot(config, { 64, 4 });
+
+	const auto cpu  = snapshot.system_topology().cpus().back();
+	const auto node = snapshot.system_topology().node_from_cpu(cpu);
+
+	std::vector<pid_t> migrated;
+	for (const auto & task : snapshot.processes())
+	{
+		if (task.processor() != cpu and migrated.size() < 100) { migrated.emplace_back(task.pid()); }
+	}
+
+	for (const auto pid : migrated)
+	{
+		snapshot.migrate_to_cpu(pid, cpu);
+	}
+
+	const auto report = snapshot.commit(syssnap::commit_policy::promote);
+	EXPECT_EQ(report.results.size(), migrated.size());
+	EXPECT_TRUE(report.all_applied());
+
+	for (const auto pid : migrated)
+	{
+		EXPECT_EQ(snapshot.process(pid).processor(), cpu);
+		EXPECT_EQ(snapshot.original_processor(pid), cpu);
+		EXPECT_EQ(snapshot.original_numa_node(pid), node);
+	}
+
+	// Pinned tasks do not move on their own
+	snapshot.update();
+	expect_matches_source(snapshot);
+	for (const auto pid : migrated)
+	{
+		EXPECT_EQ(snapshot.original_processor(pid), cpu);
+	}
+}
+
+// The overlay views must show what promoting the migrations (or reading the moved tasks again) leaves
+TEST(synthetic, dirty_overlay_matches_the_promoted_state)
+{
+	syssnap::synthetic_config config;
+	config.tasks            = 1'000;
+	config.moves_per_update = 0.0F;
+
+	auto snapshot = make_snapshot(config, { 64, 4 });
+
+	const auto & cpus  = snapshot.system_topology().cpus();
+	const auto & nodes = snapshot.system_topology().nodes();
+
+	// Without migrations, the overlay shows the committed state
+	expect_same_view(dirty_view(snapshot), committed_view(snapshot));
+
+	std::vector<pid_t> pids;
+	for (const auto & task : snapshot.processes())
+	{
+		if (pids.size() < 400) { pids.emplace_back(task.pid()); }
+	}
+
+	// CPU migrations, node migrations, TIDs moved twice and TIDs moved back to where they were
+	for (std::size_t i = 0; i < pids.size(); ++i)
+	{
+		const auto pid  = pids[i];
+		const auto cpu  = cpus[(i * 7) % cpus.size()];
+		const auto node = nodes[i % nodes.size()];
+
+		switch (i % 4)
+		{
+			case 0: snapshot.migrate_to_cpu(pid, cpu); break;
+			case 1: snapshot.migrate_to_node(pid, node); break;
+			case 2:
+				snapshot.migrate_to_cpu(pid, cpu);
+				snapshot.migrate_to_node(pid, node);
+				break;
+			default:
+				snapshot.migrate_to_cpu(pid, cpu);
+				snapshot.migrate_to_cpu(pid, snapshot.original_processor(pid));
+				break;
+		}
+	}
+
+	const auto dirty = dirty_view(snapshot);
+
+	std::vector<syssnap::cpu_t> dirty_cpus;
+	for (const auto pid : pids)
+	{
+		dirty_cpus.emplace_back(snapshot.processor(pid));
+	}
+
+	const auto report = snapshot.commit(syssnap::commit_policy::promote);
+	EXPECT_TRUE(report.all_applied());
+
+	expect_same_view(committed_view(snapshot), dirty);
+	expect_same_view(dirty_view(snapshot), dirty);
+
+	// Reading the tasks again: the node migrations may land on another CPU of the node, but on the same node
+	snapshot.rebuild(syssnap::rebuild_policy::full);
+	EXPECT_EQ(committed_view(snapshot).node_pids, dirty.node_pids);
+
+	for (std::size_t i = 0; i < pids.size(); i += 4)
+	{
+		EXPECT_EQ(snapshot.original_processor(pids[i]), dirty_cpus[i]);
+	}
+}
+
+TEST(synthetic, replay_capture)
+{
+	const auto path = std::filesystem::temp_directory_path() / fmt::format("syssnap_capture_{}.txt", getpid());
+
+	{
+		std::ofstream out(path);
+		out << syssnap::capture::MAGIC << '\n';
+		out << "# clk_tck 100\n";
+		out << "# cpu 0 0\n# cpu 1 0\n# cpu 2 1\n# cpu 3 1\n";
+
+		out << "# frame 0\n";
+		out << stat_line(10, "worker (a)", 100, 0, 1) << '\n';
+
+		out << "# frame 1000000000\n";
+		out << stat_line(10, "worker (a)", 140, 10, 1) << '\n';
+		out << stat_line(11, "new", 500, 0, 2) << '\n';
+	}
+
+	syssnap::replay_processes replay(path);
+	const auto                topo = replay.topology();
+
+	EXPECT_EQ(topo.num_of_cpus(), 4U);
+	EXPECT_EQ(topo.node_from_cpu(2), 1);
+
+	syssnap::basic_snapshot snapshot(std::move(replay), topo);
+	EXPECT_EQ(snapshot.processes().size(), 1U);
+	EXPECT_FLOAT_EQ(snapshot.cpu_use(1), 0.0F);
+
+	snapshot.update();
+	EXPECT_FALSE(snapshot.processes().at_end());
+	EXPECT_EQ(snapshot.processes().size(), 2U);
+
+	// 50 ticks in 1 second at 100 ticks per second; the new TID has no previous sample
+	EXPECT_FLOAT_EQ(snapshot.cpu_use(1), 50.0F);
+	EXPECT_FLOAT_EQ(snapshot.node_use(1), 0.0F);
+	EXPECT_EQ(snapshot.original_numa_node(11), 1);
+
+	snapshot.update();
+	EXPECT_TRUE(snapshot.processes().at_end());
+	EXPECT_EQ(snapshot.processes().size(), 2U);
+
+	std::filesystem::remove(path);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
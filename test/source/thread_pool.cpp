@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <syssnap/thread_pool.hpp>
+
+TEST(thread_pool, visits_every_index_once)
+{
+	syssnap::thread_pool pool{ 4 };
+	EXPECT_EQ(pool.size(), 4U);
+
+	for (const auto n : { 0U, 1U, 3U, 1000U })
+	{
+		std::vector<std::atomic<int>> visits(n);
+		pool.parallel_for(n, [&](const std::size_t i) { ++visits[i]; });
+
+		for (const auto & v : visits)
+		{
+			EXPECT_EQ(v.load(), 1);
+		}
+	}
+}
+
+TEST(thread_pool, rethrows_exceptions)
+{
+	syssnap::thread_pool pool{ 2 };
+
+	EXPECT_THROW(pool.parallel_for(10, [](const std::size_t i) {
+		if (i == 5) { throw std::runtime_error("error"); }
+	}),
+	             std::runtime_error);
+
+	// The pool is still usable afterwards
+	std::atomic<std::size_t> count{ 0 };
+	pool.parallel_for(10, [&](const std::size_t) { ++count; });
+	EXPECT_EQ(count.load(), 10U);
+}
+
+auto main(int argc, char ** argv) -> int
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}